@@ -16,6 +16,12 @@
 #include <QString>
 #include <QGridLayout>
 
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
 
 class RunControlGUI : public QMainWindow,
 		      public Ui::wndRun{
@@ -25,6 +31,7 @@ class RunControlGUI : public QMainWindow,
    Q_OBJECT
 public:
   RunControlGUI();
+  ~RunControlGUI();
   void SetInstance(eudaq::RunControlUP rc);
   void Exec();
 private slots:
@@ -88,4 +95,12 @@ private slots:
   std::string m_config_at_run_path;
 
   void updateProgressBar();
+  void RunCommand(std::function<void()> cmd);
+  void CommandThread();
+  // the commands waiting for the components run one after the other here
+  std::thread m_thd_cmd;
+  std::deque<std::function<void()>> m_qu_cmd;
+  std::mutex m_mtx_cmd;
+  std::condition_variable m_cv_cmd;
+  bool m_cmd_exit;
 };
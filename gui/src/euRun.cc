@@ -14,7 +14,8 @@ RunControlGUI::RunControlGUI()
     m_scan_interrupt_received(false),
     m_save_config_at_run_start(true),
     m_display_row(0),
-    m_config_at_run_path(""){
+    m_config_at_run_path(""),
+    m_cmd_exit(false){
     m_map_label_str = {{"RUN", "Run Number"}};
     qRegisterMetaType<QModelIndex>("QModelIndex");
     setupUi(this);
@@ -96,6 +97,46 @@ RunControlGUI::RunControlGUI()
   settings_output.endGroup();
 }
 
+RunControlGUI::~RunControlGUI(){
+  std::unique_lock<std::mutex> lk(m_mtx_cmd);
+  m_cmd_exit = true;
+  m_qu_cmd.clear();
+  m_cv_cmd.notify_all();
+  lk.unlock();
+  if(m_thd_cmd.joinable())
+    m_thd_cmd.join();
+}
+
+// Initialise, Configure, StartRun and StopRun wait until the components
+// have answered, up to EUDAQ_CTRL_TIMEOUT_S per group, so they are queued
+// for a thread of their own and the GUI keeps updating meanwhile
+void RunControlGUI::RunCommand(std::function<void()> cmd){
+  std::unique_lock<std::mutex> lk(m_mtx_cmd);
+  if(!m_thd_cmd.joinable())
+    m_thd_cmd = std::thread(&RunControlGUI::CommandThread, this);
+  m_qu_cmd.push_back(std::move(cmd));
+  m_cv_cmd.notify_all();
+}
+
+void RunControlGUI::CommandThread(){
+  std::unique_lock<std::mutex> lk(m_mtx_cmd);
+  while(true){
+    m_cv_cmd.wait(lk, [this]{return m_cmd_exit || !m_qu_cmd.empty();});
+    if(m_cmd_exit)
+      return;
+    auto cmd = std::move(m_qu_cmd.front());
+    m_qu_cmd.pop_front();
+    lk.unlock();
+    try{
+      cmd();
+    }
+    catch(const std::exception &e){
+      EUDAQ_ERROR(std::string("RunControl command failed: ") + e.what());
+    }
+    lk.lock();
+  }
+}
+
 void RunControlGUI::SetInstance(eudaq::RunControlUP rc){
   m_rc = std::move(rc);
   if(m_lastexit_success)
@@ -111,8 +152,10 @@ void RunControlGUI::on_btnInit_clicked(){
   if(!checkFile(QString::fromStdString(settings),QString::fromStdString("init file")))
       return;
   if(m_rc){
-    m_rc->ReadInitilizeFile(settings);
-    m_rc->Initialise();
+    RunCommand([this, settings]{
+	m_rc->ReadInitilizeFile(settings);
+	m_rc->Initialise();
+      });
   }
   // connect to the log collector - based on RunControl.cc implemtation
   std::map<eudaq::ConnectionSPC, eudaq::StatusSPC> map_conn_status;
@@ -143,12 +186,15 @@ void RunControlGUI::on_btnConfig_clicked(){
       return;
   }
   if(m_rc){
-    m_rc->ReadConfigureFile(settings);
-    m_rc->Configure();
+    RunCommand([this, settings]{
+	m_rc->ReadConfigureFile(settings);
+	m_rc->Configure();
+      });
   }
   if(m_rc)
   {
-  eudaq::ConfigurationSPC conf = m_rc->GetConfiguration();
+  // read here, the RunControl may still be busy with a former command
+  eudaq::ConfigurationSPC conf = eudaq::Configuration::MakeUniqueReadFile(settings);
   conf->SetSection("RunControl");
   m_config_at_run_path = conf->Get("config_log_path","");
   std::string additionalDisplays = conf->Get("ADDITIONAL_DISPLAY_NUMBERS","");
@@ -163,25 +209,25 @@ void RunControlGUI::on_btnStart_clicked(){
     bool succ;
     uint32_t run_n = qs_next_run.toInt(&succ);
     if(succ){
-      m_rc->SetRunN(run_n);
+      RunCommand([this, run_n]{m_rc->SetRunN(run_n);});
     }
     txtNextRunNumber->clear();
   }
   if(m_rc)
-    m_rc->StartRun();
+    RunCommand([this]{m_rc->StartRun();});
   if(m_save_config_at_run_start)
       store_config();
 }
 
 void RunControlGUI::on_btnStop_clicked() {
   if(m_rc)
-    m_rc->StopRun();
+    RunCommand([this]{m_rc->StopRun();});
     //update_infos();
 }
 
 void RunControlGUI::on_btnReset_clicked() {
   if(m_rc)
-    m_rc->Reset();
+    RunCommand([this]{m_rc->Reset();});
 }
 
 void RunControlGUI::on_btnLog_clicked() {
@@ -313,6 +359,9 @@ void RunControlGUI::closeEvent(QCloseEvent *event) {
     settings.setValue("lastScanFile", txtScanFile->text());
     settings.setValue("successexit", 1);
     settings.endGroup();
+    std::unique_lock<std::mutex> lk(m_mtx_cmd);
+    m_qu_cmd.clear();
+    lk.unlock();
     if(m_rc)
       m_rc->Terminate();
     event->accept();
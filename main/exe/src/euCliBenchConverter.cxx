@@ -0,0 +1,148 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/Event.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+// The block access patterns of the raw-to-standard converters, once through
+// the copying Event::GetBlock() and once through Event::GetBlockView()
+
+// every block of every sub-event, as the Mimosa and TLU converters read them
+template <bool VIEW>
+uint64_t WalkBlocks(const eudaq::Event &ev){
+  uint64_t s = 0;
+  for(uint32_t i = 0; i < ev.GetNumBlock(); i++){
+    if(VIEW){
+      auto &b = ev.GetBlockView(i);
+      for(size_t j = 0; j < b.size(); j += 4)
+	s += b[j];
+    }
+    else{
+      std::vector<uint8_t> b = ev.GetBlock(i);
+      for(size_t j = 0; j < b.size(); j += 4)
+	s += b[j];
+    }
+  }
+  for(auto &sub: ev.GetSubEvents())
+    s += WalkBlocks<VIEW>(*sub);
+  return s;
+}
+
+// CE65 DecodeFrameData: one short per pixel from every frame block
+const int CE65_NX = 64;
+const int CE65_NY = 32;
+const int CE65_NFRAME = 9;
+template <bool VIEW>
+uint64_t DecodeCE65(const eudaq::Event &ev){
+  uint64_t s = 0;
+  short frame[CE65_NFRAME];
+  for(int p = 0; p < CE65_NX * CE65_NY; p++){
+    for(uint32_t i = 0; i < CE65_NFRAME; i++){
+      if(VIEW){
+	auto &d = ev.GetBlockView(i);
+	frame[i] = short((d[p * 2 + 1] << 8) + d[p * 2]);
+      }
+      else{
+	std::vector<uint8_t> d = ev.GetBlock(i);
+	frame[i] = short((d[p * 2 + 1] << 8) + d[p * 2]);
+      }
+    }
+    s += frame[CE65_NFRAME - 1] - frame[0];
+  }
+  return s;
+}
+
+// MOSS: one pass over a single packet block
+template <bool VIEW>
+uint64_t DecodeMOSS(const eudaq::Event &ev){
+  uint64_t s = 0;
+  if(VIEW){
+    for(uint8_t b: ev.GetBlockView(0))
+      s += b >> 4;
+  }
+  else{
+    std::vector<uint8_t> p = ev.GetBlock(0);
+    for(uint8_t b: p)
+      s += b >> 4;
+  }
+  return s;
+}
+
+// Runs both access paths over the events, returns false if they disagree
+template <typename F, typename G>
+bool Compare(const std::string &name, const std::vector<eudaq::EventSPC> &evs,
+	     uint32_t loops, F copy, G view){
+  uint64_t sum[2] = {0, 0};
+  double us[2];
+  for(int k = 0; k < 2; k++){
+    auto tp_start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < loops; i++)
+      for(auto &ev: evs)
+	sum[k] += k ? view(*ev) : copy(*ev);
+    us[k] = std::chrono::duration<double, std::micro>
+      (std::chrono::steady_clock::now() - tp_start).count() / (double(loops) * evs.size());
+  }
+  std::cout<<name<<": GetBlock "<<us[0]<<" us/event, GetBlockView "<<us[1]<<" us/event"<<std::endl;
+  if(sum[0] != sum[1]){
+    std::cout<<name<<": GetBlock and GetBlockView read different data"<<std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Converter Block Access Benchmark", "2.0",
+			 "Reads event blocks the way the raw-to-standard converters do,"
+			 " copied by Event::GetBlock and by reference through Event::GetBlockView");
+  eudaq::Option<std::string> file_input(op, "i", "input", "", "string",
+					"native file whose events are walked, none to skip");
+  eudaq::Option<uint32_t> n_loop(op, "l", "loops", 1000, "uint32_t", "passes over the events");
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    std::ostringstream err;
+    return op.HandleMainException(err);
+  }
+  uint32_t loops = std::max(n_loop.Value(), 1u);
+  bool same = true;
+
+  std::string infile_path = file_input.Value();
+  if(!infile_path.empty()){
+    std::vector<eudaq::EventSPC> evs;
+    auto reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash("native"), infile_path);
+    while(auto ev = reader->GetNextEvent())
+      evs.push_back(ev);
+    if(evs.empty()){
+      std::cout<<"no events in "<<infile_path<<std::endl;
+      return -1;
+    }
+    same &= Compare(infile_path + ", all blocks", evs, loops,
+		    WalkBlocks<false>, WalkBlocks<true>);
+  }
+
+  std::mt19937 rng(1);
+  auto ce65 = eudaq::Event::MakeShared("CE65RawEvent");
+  for(int f = 0; f < CE65_NFRAME; f++){
+    std::vector<uint8_t> frame(CE65_NX * CE65_NY * 2);
+    for(auto &b: frame)
+      b = uint8_t(rng());
+    ce65->AddBlock(f, frame);
+  }
+  // the copying CE65 path moves a frame per pixel, keep its loop short
+  same &= Compare("synthetic CE65, 64x32 pixels, 9 frames", {ce65},
+		  std::max(loops / 100, 1u), DecodeCE65<false>, DecodeCE65<true>);
+
+  auto moss = eudaq::Event::MakeShared("MOSSRawEvent");
+  std::vector<uint8_t> packet(64 * 1024);
+  for(auto &b: packet)
+    b = uint8_t(rng());
+  moss->AddBlock(0, packet);
+  same &= Compare("synthetic MOSS, 64 KiB packet", {moss}, loops,
+		  DecodeMOSS<false>, DecodeMOSS<true>);
+  return same ? 0 : -1;
+}
@@ -0,0 +1,505 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/TimestampEventBuilder.hh"
+#include "eudaq/TriggerEventBuilder.hh"
+#include "eudaq/Event.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <tuple>
+
+// Checks the event builders of the data collectors and compares them with
+// the merging the data collectors did before
+
+using TsBuilder = eudaq::TimestampEventBuilder;
+using TgBuilder = eudaq::TriggerEventBuilder;
+
+namespace{
+  int n_fail = 0;
+
+  void Check(bool ok, const std::string &what){
+    if(!ok){
+      std::cout<<"FAILED: "<<what<<std::endl;
+      n_fail++;
+    }
+  }
+
+  eudaq::EventSPC MakeTsEvent(uint32_t stream, uint64_t begin, uint64_t end){
+    auto ev = eudaq::Event::MakeShared("TsEvent");
+    ev->SetTimestamp(begin, end);
+    ev->SetStreamN(stream);
+    return ev;
+  }
+
+  std::string Print(uint64_t begin, uint64_t end, const std::vector<eudaq::EventSPC> &evs){
+    std::ostringstream s;
+    s<<"["<<begin<<","<<end<<")";
+    for(auto &ev: evs)
+      s<<" "<<ev->GetStreamN()<<":"<<ev->GetTimestampBegin()<<"-"<<ev->GetTimestampEnd();
+    return s.str();
+  }
+
+  // all windows the builder has ready, separated by '|'
+  std::string PopAll(TsBuilder &b, TsBuilder::Clock::time_point now){
+    std::string r;
+    TsBuilder::Built built;
+    while(b.Pop(built, now))
+      r += Print(built.ts_begin, built.ts_end, built.events) + "|";
+    return r;
+  }
+
+  std::string PopAll(TsBuilder &b){
+    return PopAll(b, TsBuilder::Clock::now());
+  }
+
+  // trigger number and streams of the built events
+  std::string PopAll(TgBuilder &b, TgBuilder::Clock::time_point now){
+    std::ostringstream s;
+    TgBuilder::Built built;
+    while(b.Pop(built, now)){
+      s<<built.trigger_n<<":";
+      for(auto &ev: built.events)
+	s<<" "<<ev->GetStreamN();
+      s<<"|";
+    }
+    return s.str();
+  }
+
+  std::string PopAll(TgBuilder &b){
+    return PopAll(b, TgBuilder::Clock::now());
+  }
+}
+
+// The merging of TimestampSyncDataCollector and Ex0TsDataCollector before
+// TimestampEventBuilder: the window runs from the earliest begin to the
+// earliest end of the first events of all producers, every producer adds
+// at most one event and a spanning event stays for the next window
+class LegacyTsMerger {
+public:
+  explicit LegacyTsMerger(uint32_t n_stream){
+    for(uint32_t i = 0; i < n_stream; i++)
+      m_que[i];
+  }
+
+  void Receive(uint32_t id, eudaq::EventSPC ev, std::vector<std::string> *out){
+    m_que[id].push_back(ev);
+    uint64_t ev_begin = ev->GetTimestampBegin();
+    uint64_t ev_end = ev->GetTimestampEnd();
+    m_ready.insert(id);
+    bool updated = false;
+    if(ev_begin < m_begin){
+      m_begin = ev_begin;
+      updated = true;
+    }
+    if(ev_end < m_end){
+      m_end = ev_end;
+      updated = true;
+    }
+    if(updated){
+      for(auto &que: m_que){
+	if(!que.second.empty() && m_end <= que.second.back()->GetTimestampEnd())
+	  m_ready.insert(que.first);
+	else
+	  m_ready.erase(que.first);
+      }
+    }
+    while(!m_ready.empty() && m_ready.size() == m_que.size()){
+      uint64_t next_end = -1;
+      uint64_t next_begin = next_end - 1;
+      std::vector<eudaq::EventSPC> subs;
+      for(auto &que_p: m_que){
+	auto &que = que_p.second;
+	uint32_t id = que_p.first;
+	eudaq::EventSPC sub;
+	while(!que.empty()){
+	  uint64_t sub_begin = que.front()->GetTimestampBegin();
+	  uint64_t sub_end = que.front()->GetTimestampEnd();
+	  if(sub_end <= m_begin){
+	    que.pop_front();
+	    continue;
+	  }
+	  if(sub_begin >= m_end){
+	    m_ready.insert(id);
+	    next_begin = std::min(next_begin, sub_begin);
+	    next_end = std::min(next_end, sub_end);
+	    break;
+	  }
+	  sub = que.front();
+	  if(sub_end < m_end){
+	    que.pop_front();
+	    continue;
+	  }
+	  if(sub_end == m_end){
+	    que.pop_front();
+	    if(que.empty())
+	      m_ready.erase(id);
+	    continue;
+	  }
+	  if(que.size() > 1){
+	    m_ready.insert(id);
+	    next_begin = std::min(next_begin, que.at(1)->GetTimestampBegin());
+	    next_end = std::min(next_end, que.at(1)->GetTimestampEnd());
+	  }
+	  else
+	    m_ready.erase(id);
+	  break;
+	}
+	if(sub)
+	  subs.push_back(sub);
+      }
+      if(out && !subs.empty())
+	out->push_back(Print(m_begin, m_end, subs));
+      m_n_sub += subs.size();
+      m_begin = next_begin;
+      m_end = next_end;
+    }
+  }
+
+  uint64_t GetNumSub() const {return m_n_sub;}
+
+private:
+  std::map<uint32_t, std::deque<eudaq::EventSPC>> m_que;
+  std::set<uint32_t> m_ready;
+  uint64_t m_begin = uint64_t(-2);
+  uint64_t m_end = uint64_t(-1);
+  uint64_t m_n_sub = 0;
+};
+
+void CheckTsWindows(){
+  // aligned producers, event-defined windows, closing a stream
+  {
+    TsBuilder b;
+    uint32_t s0 = b.AddStream();
+    uint32_t s1 = b.AddStream();
+    b.Push(s0, MakeTsEvent(0, 0, 10));
+    Check(PopAll(b) == "", "a window waits for every stream");
+    b.Push(s1, MakeTsEvent(1, 0, 10));
+    Check(PopAll(b) == "[0,10) 0:0-10 1:0-10|", "aligned window");
+    b.Push(s1, MakeTsEvent(1, 10, 20));
+    b.Push(s1, MakeTsEvent(1, 20, 30));
+    b.Push(s0, MakeTsEvent(0, 10, 20));
+    Check(PopAll(b) == "[10,20) 0:10-20 1:10-20|", "second aligned window");
+    b.CloseStream(s0);
+    Check(PopAll(b) == "[20,30) 1:20-30|", "a closed stream is not waited for");
+    Check(b.GetNumQueued() == 0, "nothing left queued");
+  }
+  // a spanning event is attached to the next window only when shared
+  for(bool share: {true, false}){
+    TsBuilder b;
+    b.SetShareSpanning(share);
+    uint32_t s0 = b.AddStream();
+    uint32_t s1 = b.AddStream();
+    b.Push(s0, MakeTsEvent(0, 0, 10));
+    b.Push(s0, MakeTsEvent(0, 10, 20));
+    b.Push(s1, MakeTsEvent(1, 0, 5));
+    b.Push(s1, MakeTsEvent(1, 5, 15));
+    b.Push(s1, MakeTsEvent(1, 15, 20));
+    b.CloseStream(s0);
+    b.CloseStream(s1);
+    if(share)
+      Check(PopAll(b) == "[0,5) 0:0-10 1:0-5|[5,15) 0:10-20 1:5-15|[15,20) 0:10-20 1:15-20|",
+	    "shared spanning events");
+    else
+      Check(PopAll(b) == "[0,5) 0:0-10 1:0-5|[5,15) 0:10-20 1:5-15|[15,20) 1:15-20|",
+	    "spanning events not shared");
+  }
+  // fixed windows hold every overlapping event, Flush() stops waiting
+  {
+    TsBuilder b;
+    b.SetWindow(100);
+    uint32_t s0 = b.AddStream();
+    uint32_t s1 = b.AddStream();
+    b.Push(s0, MakeTsEvent(0, 5, 5));
+    b.Push(s0, MakeTsEvent(0, 50, 50));
+    b.Push(s0, MakeTsEvent(0, 150, 150));
+    b.Push(s1, MakeTsEvent(1, 90, 120));
+    b.Push(s1, MakeTsEvent(1, 330, 340));
+    Check(PopAll(b) == "[0,100) 0:5-5 0:50-50 1:90-120|", "first fixed window");
+    b.Push(s0, MakeTsEvent(0, 400, 400));
+    Check(PopAll(b) == "[100,200) 0:150-150 1:90-120|", "fixed window with a spanning event");
+    b.Flush();
+    Check(PopAll(b) == "[300,400) 1:330-340|[400,500) 0:400-400|", "flushed fixed windows");
+    b.Push(s0, MakeTsEvent(0, 500, 510));
+    Check(PopAll(b) == "", "the builder waits again after a flush");
+  }
+  // a stalled stream is not waited for, its late events are dropped
+  {
+    TsBuilder b;
+    b.SetTimeout(std::chrono::milliseconds(100));
+    auto t0 = TsBuilder::Clock::now();
+    auto ms = [t0](int n){return t0 + std::chrono::milliseconds(n);};
+    uint32_t s0 = b.AddStream();
+    uint32_t s1 = b.AddStream();
+    b.Push(s0, MakeTsEvent(0, 0, 10), t0);
+    b.Push(s1, MakeTsEvent(1, 0, 10), t0);
+    b.Push(s0, MakeTsEvent(0, 10, 20), t0);
+    b.Push(s0, MakeTsEvent(0, 20, 30), t0);
+    Check(PopAll(b, t0) == "[0,10) 0:0-10 1:0-10|", "window before the stall");
+    b.Push(s0, MakeTsEvent(0, 30, 40), ms(150));
+    Check(b.GetNumStalled(ms(150)) == 1, "one stalled stream");
+    Check(PopAll(b, ms(150)) == "[10,20) 0:10-20|[20,30) 0:20-30|[30,40) 0:30-40|",
+	  "windows built without the stalled stream");
+    b.Push(s1, MakeTsEvent(1, 15, 25), ms(160));
+    Check(b.GetNumDropped() == 1, "late event dropped");
+    b.Push(s1, MakeTsEvent(1, 40, 50), ms(160));
+    Check(PopAll(b, ms(160)) == "", "a stream is waited for again once it delivers");
+    b.Push(s0, MakeTsEvent(0, 40, 60), ms(170));
+    Check(PopAll(b, ms(170)) == "[40,50) 0:40-60 1:40-50|", "window after the stall");
+  }
+  // events of a stream must come in order
+  {
+    TsBuilder b;
+    uint32_t s0 = b.AddStream();
+    b.Push(s0, MakeTsEvent(0, 10, 20));
+    bool thrown = false;
+    try{
+      b.Push(s0, MakeTsEvent(0, 5, 8));
+    }
+    catch(...){
+      thrown = true;
+    }
+    Check(thrown, "out of order event refused");
+  }
+}
+
+// Same windows as the legacy merging, on streams of the given kind:
+// 0 aligned, 1 different rates, 2 random lengths and gaps
+void CompareTsLegacy(uint32_t n_stream, int kind, uint32_t n_event, uint32_t n_rep){
+  std::mt19937 rng(n_stream * 3 + kind);
+  uint32_t n_ev_stream = std::max(n_event / n_stream, 2u);
+  std::vector<std::vector<eudaq::EventSPC>> evs(n_stream);
+  for(uint32_t p = 0; p < n_stream; p++){
+    uint64_t t = 0;
+    for(uint32_t k = 0; k < n_ev_stream; k++){
+      uint64_t len = kind == 0 ? 100 : (kind == 1 ? 100 + 7 * p : 1 + rng() % 200);
+      if(kind == 2)
+	t += rng() % 50;
+      evs[p].push_back(MakeTsEvent(p, t, t + len));
+      t += len;
+    }
+  }
+  // arrival order: by end, each stream delayed by a random transport time
+  std::vector<std::tuple<uint64_t, uint32_t, uint32_t>> order;
+  for(uint32_t p = 0; p < n_stream; p++){
+    uint64_t t = 0;
+    for(uint32_t k = 0; k < n_ev_stream; k++){
+      t = std::max<uint64_t>(t, evs[p][k]->GetTimestampEnd() + rng() % 1000);
+      order.emplace_back(t, p, k);
+    }
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<std::string> w_legacy, w_builder;
+  double t_legacy = 1e9, t_builder = 1e9;
+  for(uint32_t rep = 0; rep < n_rep; rep++){
+    LegacyTsMerger legacy(n_stream);
+    auto tp_start = std::chrono::steady_clock::now();
+    for(auto &o: order)
+      legacy.Receive(std::get<1>(o), evs[std::get<1>(o)][std::get<2>(o)], rep ? nullptr : &w_legacy);
+    t_legacy = std::min(t_legacy, std::chrono::duration<double>
+			(std::chrono::steady_clock::now() - tp_start).count());
+
+    TsBuilder b;
+    for(uint32_t p = 0; p < n_stream; p++)
+      b.AddStream();
+    TsBuilder::Built built;
+    tp_start = std::chrono::steady_clock::now();
+    for(auto &o: order){
+      b.Push(std::get<1>(o), evs[std::get<1>(o)][std::get<2>(o)]);
+      while(b.Pop(built))
+	if(!rep)
+	  w_builder.push_back(Print(built.ts_begin, built.ts_end, built.events));
+    }
+    t_builder = std::min(t_builder, std::chrono::duration<double>
+			 (std::chrono::steady_clock::now() - tp_start).count());
+  }
+  const char *kinds[] = {"aligned", "rates", "random"};
+  std::cout<<"timestamp, "<<kinds[kind]<<", "<<n_stream<<" producers: legacy "
+	   <<t_legacy * 1e9 / order.size()<<" ns/event, builder "
+	   <<t_builder * 1e9 / order.size()<<" ns/event"<<std::endl;
+  // the legacy merging holds back the last window until the next event
+  bool same = w_builder.size() >= w_legacy.size() &&
+    std::equal(w_legacy.begin(), w_legacy.end(), w_builder.begin());
+  Check(same, std::string("same windows as the legacy merging, ") + kinds[kind] +
+	", " + std::to_string(n_stream) + " producers");
+}
+
+// The merging of TriggerIDSyncDataCollector before TriggerEventBuilder:
+// one queue per producer, the smallest first trigger number is built once
+// every queue holds an event
+class LegacyTgMerger {
+public:
+  explicit LegacyTgMerger(uint32_t n_stream){
+    for(uint32_t i = 0; i < n_stream; i++)
+      m_que[i];
+  }
+
+  void Receive(uint32_t id, uint32_t n, eudaq::EventSPC ev){
+    m_que[id].emplace_back(n, ev);
+    uint32_t trigger_n = -1;
+    for(auto &que: m_que){
+      if(que.second.empty())
+	return;
+      trigger_n = std::min(trigger_n, que.second.front().first);
+    }
+    m_out.clear();
+    for(auto &que: m_que){
+      if(que.second.front().first == trigger_n){
+	m_out.push_back(que.second.front().second);
+	que.second.pop_front();
+      }
+    }
+    m_n_built++;
+  }
+
+  uint64_t GetNumBuilt() const {return m_n_built;}
+
+private:
+  std::map<uint32_t, std::deque<std::pair<uint32_t, eudaq::EventSPC>>> m_que;
+  std::vector<eudaq::EventSPC> m_out;
+  uint64_t m_n_built = 0;
+};
+
+void CheckTgBuilds(){
+  // in order, out of order and far ahead, which takes the hash map
+  {
+    TgBuilder b;
+    uint32_t s0 = b.AddStream();
+    uint32_t s1 = b.AddStream();
+    b.Push(s0, 1, MakeTsEvent(0, 0, 0));
+    b.Push(s0, 2, MakeTsEvent(0, 0, 0));
+    b.Push(s0, 1000, MakeTsEvent(0, 0, 0));
+    Check(PopAll(b) == "", "a trigger waits for every stream");
+    b.Push(s1, 2, MakeTsEvent(1, 0, 0));
+    Check(b.GetNumPending() == 3, "pending trigger numbers");
+    b.Push(s1, 1, MakeTsEvent(1, 0, 0));
+    Check(PopAll(b) == "1: 0 1|2: 0 1|", "triggers built in order");
+    b.Push(s1, 1000, MakeTsEvent(1, 0, 0));
+    Check(PopAll(b) == "1000: 0 1|", "trigger number far ahead");
+    Check(b.GetNumPending() == 0, "nothing left pending");
+  }
+  // a skipped trigger is built without the stream once it went past
+  {
+    TgBuilder b;
+    b.SetReorderWindow(1);
+    uint32_t s0 = b.AddStream();
+    uint32_t s1 = b.AddStream();
+    b.Push(s0, 1, MakeTsEvent(0, 0, 0));
+    b.Push(s0, 2, MakeTsEvent(0, 0, 0));
+    b.Push(s0, 3, MakeTsEvent(0, 0, 0));
+    b.Push(s1, 2, MakeTsEvent(1, 0, 0));
+    Check(PopAll(b) == "", "reorder window not passed yet");
+    b.Push(s1, 3, MakeTsEvent(1, 0, 0));
+    Check(PopAll(b) == "1: 0|2: 0 1|3: 0 1|", "skipped trigger built");
+    Check(b.GetNumMissing(s1) == 1 && b.GetNumMissing(s0) == 0, "skipped trigger counted as missing");
+    b.Push(s1, 3, MakeTsEvent(1, 0, 0));
+    b.Push(s1, 1, MakeTsEvent(1, 0, 0));
+    Check(b.GetNumDuplicated(s1) == 1 && b.GetNumLate(s1) == 1, "duplicated and late events dropped");
+  }
+  // timeout, closed streams and flush
+  {
+    TgBuilder b;
+    b.SetTimeout(std::chrono::milliseconds(100));
+    auto t0 = TgBuilder::Clock::now();
+    uint32_t s0 = b.AddStream();
+    uint32_t s1 = b.AddStream();
+    uint32_t s2 = b.AddStream();
+    b.Push(s0, 5, MakeTsEvent(0, 0, 0), t0);
+    b.Push(s1, 5, MakeTsEvent(1, 0, 0), t0);
+    Check(PopAll(b, t0) == "", "before the timeout");
+    Check(PopAll(b, t0 + std::chrono::milliseconds(150)) == "5: 0 1|", "built by the timeout");
+    b.Push(s0, 6, MakeTsEvent(0, 0, 0), t0);
+    b.CloseStream(s2);
+    b.Push(s1, 6, MakeTsEvent(1, 0, 0), t0);
+    Check(PopAll(b, t0) == "6: 0 1|", "a closed stream is not waited for");
+    b.Push(s0, 7, MakeTsEvent(0, 0, 0), t0);
+    b.Flush();
+    Check(PopAll(b, t0) == "7: 0|", "flushed");
+    Check(b.GetNumMissing(s1) == 1 && b.GetNumMissing(s2) == 1, "missing after timeout and flush");
+  }
+}
+
+// Same number of built events as the legacy merging when every producer
+// delivers every trigger, in a random order within each trigger
+void CompareTgLegacy(uint32_t n_stream, uint32_t n_event, uint32_t n_rep){
+  std::mt19937 rng(n_stream);
+  uint32_t n_trigger = std::max(n_event / n_stream, 1u);
+  std::vector<eudaq::EventSPC> evs;
+  for(uint32_t p = 0; p < n_stream; p++)
+    evs.push_back(MakeTsEvent(p, 0, 0));
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> perm(n_stream);
+  for(uint32_t k = 0; k < n_trigger; k++){
+    for(uint32_t p = 0; p < n_stream; p++)
+      perm[p] = p;
+    std::shuffle(perm.begin(), perm.end(), rng);
+    order.insert(order.end(), perm.begin(), perm.end());
+  }
+
+  uint64_t n_legacy = 0, n_builder = 0;
+  double t_legacy = 1e9, t_builder = 1e9;
+  std::vector<uint32_t> trigger_n(n_stream);
+  for(uint32_t rep = 0; rep < n_rep; rep++){
+    LegacyTgMerger legacy(n_stream);
+    std::fill(trigger_n.begin(), trigger_n.end(), 0);
+    auto tp_start = std::chrono::steady_clock::now();
+    for(auto p: order)
+      legacy.Receive(p, trigger_n[p]++, evs[p]);
+    t_legacy = std::min(t_legacy, std::chrono::duration<double>
+			(std::chrono::steady_clock::now() - tp_start).count());
+    n_legacy = legacy.GetNumBuilt();
+
+    TgBuilder b;
+    for(uint32_t p = 0; p < n_stream; p++)
+      b.AddStream();
+    std::fill(trigger_n.begin(), trigger_n.end(), 0);
+    TgBuilder::Built built;
+    n_builder = 0;
+    tp_start = std::chrono::steady_clock::now();
+    for(auto p: order){
+      b.Push(p, trigger_n[p]++, evs[p]);
+      while(b.Pop(built))
+	n_builder += built.events.size() == n_stream;
+    }
+    t_builder = std::min(t_builder, std::chrono::duration<double>
+			 (std::chrono::steady_clock::now() - tp_start).count());
+  }
+  std::cout<<"trigger, "<<n_stream<<" producers: legacy "
+	   <<t_legacy * 1e9 / order.size()<<" ns/event, builder "
+	   <<t_builder * 1e9 / order.size()<<" ns/event"<<std::endl;
+  Check(n_builder == n_trigger && n_legacy == n_trigger,
+	"complete events, " + std::to_string(n_stream) + " producers");
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Event Builder Benchmark", "2.0",
+			 "Checks the event builders of the data collectors and times them"
+			 " against the merging the data collectors did before");
+  eudaq::Option<uint32_t> n_event(op, "e", "events", 200000, "uint32_t", "events over all producers");
+  eudaq::Option<uint32_t> n_max(op, "p", "producers", 128, "uint32_t", "largest number of producers");
+  eudaq::Option<uint32_t> n_rep(op, "r", "repeat", 3, "uint32_t", "timed passes, the fastest counts");
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    std::ostringstream err;
+    return op.HandleMainException(err);
+  }
+  uint32_t events = std::max(n_event.Value(), 1u);
+  uint32_t rep = std::max(n_rep.Value(), 1u);
+
+  CheckTsWindows();
+  for(int kind = 0; kind < 3; kind++)
+    for(uint32_t n = 2; n <= n_max.Value(); n *= 4)
+      CompareTsLegacy(n, kind, events, rep);
+  CheckTgBuilds();
+  for(uint32_t n = 2; n <= n_max.Value(); n *= 2)
+    CompareTgLegacy(n, events, rep);
+  std::cout<<(n_fail ? "event builder checks failed" : "event builder checks passed")<<std::endl;
+  return n_fail ? -1 : 0;
+}
@@ -0,0 +1,107 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/TransportTCP.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// The reassembly ConnectionInfoTCP did before the read offset: every packet
+// is erased from the front of the buffer
+struct EraseReassembly {
+  size_t m_len = 0;
+  std::string m_buf;
+  void append(size_t length, const char *data){
+    m_buf += std::string(data, length);
+    update_length();
+  }
+  bool havepacket() const {
+    return m_buf.length() >= m_len + 4;
+  }
+  std::string getpacket(){
+    std::string packet(m_buf, 4, m_len);
+    m_buf.erase(0, m_len + 4);
+    update_length(true);
+    return packet;
+  }
+  void update_length(bool force = false){
+    if(force || m_len == 0){
+      m_len = 0;
+      if(m_buf.length() >= 4)
+	for(int i = 0; i < 4; ++i)
+	  m_len |= static_cast<size_t>(static_cast<unsigned char>(m_buf[i])) << (8 * i);
+    }
+  }
+};
+
+// Feeds the stream in recv-sized chunks and takes out all complete packets
+template <typename T>
+double Reassemble(T &con, const std::string &stream, size_t chunk,
+		  size_t &n_packet, size_t &n_byte){
+  auto tp_start = std::chrono::steady_clock::now();
+  for(size_t offset = 0; offset < stream.size(); offset += chunk){
+    con.append(std::min(chunk, stream.size() - offset), stream.data() + offset);
+    while(con.havepacket()){
+      n_byte += con.getpacket().size();
+      n_packet ++;
+    }
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Packet Reassembly Benchmark", "2.0",
+			 "Reassembles a stream of length-prefixed packets fed in recv-sized chunks,"
+			 " with ConnectionInfoTCP and with the former erase-from-front buffer");
+  eudaq::Option<uint32_t> total_kib(op, "t", "total", 65536, "KiB", "size of the stream");
+  eudaq::OptionFlag skip_erase(op, "n", "new-only", "skip the erase-from-front buffer");
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    std::ostringstream err;
+    return op.HandleMainException(err);
+  }
+  size_t total = size_t(std::max(total_kib.Value(), 1u)) * 1024;
+
+  // many small packets against few large ones, in small and large reads
+  struct Case {size_t packet; size_t chunk;};
+  const Case cases[] = {{8, 64 << 10}, {8, 4 << 20}, {100, 64 << 10},
+			{100000, 64 << 10}, {100000, 4 << 20}, {10 << 20, 4 << 20}};
+  for(auto &c: cases){
+    std::string stream;
+    std::string payload(c.packet, 'x');
+    stream.reserve(total + c.packet + 4);
+    do{
+      uint32_t len = c.packet;
+      for(int i = 0; i < 4; i++, len >>= 8)
+	stream.push_back(char(len & 0xff));
+      stream += payload;
+    }while(stream.size() < total);
+
+    size_t n_new = 0, b_new = 0, n_old = 0, b_old = 0;
+    eudaq::ConnectionInfoTCP con(0);
+    double t_new = Reassemble(con, stream, c.chunk, n_new, b_new);
+    std::cout<<"packet "<<c.packet<<" B, recv chunk "<<c.chunk / 1024<<" KiB, "
+	     <<n_new<<" packets: offset buffer "<<t_new<<" s";
+    // the erase moves about half a read per packet, which takes ages for
+    // tiny packets in large reads
+    double moved = double(stream.size()) * c.chunk / (2.0 * (c.packet + 4));
+    if(!skip_erase.Value() && moved > 1e12)
+      std::cout<<", erase from front skipped ("<<moved / 1e9<<" GB to move)";
+    else if(!skip_erase.Value()){
+      EraseReassembly old;
+      double t_old = Reassemble(old, stream, c.chunk, n_old, b_old);
+      std::cout<<", erase from front "<<t_old<<" s";
+      if(n_old != n_new || b_old != b_new){
+	std::cout<<std::endl<<"packets differ"<<std::endl;
+	return -1;
+      }
+    }
+    std::cout<<std::endl;
+    if(b_new != n_new * c.packet || n_new * (c.packet + 4) != stream.size())
+      return -1;
+  }
+  return 0;
+}
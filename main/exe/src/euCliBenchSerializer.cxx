@@ -0,0 +1,142 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/BufferSerializer.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+// StandardPlane-like payload: 3 x vector<vector<double>> and a vector<uint64_t>
+struct Plane {
+  std::vector<std::vector<double>> x, y, pix;
+  std::vector<uint64_t> time;
+};
+
+// the element by element loop Serializer::write(vector) ran before the block path
+template <typename T>
+void WriteLoop(eudaq::Serializer &ser, const std::vector<T> &t){
+  ser.write(uint32_t(t.size()));
+  for(auto &e: t)
+    ser.write(e);
+}
+
+template <typename T>
+void ReadLoop(eudaq::Deserializer &des, std::vector<T> &t){
+  uint32_t len = des.read<uint32_t>();
+  t.reserve(len);
+  for(uint32_t i = 0; i < len; i++)
+    t.push_back(des.read<T>());
+}
+
+template <typename T>
+void WriteLoop(eudaq::Serializer &ser, const std::vector<std::vector<T>> &t){
+  ser.write(uint32_t(t.size()));
+  for(auto &e: t)
+    WriteLoop(ser, e);
+}
+
+template <typename T>
+void ReadLoop(eudaq::Deserializer &des, std::vector<std::vector<T>> &t){
+  uint32_t len = des.read<uint32_t>();
+  t.resize(len);
+  for(auto &e: t)
+    ReadLoop(des, e);
+}
+
+void WriteBlock(eudaq::Serializer &ser, const Plane &p){
+  ser.write(p.x);
+  ser.write(p.y);
+  ser.write(p.pix);
+  ser.write(p.time);
+}
+
+void ReadBlock(eudaq::Deserializer &des, Plane &p){
+  des.read(p.x);
+  des.read(p.y);
+  des.read(p.pix);
+  des.read(p.time);
+}
+
+void WriteElements(eudaq::Serializer &ser, const Plane &p){
+  WriteLoop(ser, p.x);
+  WriteLoop(ser, p.y);
+  WriteLoop(ser, p.pix);
+  WriteLoop(ser, p.time);
+}
+
+void ReadElements(eudaq::Deserializer &des, Plane &p){
+  ReadLoop(des, p.x);
+  ReadLoop(des, p.y);
+  ReadLoop(des, p.pix);
+  ReadLoop(des, p.time);
+}
+
+bool Equal(const Plane &a, const Plane &b){
+  return a.x == b.x && a.y == b.y && a.pix == b.pix && a.time == b.time;
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Serializer Benchmark", "2.0",
+			 "Writes and reads a StandardPlane-like payload through a BufferSerializer,"
+			 " element by element and as contiguous blocks");
+  eudaq::Option<uint32_t> n_hit(op, "n", "hits", 1000, "uint32_t", "hits per plane");
+  eudaq::Option<uint32_t> n_loop(op, "l", "loops", 20000, "uint32_t", "planes to write and read");
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    std::ostringstream err;
+    return op.HandleMainException(err);
+  }
+  uint32_t n = n_hit.Value();
+  uint32_t loops = std::max(n_loop.Value(), 1u);
+  Plane src;
+  src.x.assign(1, std::vector<double>(n));
+  src.y.assign(1, std::vector<double>(n));
+  src.pix.assign(1, std::vector<double>(n));
+  src.time.resize(n);
+  for(uint32_t i = 0; i < n; i++){
+    src.x[0][i] = i % 1152;
+    src.y[0][i] = i % 576;
+    src.pix[0][i] = 1.5 * i;
+    src.time[i] = 0x0123456789abcdefULL + i;
+  }
+
+  // both paths must produce the same bytes and read them back unchanged
+  eudaq::BufferSerializer ser_block, ser_elem;
+  WriteBlock(ser_block, src);
+  WriteElements(ser_elem, src);
+  Plane dst_block, dst_elem;
+  ReadBlock(ser_elem, dst_block);
+  ReadElements(ser_block, dst_elem);
+  if(ser_block.size() != ser_elem.size() || !Equal(src, dst_block) || !Equal(src, dst_elem)){
+    std::cout<<"block and element serialization differ"<<std::endl;
+    return -1;
+  }
+
+  double us[2];
+  for(int k = 0; k < 2; k++){
+    auto tp_start = std::chrono::steady_clock::now();
+    size_t n_read = 0;
+    for(uint32_t i = 0; i < loops; i++){
+      eudaq::BufferSerializer ser;
+      Plane p;
+      if(k){
+	WriteBlock(ser, src);
+	ReadBlock(ser, p);
+      }
+      else{
+	WriteElements(ser, src);
+	ReadElements(ser, p);
+      }
+      n_read += p.time.size();
+    }
+    us[k] = std::chrono::duration<double, std::micro>
+      (std::chrono::steady_clock::now() - tp_start).count() / loops;
+    if(n_read != size_t(loops) * n)
+      return -1;
+  }
+  std::cout<<n<<" hits per plane, write and read: element by element "<<us[0]
+	   <<" us, block "<<us[1]<<" us"<<std::endl;
+  return 0;
+}
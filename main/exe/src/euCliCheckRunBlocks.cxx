@@ -0,0 +1,155 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/FileWriter.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/FileSerializer.hh"
+#include "eudaq/FileIndex.hh"
+#include "eudaq/Event.hh"
+#include "eudaq/Exception.hh"
+
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+
+// The run-constant blocks are sent with the BORE only, the readers attach
+// them to the later events of the stream. The file written here has three
+// streams: the BORE of stream 1 leads the file, the one of stream 2 follows
+// data of stream 1, and the one of stream 3 is a sub-event of a batch. The
+// sequential, the seeking and the mapped reader must all return block 2 on
+// every later event; with an index of version 1, which has no BORE marks, a
+// seek falls back to the leading BOREs.
+
+const uint32_t RUN_BLOCK = 2;
+
+eudaq::EventSP MakeEvent(uint32_t stream, uint32_t n, bool bore){
+  auto ev = eudaq::Event::MakeShared("CheckRunBlocksEvent");
+  ev->SetStreamN(stream);
+  ev->AddBlock(0, std::vector<uint8_t>(8, uint8_t(n)));
+  if(bore){
+    ev->SetBORE();
+    ev->AddBlock(RUN_BLOCK, std::vector<uint8_t>(16, uint8_t(stream)));
+    ev->SetTag("EUDAQ_RUN_BLOCKS", std::to_string(RUN_BLOCK));
+  }
+  return ev;
+}
+
+void WriteFile(const std::string &path, uint32_t n_ev){
+  std::remove(path.c_str());
+  std::remove(eudaq::FileIndex::IndexPath(path).c_str());
+  auto wr = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::cstr2hash("native"), std::string(path));
+  if(!wr)
+    EUDAQ_THROW("CheckRunBlocks: no native writer");
+  uint32_t n = 0;
+  auto write = [&](eudaq::EventSP ev){
+    ev->SetEventN(n++);
+    wr->WriteEvent(ev);
+  };
+  write(MakeEvent(1, 0, true));
+  write(MakeEvent(1, 1, false));
+  write(MakeEvent(2, 0, true));
+  for(uint32_t i = 2; n < n_ev; i++){
+    if(i == 10){
+      auto batch = eudaq::Event::MakeShared("EventBatch");
+      batch->SetFlagPacket();
+      batch->AddSubEvent(MakeEvent(3, 0, true));
+      batch->AddSubEvent(MakeEvent(3, i, false));
+      write(batch);
+    }
+    else if(i > 10 || i % 3 != 2)
+      write(MakeEvent(i % 3 + 1, i, false));
+  }
+}
+
+// Rewrites the index in the format of version 1, without the flags
+void WriteIndexV1(const std::string &path){
+  eudaq::FileIndex idx;
+  if(!idx.Load(eudaq::FileIndex::IndexPath(path)))
+    EUDAQ_THROW("CheckRunBlocks: no index for " + path);
+  eudaq::FileSerializer ser(eudaq::FileIndex::IndexPath(path), true);
+  std::string magic = "EUDAQIDX";
+  ser.append(reinterpret_cast<const uint8_t *>(magic.data()), magic.size());
+  ser.write(uint32_t(1));
+  for(size_t i = 0; i < idx.Size(); i++){
+    auto &e = idx.At(i);
+    ser.write(e.offset);
+    ser.write(e.ev_n);
+    ser.write(e.tg_n);
+    ser.write(e.ts_begin);
+    ser.write(e.ts_end);
+  }
+  ser.Flush();
+}
+
+// Counts the events of the given streams which miss the block of their BORE
+uint32_t CountMissing(eudaq::EventSPC ev, const std::set<uint32_t> &streams){
+  uint32_t missing = 0;
+  if(!ev->IsBORE() && !ev->IsFlagPacket() && streams.count(ev->GetStreamN())){
+    auto b = ev->GetBlock(RUN_BLOCK);
+    if(b.size() != 16 || b[0] != ev->GetStreamN())
+      missing++;
+  }
+  for(auto &subev: ev->GetSubEvents())
+    missing += CountMissing(subev, streams);
+  return missing;
+}
+
+bool CheckRead(const std::string &name, const std::string &reader, const std::string &path,
+	       int64_t seek, uint32_t n_expected, const std::set<uint32_t> &streams){
+  auto rd = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::cstr2hash(reader.c_str()), std::string(path));
+  if(!rd){
+    std::cout<<name<<": no "<<reader<<" reader"<<std::endl;
+    return false;
+  }
+  if(seek >= 0 && !rd->SeekEvent(seek)){
+    std::cout<<name<<": seek to event "<<seek<<" failed"<<std::endl;
+    return false;
+  }
+  uint32_t n = 0;
+  uint32_t missing = 0;
+  while(auto ev = rd->GetNextEvent()){
+    n++;
+    missing += CountMissing(ev, streams);
+  }
+  bool ok = n == n_expected && !missing;
+  std::cout<<name<<": "<<n<<" events, "<<missing<<" without the run block"
+	   <<(ok ? "" : ", FAILED")<<std::endl;
+  return ok;
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Run Block Check", "2.0",
+			 "Writes a file of several streams and checks that every reader"
+			 " attaches the run blocks of the BOREs to the later events");
+  eudaq::Option<std::string> file(op, "o", "output", "run_blocks.raw", "string",
+				  "scratch file to write and read");
+  eudaq::Option<uint32_t> events(op, "n", "events", 2000, "uint32_t",
+				 "number of events in the file");
+  eudaq::OptionFlag mmap(op, "m", "mmap", "also check the memory-mapped reader");
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    std::ostringstream err;
+    return op.HandleMainException(err);
+  }
+  std::string path = file.Value();
+  uint32_t n_ev = events.Value();
+  uint32_t seek = n_ev * 3 / 4;
+  std::set<uint32_t> all = {1, 2, 3};
+  WriteFile(path, n_ev);
+
+  bool ok = CheckRead("sequential", "native", path, -1, n_ev, all);
+  ok = CheckRead("seek", "native", path, seek, n_ev - seek, all) && ok;
+  if(mmap.Value()){
+    ok = CheckRead("mmap sequential", "native-mmap", path, -1, n_ev, all) && ok;
+    ok = CheckRead("mmap seek", "native-mmap", path, seek, n_ev - seek, all) && ok;
+  }
+  // only the BORE of stream 1 leads the file
+  WriteIndexV1(path);
+  ok = CheckRead("seek, version 1 index", "native", path, seek, n_ev - seek, {1}) && ok;
+  if(mmap.Value())
+    ok = CheckRead("mmap seek, version 1 index", "native-mmap", path, seek, n_ev - seek, {1}) && ok;
+  std::cout<<(ok ? "run blocks checked" : "run block check FAILED")<<std::endl;
+  return ok ? 0 : -1;
+}
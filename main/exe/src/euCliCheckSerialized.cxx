@@ -0,0 +1,135 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/BufferSerializer.hh"
+#include "eudaq/Event.hh"
+#include "eudaq/StandardEvent.hh"
+
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Every modification of an event must drop the serialized form cached by
+// Event::GetSerialized(). Each step below serializes the event, modifies
+// it, and compares the cached bytes with those of a copy made without any
+// cache: the event is read back from the bytes and serialized again.
+
+class StringSerializer : public eudaq::Serializer {
+public:
+  explicit StringSerializer(std::string &buf) :m_buf(buf){}
+private:
+  void Serialize(const uint8_t *data, size_t len) override {
+    m_buf.append(reinterpret_cast<const char*>(data), len);
+  }
+  std::string &m_buf;
+};
+
+std::string Uncached(const std::string &bytes){
+  std::shared_ptr<std::vector<uint8_t>> buf(new std::vector<uint8_t>(bytes.begin(), bytes.end()));
+  eudaq::BufferDeserializer des(buf);
+  uint32_t id;
+  des.PreRead(id);
+  eudaq::EventUP copy = eudaq::Factory<eudaq::Event>::Create<eudaq::Deserializer&>(id, des);
+  std::string out;
+  StringSerializer ser(out);
+  copy->Serialize(ser);
+  return out;
+}
+
+// reread is false while the event type is not registered with the factory
+template <typename EV>
+bool Check(const std::string &name, EV &ev, std::function<void(EV&)> modify,
+	   bool reread = true){
+  auto before = ev.GetSerialized();
+  modify(ev);
+  auto after = ev.GetSerialized();
+  std::string direct;
+  StringSerializer ser(direct);
+  ev.Serialize(ser);
+  bool ok = *after != *before && *after == direct && (!reread || Uncached(*after) == direct);
+  if(!ok)
+    std::cout<<name<<": the cached serialization is out of date"<<std::endl;
+  return ok;
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Serialization Cache Check", "2.0",
+			 "Modifies events through every setter and checks that the serialized"
+			 " form cached by Event::GetSerialized is made again");
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    std::ostringstream err;
+    return op.HandleMainException(err);
+  }
+  using E = eudaq::Event;
+  using S = eudaq::StandardEvent;
+  bool ok = true;
+  uint32_t n_check = 0;
+  auto check = [&](const std::string &name, E &ev, std::function<void(E&)> f,
+		   bool reread = true){
+    ok &= Check<E>(name, ev, f, reread);
+    n_check++;
+  };
+  auto check_std = [&](const std::string &name, S &ev, std::function<void(S&)> f){
+    ok &= Check<S>(name, ev, f);
+    n_check++;
+  };
+
+  auto ev = E::MakeShared("CheckSerializedEvent");
+  E &e = *ev;
+  check("SetTag", e, [](E &x){x.SetTag("key", "value");});
+  check("SetTag<int>", e, [](E &x){x.SetTag("number", 42);});
+  check("SetFlagBit", e, [](E &x){x.SetFlagBit(0x100);});
+  check("ClearFlagBit", e, [](E &x){x.ClearFlagBit(0x100);});
+  check("SetBORE", e, [](E &x){x.SetBORE();});
+  check("SetEORE", e, [](E &x){x.SetEORE();});
+  check("SetFlagFake", e, [](E &x){x.SetFlagFake();});
+  check("SetFlagPacket", e, [](E &x){x.SetFlagPacket();});
+  check("SetFlagTimestamp", e, [](E &x){x.SetFlagTimestamp();});
+  check("SetFlagTrigger", e, [](E &x){x.SetFlagTrigger();});
+  check("SetFlag", e, [](E &x){x.SetFlag(0);});
+  check("SetType", e, [](E &x){x.SetType(eudaq::cstr2hash("OtherType"));}, false);
+  check("SetEventID", e, [](E &x){x.SetEventID(eudaq::cstr2hash("RawEvent"));});
+  check("SetVersion", e, [](E &x){x.SetVersion(7);});
+  check("SetRunN", e, [](E &x){x.SetRunN(12);});
+  check("SetEventN", e, [](E &x){x.SetEventN(34);});
+  check("SetDeviceN", e, [](E &x){x.SetDeviceN(56);});
+  check("SetStreamN", e, [](E &x){x.SetStreamN(78);});
+  check("SetTriggerN", e, [](E &x){x.SetTriggerN(90);});
+  check("SetExtendWord", e, [](E &x){x.SetExtendWord(11);});
+  check("SetTimestamp", e, [](E &x){x.SetTimestamp(100, 200);});
+  check("SetDescription", e, [](E &x){x.SetDescription("description");});
+  check("AddBlock(vector)", e, [](E &x){x.AddBlock(0, std::vector<uint16_t>{1, 2, 3});});
+  check("AddBlock(pointer)", e, [](E &x){uint32_t d[2] = {4, 5}; x.AddBlock(1, d, sizeof(d));});
+  check("AddBlock(moved)", e, [](E &x){x.AddBlock(2, std::vector<uint8_t>(16, 6));});
+  check("AppendBlock", e, [](E &x){x.AppendBlock(2, std::vector<uint8_t>(4, 7));});
+
+  // a sub-event carrying its own cache, like one received from a producer
+  auto sub = E::MakeShared("CheckSerializedSubEvent");
+  sub->AddBlock(0, std::vector<uint8_t>(8, 8));
+  sub->GetSerialized();
+  check("AddSubEvent", e, [&sub](E &x){x.AddSubEvent(sub);});
+  check("sub-event setter, AddSubEvent", e, [](E &x){
+      auto s = E::MakeShared("CheckSerializedSubEvent");
+      s->GetSerialized();
+      s->SetTriggerN(3);
+      x.AddSubEvent(s);
+    });
+
+  auto stdev = S::MakeShared();
+  S &s = *stdev;
+  check_std("StandardEvent SetTimeBegin", s, [](S &x){x.SetTimeBegin(1000);});
+  check_std("StandardEvent SetTimeEnd", s, [](S &x){x.SetTimeEnd(2000);});
+  check_std("StandardEvent AddPlane", s, [](S &x){
+      eudaq::StandardPlane plane(0, "CheckPlane", "CheckSensor");
+      plane.SetSizeZS(16, 16, 0);
+      x.AddPlane(plane);
+    });
+  check_std("StandardEvent GetPlane PushPixel", s, [](S &x){x.GetPlane(0).PushPixel(3, 4, 5);});
+  check_std("StandardEvent GetPlane SetSizeZS", s, [](S &x){x.GetPlane(0).SetSizeZS(32, 32, 0);});
+  check_std("StandardEvent SetTag", s, [](S &x){x.SetTag("key", "value");});
+
+  std::cout<<n_check<<" modifications checked"<<(ok ? "" : ", some FAILED")<<std::endl;
+  return ok ? 0 : -1;
+}
@@ -3,6 +3,168 @@
 #include "eudaq/FileWriter.hh"
 #include "eudaq/FileReader.hh"
 #include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <vector>
+#include <exception>
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  struct StageStat {
+    std::string name;
+    uint64_t n_ev = 0;
+    double busy_s = 0; // summed over all threads of the stage
+  };
+
+  void PrintStats(const std::vector<StageStat> &stats, double wall_s, uint32_t n_worker){
+    std::cout<<"Converted in "<<std::fixed<<std::setprecision(2)<<wall_s<<" s with "
+	     <<n_worker<<" conversion threads"<<std::endl;
+    for(auto &st: stats){
+      std::cout<<"  "<<std::setw(8)<<std::left<<st.name<<std::right
+	       <<std::setw(10)<<st.n_ev<<" events, busy "
+	       <<std::setw(8)<<st.busy_s<<" s, "
+	       <<std::setw(10)<<(st.busy_s > 0 ? st.n_ev/st.busy_s : 0)<<" events/s/thread"
+	       <<std::endl;
+    }
+  }
+
+  double Seconds(Clock::duration d){
+    return std::chrono::duration<double>(d).count();
+  }
+
+  /* Pipelined conversion: one reader thread, n_worker threads running the
+   * (thread-safe) FileWriter::PrepareEvent, and the calling thread writing
+   * the prepared events in their original order. At most max_inflight
+   * events are between reading and writing at any time.
+   */
+  std::vector<StageStat> ConvertParallel(eudaq::FileReader &reader, eudaq::FileWriter *writer,
+					 bool print_ev_in, uint32_t n_worker){
+    const uint64_t max_inflight = 16 * n_worker;
+    std::mutex mx;
+    std::condition_variable cv_read, cv_work, cv_write;
+    std::deque<std::pair<uint64_t, eudaq::EventSPC>> qu_in;
+    std::map<uint64_t, std::pair<eudaq::EventSPC, std::shared_ptr<void>>> done;
+    uint64_t n_read = 0, n_written = 0;
+    bool eof = false;
+    bool abort = false;
+    std::exception_ptr err;
+    std::vector<StageStat> stats(3);
+    stats[0].name = "read";
+    stats[1].name = "convert";
+    stats[2].name = "write";
+
+    auto fail = [&](std::exception_ptr e){
+      std::unique_lock<std::mutex> lk(mx);
+      if(!err)
+	err = e;
+      abort = true;
+      cv_read.notify_all();
+      cv_work.notify_all();
+      cv_write.notify_all();
+    };
+
+    std::thread th_read([&](){
+	try{
+	  while(true){
+	    {
+	      std::unique_lock<std::mutex> lk(mx);
+	      cv_read.wait(lk, [&]{return abort || n_read - n_written < max_inflight;});
+	      if(abort)
+		return;
+	    }
+	    auto t0 = Clock::now();
+	    auto ev = reader.GetNextEvent();
+	    if(ev && print_ev_in)
+	      ev->Print(std::cout);
+	    std::unique_lock<std::mutex> lk(mx);
+	    stats[0].busy_s += Seconds(Clock::now() - t0);
+	    if(!ev){
+	      eof = true;
+	      cv_work.notify_all();
+	      cv_write.notify_all();
+	      return;
+	    }
+	    stats[0].n_ev ++;
+	    qu_in.emplace_back(n_read++, ev);
+	    cv_work.notify_one();
+	  }
+	}
+	catch(...){
+	  fail(std::current_exception());
+	}
+      });
+
+    std::vector<std::thread> th_work;
+    for(uint32_t i = 0; i < n_worker; i++){
+      th_work.emplace_back([&](){
+	  try{
+	    while(true){
+	      std::unique_lock<std::mutex> lk(mx);
+	      cv_work.wait(lk, [&]{return abort || eof || !qu_in.empty();});
+	      if(abort || qu_in.empty())
+		return;
+	      auto item = qu_in.front();
+	      qu_in.pop_front();
+	      lk.unlock();
+	      auto t0 = Clock::now();
+	      std::shared_ptr<void> prepared;
+	      if(writer)
+		prepared = writer->PrepareEvent(item.second);
+	      auto t1 = Clock::now();
+	      lk.lock();
+	      stats[1].busy_s += Seconds(t1 - t0);
+	      stats[1].n_ev ++;
+	      done[item.first] = std::make_pair(item.second, prepared);
+	      if(item.first == n_written)
+		cv_write.notify_one();
+	    }
+	  }
+	  catch(...){
+	    fail(std::current_exception());
+	  }
+	});
+    }
+
+    try{
+      while(true){
+	std::unique_lock<std::mutex> lk(mx);
+	cv_write.wait(lk, [&]{return abort || done.count(n_written) ||
+	      (eof && n_written == n_read);});
+	if(abort || !done.count(n_written))
+	  break;
+	auto item = done[n_written];
+	done.erase(n_written);
+	lk.unlock();
+	auto t0 = Clock::now();
+	if(writer)
+	  writer->WriteEvent(item.first, item.second);
+	auto t1 = Clock::now();
+	lk.lock();
+	stats[2].busy_s += Seconds(t1 - t0);
+	stats[2].n_ev ++;
+	n_written ++;
+	cv_read.notify_one();
+      }
+    }
+    catch(...){
+      fail(std::current_exception());
+    }
+
+    th_read.join();
+    for(auto &th: th_work)
+      th.join();
+    if(err)
+      std::rethrow_exception(err);
+    return stats;
+  }
+}
 
 int main(int /*argc*/, const char **argv) {
   eudaq::OptionParser op("EUDAQ Command Line DataConverter", "2.0", "The Data Converter launcher of EUDAQ");
@@ -11,6 +173,9 @@ int main(int /*argc*/, const char **argv) {
   eudaq::Option<std::string> file_output(op, "o", "output", "", "string",
 					 "output file");
   eudaq::OptionFlag iprint(op, "ip", "iprint", "enable print of input Event");
+  eudaq::OptionFlag mmap_in(op, "m", "mmap", "read native input files through a memory mapping");
+  eudaq::Option<uint32_t> n_thread(op, "j", "jobs", 1, "uint32_t",
+				   "number of conversion threads, more than 1 enables the pipelined mode");
 
   try{
     op.Parse(argv);
@@ -18,28 +183,48 @@ int main(int /*argc*/, const char **argv) {
   catch (...) {
     return op.HandleMainException();
   }
-  
+
   std::string infile_path = file_input.Value();
   if(infile_path.empty()){
     std::cout<<"option --help to get help"<<std::endl;
     return 1;
   }
-  
+
   std::string outfile_path = file_output.Value();
   std::string type_in = infile_path.substr(infile_path.find_last_of(".")+1);
   std::string type_out = outfile_path.substr(outfile_path.find_last_of(".")+1);
   bool print_ev_in = iprint.Value();
-  
+
   if(type_in=="raw")
+    type_in = mmap_in.Value() ? "native-mmap" : "native";
+  // compressed files are decompressed chunk by chunk, not mapped
+  if(type_in=="rawz")
     type_in = "native";
   if(type_out=="raw")
     type_out = "native";
-  
+  if(type_out=="rawz")
+    type_out = "nativez";
+
   eudaq::FileReaderUP reader;
   eudaq::FileWriterUP writer;
   reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type_in), infile_path);
   if(!type_out.empty())
     writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash(type_out), outfile_path);
+
+  auto tp_start = Clock::now();
+  if(n_thread.Value() > 1){
+    std::vector<StageStat> stats;
+    try{
+      stats = ConvertParallel(*reader, writer.get(), print_ev_in, n_thread.Value());
+    }
+    catch(const std::exception &e){
+      std::cerr<<"euCliConverter: "<<e.what()<<std::endl;
+      return 1;
+    }
+    PrintStats(stats, Seconds(Clock::now() - tp_start), n_thread.Value());
+    return 0;
+  }
+
   while(1){
     auto ev = reader->GetNextEvent();
     if(!ev)
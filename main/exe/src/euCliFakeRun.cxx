@@ -0,0 +1,107 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/RunControl.hh"
+#include "eudaq/Producer.hh"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+// Producer doing nothing but sleeping for FAKE_CONFIGURE_MS while configured
+class FakeProducer : public eudaq::Producer {
+public:
+  FakeProducer(const std::string &name, const std::string &runcontrol)
+    :eudaq::Producer(name, runcontrol){}
+  void DoConfigure() override {
+    uint32_t ms = GetConfiguration()->Get("FAKE_CONFIGURE_MS", 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+};
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line FakeRun", "2.0",
+			 "Initialises and configures fake producers in a single process to time the RunControl");
+  eudaq::Option<uint32_t> n_pd(op, "n", "producers", 8, "uint32_t",
+			       "Number of fake producers");
+  eudaq::Option<uint32_t> delay(op, "d", "delay", 500, "ms",
+				"Configure delay of the slowest producer, the i-th one takes (i+1)/n of it");
+  eudaq::Option<uint32_t> n_group(op, "g", "groups", 1, "uint32_t",
+				  "Number of ordering groups, the i-th producer is in group i%g");
+  eudaq::Option<std::string> listen(op, "a", "listen-port", "tcp://0", "address",
+				    "The port the run control will listen on, 0 for any free one");
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    std::ostringstream err;
+    return op.HandleMainException(err);
+  }
+  uint32_t n = std::max(n_pd.Value(), 1u);
+  uint32_t g = std::max(n_group.Value(), 1u);
+  eudaq::RunControl rc(listen.Value());
+  std::string addr = rc.GetListenAddress();
+  std::string port = addr.substr(addr.find_last_not_of("0123456789")+1);
+
+  // the port is ours while the run control listens, it keeps the files of
+  // concurrent runs apart
+  const char *tmp = std::getenv("TMPDIR");
+  if(!tmp)
+    tmp = std::getenv("TEMP");
+  std::string path = std::string(tmp ? tmp : "/tmp") + "/fake_run_" + port;
+  std::ofstream ini(path + ".ini");
+  std::ofstream conf(path + ".conf");
+  ini<<"[RunControl]\n";
+  conf<<"[RunControl]\nEUDAQ_CTRL_TIMEOUT_S = 30\n";
+  std::vector<uint32_t> group_ms(g, 0);
+  uint64_t sum_ms = 0;
+  for(uint32_t i = 0; i < n; i++){
+    uint32_t ms = delay.Value() * (i + 1) / n;
+    conf<<"[Producer.fake"<<i<<"]\nEUDAQ_CTRL_GROUP = "<<i % g<<"\nFAKE_CONFIGURE_MS = "<<ms<<"\n";
+    group_ms[i % g] = std::max(group_ms[i % g], ms);
+    sum_ms += ms;
+  }
+  ini.close();
+  conf.close();
+  uint64_t expected_ms = 0;
+  for(auto ms: group_ms)
+    expected_ms += ms;
+  rc.ReadInitilizeFile(path + ".ini");
+  rc.ReadConfigureFile(path + ".conf");
+  std::remove((path + ".ini").c_str());
+  std::remove((path + ".conf").c_str());
+  rc.StartRunControl();
+  std::vector<std::unique_ptr<FakeProducer>> pds;
+  for(uint32_t i = 0; i < n; i++){
+    pds.emplace_back(new FakeProducer("fake" + std::to_string(i), "tcp://localhost:" + port));
+    pds.back()->Connect();
+  }
+  while(rc.GetActiveConnections().size() < n)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  rc.Initialise();
+  // the second pass re-configures, the state of the producers stays CONF
+  uint64_t wall_ms[2];
+  uint32_t n_conf = 0;
+  for(int k = 0; k < 2; k++){
+    auto tp_start = std::chrono::steady_clock::now();
+    rc.Configure();
+    wall_ms[k] = std::chrono::duration_cast<std::chrono::milliseconds>
+      (std::chrono::steady_clock::now() - tp_start).count();
+    n_conf = 0;
+    for(auto &conn_st: rc.GetActiveConnectionStatusMap())
+      if(conn_st.second->GetState() == eudaq::Status::STATE_CONF)
+	n_conf ++;
+    std::cout<<n_conf<<" of "<<n<<" producers "<<(k ? "re-" : "")<<"configured in "<<wall_ms[k]<<" ms, "
+	     <<"slowest per group "<<expected_ms<<" ms, sum "<<sum_ms<<" ms"<<std::endl;
+  }
+  for(auto &pd: pds)
+    pd->Disconnect();
+  pds.clear();
+  rc.CloseRunControl();
+  // the wall time follows the slowest producers, not the sum of all, and
+  // no group is started before the previous one has finished
+  for(auto ms: wall_ms)
+    if(n_conf != n || ms < expected_ms || (n > g && ms * 2 >= expected_ms + sum_ms))
+      return -1;
+  return 0;
+}
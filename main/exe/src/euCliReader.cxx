@@ -1,5 +1,6 @@
 #include "eudaq/OptionParser.hh"
 #include "eudaq/FileReader.hh"
+#include "eudaq/FileIndex.hh"
 #include "eudaq/StdEventConverter.hh"
 
 #include <iostream>
@@ -16,15 +17,29 @@ int main(int /*argc*/, const char **argv) {
   eudaq::Option<uint32_t> timestamph(op, "TS", "timestamphigh", 0, "uint32_t", "timestamp high");
   eudaq::OptionFlag stat(op, "s", "statistics", "enable print of statistics");
   eudaq::OptionFlag stdev(op, "std", "stdevent", "enable converter of StdEvent");
+  eudaq::OptionFlag reindex(op, "x", "index", "rebuild the index file of a native input file and exit");
 
   op.Parse(argv);
   std::string infile_path = file_input.Value();
   std::string type_in = infile_path.substr(infile_path.find_last_of(".")+1);
-  if(type_in=="raw")
+  if(type_in=="raw" || type_in=="rawz")
     type_in = "native";
 
   bool stdev_v = stdev.Value();
 
+  if(reindex.Value()){
+    if(type_in != "native"){
+      std::cout<<"only native files can be indexed"<<std::endl;
+      return 1;
+    }
+    eudaq::FileIndex idx;
+    idx.Rebuild(infile_path);
+    idx.Save(eudaq::FileIndex::IndexPath(infile_path));
+    std::cout<< "Indexed "<< idx.Size() << " Events to "
+	     << eudaq::FileIndex::IndexPath(infile_path) <<std::endl;
+    return 0;
+  }
+
 
   uint32_t eventl_v = eventl.Value();
   uint32_t eventh_v = eventh.Value();
@@ -57,10 +72,22 @@ int main(int /*argc*/, const char **argv) {
   reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type_in), infile_path);
   uint32_t event_count = 0;
 
+  // jump to the begin of the requested range if the reader has an index
+  bool seeked = false;
+  if(eventl_v!=0 || eventh_v!=0)
+    seeked = reader->SeekEvent(eventl_v);
+  else if(triggerl_v!=0 || triggerh_v!=0)
+    seeked = reader->SeekTrigger(triggerl_v);
+  else if(timestampl_v!=0 || timestamph_v!=0)
+    seeked = reader->SeekTimestamp(timestampl_v);
+
   while(1){
     auto ev = reader->GetNextEvent();
     if(!ev)
       break;
+    // event numbers are increasing, nothing left to find after the range
+    if(seeked && eventh_v!=0 && ev->GetEventN() >= eventh_v)
+      break;
     bool in_range_evn = false;
     if(eventl_v!=0 || eventh_v!=0){
       uint32_t ev_n = ev->GetEventN();
@@ -104,6 +131,9 @@ int main(int /*argc*/, const char **argv) {
 
     event_count ++;
   }
-  std::cout<< "There are "<< event_count << "Events"<<std::endl;
+  if(seeked)
+    std::cout<< "Read "<< event_count << " Events from the indexed position"<<std::endl;
+  else
+    std::cout<< "There are "<< event_count << "Events"<<std::endl;
   return 0;
 }
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
+#include <string>
 #include "eudaq/Serializer.hh"
 #include "eudaq/Deserializer.hh"
 #include "eudaq/Exception.hh"
@@ -34,6 +36,29 @@ namespace eudaq {
     std::vector<unsigned char> m_data;
     size_t m_offset;
   };
+
+  /** Read-only deserializer over a reference-counted buffer.
+   * Data blocks read through ReadShared() are views into the buffer rather
+   * than copies, so the buffer lives as long as any of them.
+   */
+  class DLLEXPORT BufferDeserializer : public Deserializer {
+  public:
+    explicit BufferDeserializer(std::shared_ptr<const std::string> buf);
+    explicit BufferDeserializer(std::shared_ptr<const std::vector<uint8_t>> buf);
+    bool HasData() override { return m_offset < m_size; }
+    size_t size() const { return m_size; }
+
+  private:
+    void Deserialize(unsigned char *data, size_t len) override;
+    void PreDeserialize(unsigned char *data, size_t len) override;
+    const uint8_t *DeserializeShared(size_t len,
+				     std::shared_ptr<const void> &owner) override;
+    void CheckAvailable(size_t len) const;
+    std::shared_ptr<const void> m_owner;
+    const uint8_t *m_data;
+    size_t m_size;
+    size_t m_offset;
+  };
 }
 
 #endif // EUDAQ_INCLUDED_BufferSerializer
@@ -12,6 +12,7 @@
 #include <iosfwd>
 #include <future>
 #include <queue>
+#include <map>
 #include <mutex>
 #include <condition_variable>
 
@@ -75,8 +76,12 @@ namespace eudaq {
     std::mutex m_mx_deamon;
     std::queue<std::pair<std::string, std::string>> m_qu_cmd;
     std::condition_variable m_cv_not_empty;
+    // commands processed since connecting, by name, reported to the
+    // RunControl in the status tags _CMD_<name>
+    std::map<std::string, uint32_t> m_n_cmd;
     Status m_status;
     std::mutex m_mtx_status;
+    std::mutex m_mtx_send;
     std::shared_ptr<Configuration> m_conf;
     std::shared_ptr<Configuration> m_conf_init;
     std::string m_type;
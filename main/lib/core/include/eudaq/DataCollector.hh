@@ -9,12 +9,18 @@
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
 #include "eudaq/Factory.hh"
+#include "eudaq/LatencyHistogram.hh"
+#include "eudaq/RunBlockCache.hh"
 
 #include <string>
 #include <vector>
 #include <list>
+#include <deque>
 #include <memory>
 #include <atomic>
+#include <future>
+#include <chrono>
+#include <condition_variable>
 
 namespace eudaq {
   class DataCollector;
@@ -43,6 +49,13 @@ namespace eudaq {
     virtual void DoConnect(ConnectionSPC id);
     virtual void DoDisconnect(ConnectionSPC id);
     virtual void DoReceive(ConnectionSPC id, EventSP ev);
+    /// Called from the receiving thread when no data arrived for 100 ms,
+    /// e.g. to build what waited for a stalled producer
+    virtual void DoIdle();
+    /// Numbers the event and queues it for the writing thread, which
+    /// writes it to disk and then hands it over to the monitors.
+    /// Blocks only while the write queue is full. May be called from
+    /// any thread.
     void WriteEvent(EventSP ev);
     void SetServerAddress(const std::string &addr);
     static DataCollectorSP Make(const std::string &code_name,
@@ -59,6 +72,16 @@ namespace eudaq {
     void OnConnect(ConnectionSPC id) override final;
     void OnDisconnect(ConnectionSPC id) override final;
     void OnReceive(ConnectionSPC id, EventSP ev) override final;
+    void OnIdle() override final;
+    struct QueuedEvent {
+      EventSP ev;
+      bool monitor;
+      std::chrono::steady_clock::time_point t_queued;
+    };
+    bool AsyncWriting();
+    void StopWriting();
+    void Write(const QueuedEvent &item);
+    void Publish(const EventSP &ev);
   private:
     std::string m_data_addr;
     FileWriterSP m_writer;
@@ -67,9 +90,26 @@ namespace eudaq {
     std::string m_fwpatt;
     std::string m_fwtype;
     uint32_t m_dct_n;
-    uint32_t m_evt_c;
+    std::atomic<uint32_t> m_evt_c;
     uint32_t m_fraction;
+    size_t m_mn_qu_capacity;
+    std::string m_mn_qu_policy;
     ConfigurationSPC m_conf;
+    // write stage, fed by WriteEvent()
+    std::mutex m_mx_qu_wr;
+    std::deque<QueuedEvent> m_qu_wr;
+    std::condition_variable m_cv_wr_not_empty;
+    std::condition_variable m_cv_wr_not_full;
+    size_t m_qu_wr_capacity;
+    bool m_is_writing;
+    bool m_is_wr_alive;
+    std::future<bool> m_fut_async_wr;
+    // serializes the calls into m_writer, taken after m_mx_qu_wr
+    std::mutex m_mx_wr_file;
+    LatencyHistogram m_lat_build;
+    LatencyHistogram m_lat_write;
+    LatencyHistogram m_lat_monitor;
+    RunBlockCache m_run_blocks;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
 }
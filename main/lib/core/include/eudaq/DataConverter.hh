@@ -5,6 +5,8 @@
 #include "eudaq/Logger.hh"
 #include "eudaq/Configuration.hh"
 #include <memory>
+#include <map>
+#include <cstdint>
 
 namespace eudaq{
   template <typename T1, typename T2> class DataConverter;
@@ -23,6 +25,57 @@ namespace eudaq{
     DataConverter& operator = (const DataConverter &) = delete;
     virtual ~DataConverter(){};
     virtual bool Converting(T1SPC d1, T2SP d2, ConfigurationSPC conf) const = 0;
+    /// Called before the first conversion of a run by this instance
+    virtual void Initialise(ConfigurationSPC /*conf*/){};
+    /// Called to drop run-dependent state before the instance is initialised again
+    virtual void Reset(){};
+  };
+
+  /** Per-thread cache of the converter instances of one converter family,
+   * keyed by factory ID. An instance is made on first use and then kept, so
+   * converting does not allocate once every event type has been seen, and
+   * converters can keep their state in members instead of statics.
+   * Before an instance converts its first event of a run, Reset() (if it
+   * was used before) and Initialise() are called. The same happens when the
+   * run number or configuration changes.
+   */
+  template <typename CVT>
+  class ConverterCache{
+  public:
+    ConverterCache() = default;
+    ConverterCache(const ConverterCache &) = delete;
+    ConverterCache& operator = (const ConverterCache &) = delete;
+
+    CVT* Get(uint32_t id, uint32_t run_n, ConfigurationSPC conf){
+      auto it = m_cvts.find(id);
+      if(it == m_cvts.end()){
+	auto cvt = Factory<CVT>::MakeUnique(id);
+	if(!cvt)
+	  return nullptr;
+	it = m_cvts.emplace(id, Entry(std::move(cvt))).first;
+      }
+      Entry &e = it->second;
+      if(!e.initialised || e.run_n != run_n || e.conf != conf){
+	if(e.initialised)
+	  e.cvt->Reset();
+	e.cvt->Initialise(conf);
+	e.initialised = true;
+	e.run_n = run_n;
+	e.conf = conf;
+      }
+      return e.cvt.get();
+    }
+
+  private:
+    struct Entry{
+      explicit Entry(typename Factory<CVT>::UP &&c)
+	:cvt(std::move(c)), initialised(false), run_n(0){}
+      typename Factory<CVT>::UP cvt;
+      bool initialised;
+      uint32_t run_n;
+      ConfigurationSPC conf;
+    };
+    std::map<uint32_t, Entry> m_cvts;
   };
 }
 #endif
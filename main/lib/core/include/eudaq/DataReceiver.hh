@@ -10,6 +10,7 @@
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
 #include "eudaq/Factory.hh"
+#include "eudaq/SpscQueue.hh"
 
 #include <string>
 #include <vector>
@@ -35,9 +36,24 @@ namespace eudaq {
     virtual void OnConnect(ConnectionSPC id);
     virtual void OnDisconnect(ConnectionSPC id);
     virtual void OnReceive(ConnectionSPC id, EventSP ev);
+    /// Called by the forwarding thread after 100 ms without data
+    virtual void OnIdle();
     std::string Listen(const std::string &addr);
     void StopListen();//TODO: remove this method later
+    /// Capacity of the queue between the receiving and forwarding threads and
+    /// the policy when it is full: "block", "drop-oldest" or "drop-newest".
+    /// Takes effect at the next Listen().
+    void SetQueue(size_t capacity, const std::string &policy);
+    uint64_t GetQueueDropped() const;
+    size_t GetQueueHighWater() const;
   private:
+    enum QueuePolicy {
+      QUEUE_BLOCK,
+      QUEUE_DROP_OLDEST,
+      QUEUE_DROP_NEWEST
+    };
+    void PushQueue(std::pair<EventSP, ConnectionSPC> &&item, bool droppable);
+    void NotifyForwarder();
     void DataHandler(TransportEvent &ev);
     bool Deamon();
     bool AsyncReceiving();
@@ -55,7 +71,14 @@ namespace eudaq {
     std::future<bool> m_fut_deamon;
     std::mutex m_mx_qu_ev;
     std::mutex m_mx_deamon;
-    std::queue<std::pair<EventSP, ConnectionSPC>> m_qu_ev;
+    std::unique_ptr<SpscQueue<std::pair<EventSP, ConnectionSPC>>> m_qu_ev;
+    size_t m_qu_capacity;
+    // the policy of the running queue, latched from m_qu_policy_conf by Listen()
+    QueuePolicy m_qu_policy;
+    QueuePolicy m_qu_policy_conf;
+    std::atomic<uint64_t> m_qu_dropped;
+    std::atomic<size_t> m_qu_hwm;
+    std::atomic<bool> m_fwd_waiting;
     std::condition_variable m_cv_not_empty;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
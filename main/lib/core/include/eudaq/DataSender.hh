@@ -4,33 +4,70 @@
 
 #include "eudaq/Platform.hh"
 #include "eudaq/Event.hh"
+#include "eudaq/LatencyHistogram.hh"
 #include <string>
 #include <future>
 #include <thread>
-#include <queue>
+#include <deque>
 #include <mutex>
+#include <atomic>
+#include <exception>
 #include <condition_variable>
 
 namespace eudaq {
 
 class TransportClient;
 
+  /** Sends events to a DataReceiver.
+   * By default SendEvent() only queues the event, a dedicated thread
+   * serializes and sends it, so a slow receiver does not stall the caller
+   * until the queue is full. The event must not be modified after
+   * SendEvent(). Remaining events are sent before the destructor returns.
+   */
   class DLLEXPORT DataSender {
   public:
       DataSender(const std::string & type, const std::string & name);
       ~DataSender();
+      /// Capacity of the send queue, 0 to send synchronously, and the policy
+      /// when it is full: "block", "drop-oldest" or "drop-newest".
+      /// Must be called before Connect().
+      void SetQueue(size_t capacity, const std::string &policy);
+      /// The time from SendEvent() until the event is handed to the
+      /// transport is added to lat, which must outlive the sender.
+      /// Must be called before Connect().
+      void SetLatencyHistogram(LatencyHistogram *lat);
       void Connect(const std::string & server);
       void SendEvent(EventSPC ev);
+      size_t GetQueueDepth() const;
+      uint64_t GetQueueDropped() const;
+      uint64_t GetBytesSent() const;
   private:
+      enum QueuePolicy {
+	QUEUE_BLOCK,
+	QUEUE_DROP_OLDEST,
+	QUEUE_DROP_NEWEST
+      };
+      struct QueuedEvent {
+	EventSPC ev;
+	std::chrono::steady_clock::time_point t_queued;
+      };
       bool AsyncSending();
+      void Send(const EventSPC &ev);
       std::string m_type, m_name;
       std::unique_ptr<TransportClient> m_dataclient;
       uint64_t m_packetCounter;
       std::future<bool> m_fut_async;
-      bool m_is_connected;
-      std::mutex m_mx_qu_ev; 
-      std::queue<EventSPC> m_qu_ev;
+      std::atomic<bool> m_is_connected;
+      mutable std::mutex m_mx_qu_ev; 
+      std::deque<QueuedEvent> m_qu_ev;
       std::condition_variable m_cv_not_empty;
+      std::condition_variable m_cv_not_full;
+      size_t m_qu_capacity;
+      QueuePolicy m_qu_policy;
+      std::exception_ptr m_err;
+      std::atomic<uint64_t> m_qu_dropped;
+      std::atomic<uint64_t> m_bytes_sent;
+      LatencyHistogram *m_lat;
   };
 
 }
@@ -9,6 +9,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
 
 namespace eudaq{
   class DLLEXPORT Deserializer {
@@ -35,13 +38,20 @@ namespace eudaq{
     void read(unsigned char *dst, size_t size);
     void PreRead(uint32_t &t);
     void PreRead(uint8_t *dst, size_t size);
+    /// Consume size bytes without copying them. Returns a pointer into the
+    /// underlying buffer and sets owner to keep it alive, or returns nullptr
+    /// (consuming nothing) if the deserializer has no shared buffer.
+    const uint8_t *ReadShared(size_t size, std::shared_ptr<const void> &owner);
   protected:
     bool m_interrupting;
 
   private:
     template <typename T> friend struct ReadHelper;
+    template <typename T> void read_elements(std::vector<T> &t, size_t len, std::false_type);
+    template <typename T> void read_elements(std::vector<T> &t, size_t len, std::true_type);
     virtual void Deserialize(unsigned char *, size_t) = 0;
     virtual void PreDeserialize(unsigned char *, size_t) = 0;
+    virtual const uint8_t *DeserializeShared(size_t, std::shared_ptr<const void> &);
   };
 
   template <typename T> struct ReadHelper {
@@ -130,12 +140,34 @@ namespace eudaq{
   template <typename T> inline void Deserializer::read(std::vector<T> &t) {
     unsigned len = 0;
     read(len);
-    t.reserve(len);
+    read_elements(t, len, std::integral_constant<bool, std::is_arithmetic<T>::value &&
+                                                  !std::is_same<T, bool>::value>());
+  }
+
+  template <typename T>
+  inline void Deserializer::read_elements(std::vector<T> &t, size_t len, std::false_type) {
+    t.reserve(t.size() + len);
     for (size_t i = 0; i < len; ++i) {
       t.push_back(read<T>());
     }
   }
 
+  // numbers are read as one contiguous block, byte-swapped on big-endian hosts
+  template <typename T>
+  inline void Deserializer::read_elements(std::vector<T> &t, size_t len, std::true_type) {
+    if (!len)
+      return;
+    size_t first = t.size();
+    t.resize(first + len);
+    unsigned char *dst = reinterpret_cast<unsigned char *>(&t[first]);
+    Deserialize(dst, len * sizeof(T));
+#if EUDAQ_BIG_ENDIAN
+    for (size_t i = 0; i < len; ++i) {
+      std::reverse(dst + i * sizeof(T), dst + (i + 1) * sizeof(T));
+    }
+#endif
+  }
+
   template <>
   inline void Deserializer::read<unsigned char>(std::vector<unsigned char> &t) {
     unsigned len = 0;
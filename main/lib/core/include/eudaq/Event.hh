@@ -4,11 +4,14 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <ostream>
+#include <utility>
 
 #include "eudaq/Serializable.hh"
 #include "eudaq/Serializer.hh"
 #include "eudaq/Deserializer.hh"
+#include "eudaq/EventBlock.hh"
 #include "eudaq/Exception.hh"
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
@@ -31,6 +34,7 @@ namespace eudaq {
   using EventUP = Factory<Event>::UP_BASE; 
   using EventSP = Factory<Event>::SP_BASE;
   using EventSPC = Factory<Event>::SPC_BASE;
+  using EventBlocksSPC = std::shared_ptr<const std::map<uint32_t, EventBlock>>;
 
   class DLLEXPORT Event : public Serializable{
   public:
@@ -49,6 +53,16 @@ namespace eudaq {
     Event(Deserializer & ds);
     virtual void Serialize(Serializer &) const;
     virtual void Print(std::ostream & os, size_t offset = 0) const;
+
+    /// Serialized form of the event, made by the first caller and shared by
+    /// all the later ones (senders, file writers, parent events). Thread-safe
+    /// as long as the event is not modified concurrently.
+    std::shared_ptr<const std::string> GetSerialized() const;
+    /// Adopts buf as the serialized form, e.g. the packet it was read from
+    void SetSerialized(std::shared_ptr<const std::string> buf);
+    /// Called by every setter; derived events call it when their own data
+    /// is changed.
+    void ClearSerialized();
     
     bool HasTag(const std::string &name) const;
     void SetTag(const std::string &name, const std::string &val);
@@ -67,6 +81,8 @@ namespace eudaq {
     void SetFlagTrigger();
     
     bool IsBORE() const;
+    /// True if the event or one of its sub-events is a BORE
+    bool HasBORE() const;
     bool IsEORE() const;
     bool IsFlagFake() const;
     bool IsFlagPacket() const;
@@ -116,29 +132,47 @@ namespace eudaq {
 
     //from RawdataEvent
     std::vector<uint8_t> GetBlock(uint32_t i) const;
+    /// Non-copying access to a data block, valid as long as the event lives
+    const EventBlock& GetBlockView(uint32_t i) const;
     size_t GetNumBlock() const;
     size_t NumBlocks() const;
     std::vector<uint32_t> GetBlockNumList() const;
+    /// Blocks constant during a run, only serialized with the BORE of their
+    /// stream (see Producer::SetRunBlock). Readers attach them to the later
+    /// events, where they are seen like the event's own blocks.
+    void SetRunBlocks(EventBlocksSPC blocks);
+    EventBlocksSPC GetRunBlocks() const;
+    /// Ids of the run blocks a BORE carries, from its EUDAQ_RUN_BLOCKS tag
+    std::vector<uint32_t> GetRunBlockNumList() const;
     
     /// Add a data block as std::vector
     template <typename T>
     size_t AddBlock(uint32_t id, const std::vector<T> &data){
+      ClearSerialized();
       m_blocks[id]=make_vector(data);
       return m_blocks.size();
     }
 
+    /// Add a data block, taking over the bytes without a copy
+    size_t AddBlock(uint32_t id, std::vector<uint8_t> &&data){
+      ClearSerialized();
+      m_blocks[id]=EventBlock(std::move(data));
+      return m_blocks.size();
+    }
+
     /// Add a data block as array with given size
     template <typename T>
     size_t AddBlock(uint32_t id, const T *data, size_t bytes){
+      ClearSerialized();
       m_blocks[id]=make_vector(data, bytes);
       return m_blocks.size();
     }
 
     template <typename T>
     void AppendBlock(size_t index, const std::vector<T> &data) {
-      auto &&src = make_vector(data);
-      auto &&dst = m_blocks[index];
-      dst.insert(dst.end(), src.begin(), src.end());
+      ClearSerialized();
+      m_blocks[index].Append(reinterpret_cast<const uint8_t *>(data.data()),
+			     data.size() * sizeof(T));
     }
 
     //TODO: remove, clearn up
@@ -152,15 +186,15 @@ namespace eudaq {
     
   private:
     template <typename T>
-      static std::vector<uint8_t> make_vector(const T *data, size_t bytes) {
+      static EventBlock make_vector(const T *data, size_t bytes) {
       const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data);
-      return std::vector<uint8_t>(ptr, ptr + bytes);
+      return EventBlock(std::vector<uint8_t>(ptr, ptr + bytes));
     }
 
     template <typename T>
-    static std::vector<uint8_t> make_vector(const std::vector<T> &data) {
-      const uint8_t *ptr = reinterpret_cast<const uint8_t *>(&data[0]);
-      return std::vector<uint8_t>(ptr, ptr + data.size() * sizeof(T));
+    static EventBlock make_vector(const std::vector<T> &data) {
+      const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data.data());
+      return EventBlock(std::vector<uint8_t>(ptr, ptr + data.size() * sizeof(T)));
     }
     
   private:
@@ -176,8 +210,10 @@ namespace eudaq {
     uint64_t m_ts_end;
     std::string m_dspt;
     std::map<std::string, std::string> m_tags;
-    std::map<uint32_t, std::vector<uint8_t>> m_blocks;
+    std::map<uint32_t, EventBlock> m_blocks;
     std::vector<EventSPC> m_sub_events;
+    mutable std::shared_ptr<const std::string> m_ser_cache;
+    EventBlocksSPC m_run_blocks;
   };
 }
 
@@ -0,0 +1,49 @@
+#ifndef EUDAQ_INCLUDED_EventBlock
+#define EUDAQ_INCLUDED_EventBlock
+
+#include "eudaq/Serializable.hh"
+#include "eudaq/Deserializer.hh"
+#include "eudaq/Platform.hh"
+
+#include <vector>
+#include <memory>
+
+namespace eudaq {
+  class Serializer;
+
+  /** A data block of an Event.
+   * The bytes are either owned by the block itself or are a view into a
+   * reference-counted buffer (e.g. the packet an event was received in),
+   * which is kept alive as long as any block refers to it.
+   */
+  class DLLEXPORT EventBlock : public Serializable {
+  public:
+    EventBlock();
+    explicit EventBlock(std::vector<uint8_t> &&data);
+    EventBlock(std::shared_ptr<const void> buffer, const uint8_t *data, size_t size);
+    EventBlock(Deserializer &ds);
+    void Serialize(Serializer &ser) const override;
+
+    const uint8_t *data() const {return m_buffer ? m_view : m_owned.data();}
+    size_t size() const {return m_buffer ? m_view_size : m_owned.size();}
+    bool empty() const {return size() == 0;}
+    const uint8_t *begin() const {return data();}
+    const uint8_t *end() const {return data() + size();}
+    const uint8_t &operator[](size_t i) const {return data()[i];}
+    const uint8_t &front() const {return data()[0];}
+    const uint8_t &back() const {return data()[size() - 1];}
+    const uint8_t &at(size_t i) const;
+    bool IsView() const {return bool(m_buffer);}
+
+    std::vector<uint8_t> ToVector() const;
+    void Append(const uint8_t *data, size_t size);
+
+  private:
+    std::vector<uint8_t> m_owned;
+    std::shared_ptr<const void> m_buffer;
+    const uint8_t *m_view;
+    size_t m_view_size;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_EventBlock
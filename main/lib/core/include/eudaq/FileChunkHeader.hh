@@ -0,0 +1,66 @@
+#ifndef EUDAQ_INCLUDED_FileChunkHeader
+#define EUDAQ_INCLUDED_FileChunkHeader
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace eudaq {
+
+  /** Header of a chunk of the compressed native format (.rawz).
+   * The file is a sequence of chunks, each one holding a compressed piece
+   * of the stream of serialized events that makes an uncompressed .raw
+   * file. Events may span chunks. start is the offset of the chunk in the
+   * uncompressed stream, which is also the offset used by the index file.
+   * A CODEC_STORE chunk holds its piece uncompressed, e.g. if it failed to
+   * compress.
+   */
+  struct FileChunkHeader {
+    static const size_t SIZE = 24;
+    static const uint32_t CODEC_STORE = 0;
+    static const uint32_t CODEC_ZLIB = 1;
+
+    uint32_t codec;
+    uint64_t start;
+    uint32_t raw_size;
+    uint32_t comp_size;
+
+    /// True if the file data begin with a chunk
+    static bool IsChunk(const uint8_t *data){
+      return std::memcmp(data, MAGIC(), 4) == 0;
+    }
+
+    void Encode(uint8_t *out) const {
+      std::memcpy(out, MAGIC(), 4);
+      EncodeInt(out + 4, codec, 4);
+      EncodeInt(out + 8, start, 8);
+      EncodeInt(out + 16, raw_size, 4);
+      EncodeInt(out + 20, comp_size, 4);
+    }
+
+    bool Decode(const uint8_t *in){
+      if(!IsChunk(in))
+	return false;
+      codec = uint32_t(DecodeInt(in + 4, 4));
+      start = DecodeInt(in + 8, 8);
+      raw_size = uint32_t(DecodeInt(in + 16, 4));
+      comp_size = uint32_t(DecodeInt(in + 20, 4));
+      return true;
+    }
+
+  private:
+    static const char *MAGIC(){return "EUZC";}
+    static void EncodeInt(uint8_t *out, uint64_t v, size_t n){
+      for(size_t i = 0; i < n; i++, v >>= 8)
+	out[i] = uint8_t(v & 0xff);
+    }
+    static uint64_t DecodeInt(const uint8_t *in, size_t n){
+      uint64_t v = 0;
+      for(size_t i = n; i > 0; i--)
+	v = (v << 8) | in[i-1];
+      return v;
+    }
+  };
+}
+
+#endif // EUDAQ_INCLUDED_FileChunkHeader
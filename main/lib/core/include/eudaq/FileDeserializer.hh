@@ -10,6 +10,12 @@
 #include <cstdio>
 
 namespace eudaq{
+  /** Deserializer reading from a file.
+   * A compressed file (see FileChunkHeader) is recognised by its .rawz
+   * extension or its first bytes, which a file still being written may
+   * only get later, and is decompressed chunk by chunk; Tell() and Seek() then
+   * use offsets in the uncompressed stream, as the index file does.
+   */
   class DLLEXPORT FileDeserializer : public Deserializer {
   public:
     FileDeserializer(const std::string &fname, bool faileof = false,
@@ -17,11 +23,24 @@ namespace eudaq{
     ~FileDeserializer();
     virtual bool HasData();
     bool ReadEvent(int ver, EventSP &ev, size_t skip = 0);
+    uint64_t Tell();
+    void Seek(uint64_t offset);
     
   private:
     virtual void Deserialize(uint8_t *data, size_t len);
     virtual void PreDeserialize(uint8_t *data, size_t len);
     size_t FillBuffer(size_t min = 0);
+    void SetZip(bool zip);
+    bool DetectFormat(bool wait);
+    size_t ReadFile(uint8_t *data, size_t len, size_t min);
+    size_t FillFromChunks(uint8_t *end, size_t min);
+    bool ReadChunk(bool wait);
+    bool ScanChunk();
+    struct ChunkPos {
+      uint64_t start;
+      uint64_t file_offset;
+      uint32_t raw_size;
+    };
     size_t level() const { return m_stop - m_start; }
     std::string m_filename;
     FILE *m_file;
@@ -29,6 +48,16 @@ namespace eudaq{
     std::vector<uint8_t> m_buf;
     uint8_t *m_start;
     uint8_t *m_stop;
+    bool m_zip;
+    bool m_format_known;
+    std::vector<uint8_t> m_zin;
+    std::vector<uint8_t> m_chunk;
+    size_t m_chunk_pos;
+    uint64_t m_chunk_start;
+    uint64_t m_next_offset;
+    // chunk index, extended while reading and by scanning on Seek()
+    std::vector<ChunkPos> m_chunks;
+    uint64_t m_scan_offset;
   };
 }
 #endif // EUDAQ_INCLUDED_FileSerializer
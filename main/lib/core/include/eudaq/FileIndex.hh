@@ -0,0 +1,66 @@
+#ifndef EUDAQ_INCLUDED_FileIndex
+#define EUDAQ_INCLUDED_FileIndex
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace eudaq {
+  class Serializer;
+
+  /** Index of the events in a native data file.
+   * It is kept in a sidecar file next to the data file (data.raw ->
+   * data.raw.idx) and holds one fixed-size record per top-level event: the
+   * file offset, event number, trigger number, timestamp range and flags,
+   * FLAG_BORE if the event or one of its sub-events is a BORE. Indexes of
+   * version 1 have no flags, see HasFlags().
+   */
+  class DLLEXPORT FileIndex {
+  public:
+    struct Entry {
+      uint64_t offset;
+      uint32_t ev_n;
+      uint32_t tg_n;
+      uint64_t ts_begin;
+      uint64_t ts_end;
+      uint32_t flags;
+    };
+    static const uint32_t FLAG_BORE = 0x1;
+
+    static std::string IndexPath(const std::string &datafile);
+    static void WriteHeader(Serializer &ser);
+    static void WriteEntry(Serializer &ser, const Entry &e);
+    static Entry MakeEntry(uint64_t offset, const Event &ev);
+
+    bool Load(const std::string &idxfile);
+    void Save(const std::string &idxfile) const;
+    void Rebuild(const std::string &datafile);
+    size_t Size() const {return m_entries.size();}
+    bool HasFlags() const {return m_has_flags;}
+    const Entry &At(size_t i) const {return m_entries.at(i);}
+
+    /// Position of the first entry at or after the given number/time,
+    /// or Size() if there is none. Binary searches.
+    size_t FindEvent(uint32_t ev_n) const;
+    size_t FindTrigger(uint32_t tg_n) const;
+    size_t FindTimestamp(uint64_t ts) const;
+    /// Position of the first BORE entry at or after pos, or Size()
+    size_t NextBore(size_t pos) const;
+
+  private:
+    using Lookup = std::vector<std::pair<uint64_t, size_t>>;
+    void BuildLookups();
+    std::vector<Entry> m_entries;
+    bool m_has_flags = true;
+    // (key, first position of the entries with this key or a larger one),
+    // sorted by key. Empty if the keys are in file order already.
+    Lookup m_lu_ev;
+    Lookup m_lu_tg;
+    Lookup m_lu_ts;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_FileIndex
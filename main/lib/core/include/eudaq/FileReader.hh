@@ -30,6 +30,12 @@ namespace eudaq{
     void SetConfiguration(ConfigurationSPC c) {m_conf = c;};
     ConfigurationSPC GetConfiguration() const {return m_conf;};
     virtual EventSPC GetNextEvent() {return nullptr;};
+    /// Position the reader so that GetNextEvent() returns the first event at
+    /// or after the given event/trigger number or timestamp. Readers without
+    /// random access return false and stay where they are.
+    virtual bool SeekEvent(uint32_t /*ev_n*/) {return false;};
+    virtual bool SeekTrigger(uint32_t /*tg_n*/) {return false;};
+    virtual bool SeekTimestamp(uint64_t /*ts*/) {return false;};
     static FileReaderSP Make(std::string type, std::string path);
   private:
     ConfigurationSPC m_conf;
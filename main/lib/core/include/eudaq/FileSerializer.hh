@@ -8,19 +8,74 @@
 #include <memory>
 #include <string>
 #include <cstdio>
+#include <future>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 namespace eudaq {
+  /** Serializer writing to a file.
+   * With a non-zero buffersize the data is collected in a user-space buffer
+   * and written in large chunks. With writebehind the full buffer is handed
+   * to a dedicated thread while the next one is filled (double buffering).
+   * Flush() writes out everything and waits until it reached the file.
+   * With a compression level (zlib, 1 fastest to 9) each buffer is written
+   * as a compressed chunk (see FileChunkHeader). The chunks are compressed
+   * in parallel by threads workers (0: up to 4, one per core) and written
+   * in order; write-behind is then always used.
+   * StreamBytes() counts the serialized bytes, the offsets of the index
+   * file, FileBytes() the bytes of the file, compressed ones once written.
+   */
   class DLLEXPORT FileSerializer : public Serializer {
   public:
-    FileSerializer(const std::string &fname, bool overwrite = false);
+    FileSerializer(const std::string &fname, bool overwrite = false,
+		   size_t buffersize = 0, bool writebehind = false,
+		   int compression = 0, unsigned threads = 0);
     virtual void Flush();
-    uint64_t FileBytes() const { return m_filebytes; }
+    uint64_t StreamBytes() const { return m_filebytes; }
+    uint64_t FileBytes() const {
+      return m_compression ? m_zbytes.load() : m_filebytes;
+    }
+    size_t BufferedBytes() const { return m_buf.size(); }
     ~FileSerializer();
 
   private:
+    struct Job {
+      std::vector<uint8_t> buf;
+      uint64_t start;
+      std::vector<uint8_t> zbuf;
+      bool taken;
+      bool done;
+    };
     virtual void Serialize(const uint8_t *data, size_t len);
+    void WriteFile(const uint8_t *data, size_t len);
+    void Compress(Job &job);
+    void WriteOut(Job &job);
+    void WriteBuffer();
+    void WaitWriting(std::unique_lock<std::mutex> &lk, size_t n_left);
+    bool AsyncWriting();
     FILE *m_file;
     uint64_t m_filebytes;
+    std::atomic<uint64_t> m_zbytes;
+    size_t m_bufsize;
+    bool m_writebehind;
+    std::vector<uint8_t> m_buf;
+    int m_compression;
+    // buffers handed to the writing threads, in file order; the front one
+    // is written as soon as it is done, by one thread at a time
+    std::deque<Job> m_jobs;
+    std::vector<std::vector<uint8_t>> m_spare;
+    size_t m_max_jobs;
+    bool m_is_writing;
+    bool m_is_stopping;
+    // set by the writing thread once a write failed, nothing is appended
+    // after it so that the file has no gap
+    bool m_write_failed;
+    std::string m_err;
+    std::mutex m_mx_buf;
+    std::condition_variable m_cv_buf;
+    std::vector<std::future<bool>> m_fut_async;
   };
 
 }
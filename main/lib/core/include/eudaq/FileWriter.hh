@@ -34,6 +34,16 @@ namespace eudaq {
     void SetConfiguration(ConfigurationSPC c) {m_conf = c;};
     ConfigurationSPC GetConfiguration() const {return m_conf;};
     virtual void WriteEvent(EventSPC ) {};
+    /// Optional thread-safe part of writing an event which does not touch
+    /// the file (e.g. the conversion to the output format). It may run
+    /// concurrently for several events, its result is then handed to
+    /// WriteEvent(ev, prepared) in the original event order.
+    virtual std::shared_ptr<void> PrepareEvent(EventSPC ) const {return nullptr;};
+    virtual void WriteEvent(EventSPC ev, std::shared_ptr<void> ) {WriteEvent(ev);};
+    virtual void Flush() {};
+    /// Called regularly while no events arrive, flushes what the flush
+    /// policy of the writer wants on disk by now.
+    virtual void FlushIfDue() {};
     virtual uint64_t FileBytes() const {return 0;};
     static FileWriterSP Make(std::string type, std::string path);
   private:
@@ -0,0 +1,35 @@
+#ifndef EUDAQ_INCLUDED_LatencyHistogram
+#define EUDAQ_INCLUDED_LatencyHistogram
+
+#include "eudaq/Platform.hh"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+namespace eudaq {
+
+  /** Histogram of latencies in power-of-two buckets of microseconds.
+   * Add() may be called from any thread without locking, the readers see
+   * a consistent enough picture for monitoring.
+   */
+  class DLLEXPORT LatencyHistogram {
+  public:
+    LatencyHistogram();
+    void Add(std::chrono::steady_clock::duration d);
+    void Reset();
+    uint64_t GetCount() const;
+    /// Upper bound in microseconds of the bucket holding the q quantile
+    uint64_t GetQuantile(double q) const;
+    /// e.g. "n=1200 p50<16us p90<64us p99<256us max<1024us"
+    std::string ToString() const;
+
+  private:
+    // bucket i holds the latencies below 2^i microseconds
+    static const int N_BUCKETS = 32;
+    std::atomic<uint64_t> m_buckets[N_BUCKETS];
+  };
+}
+
+#endif // EUDAQ_INCLUDED_LatencyHistogram
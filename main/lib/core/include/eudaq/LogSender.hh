@@ -4,13 +4,25 @@
 #include "eudaq/TransportClient.hh"
 #include "eudaq/Serializer.hh"
 #include "eudaq/Status.hh"
+#include "eudaq/LogMessage.hh"
 #include "Platform.hh"
 #include <string>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 
 namespace eudaq {
 
-  class LogMessage;
-
+  /** Prints log messages and forwards them to the LogCollector.
+   * Messages go to the LogCollector from a separate thread through a
+   * bounded queue, so logging never waits for the log socket. Immediate
+   * repetitions of a message are collapsed into one "repeated" message and
+   * messages below WARN can be rate limited. Both levels default to INFO;
+   * THROW and OK messages are filtered like WARN, so they stay visible.
+   */
   class DLLEXPORT LogSender {
   public:
     LogSender();
@@ -21,7 +33,7 @@ namespace eudaq {
     void SendLogMessage(const LogMessage &);
     void SendLogMessage(const LogMessage &msg, std::ostream &out,
                         std::ostream &error_out);
-    void SetLevel(int level) { m_level = level; }
+    void SetLevel(int level) { m_level = level; UpdateMinLevel(); }
     void SetLevel(const std::string &level) {
       SetLevel(Status::String2Level(level));
     }
@@ -29,18 +41,66 @@ namespace eudaq {
     void SetErrLevel(const std::string &level) {
       SetErrLevel(Status::String2Level(level));
     }
+    /// Lowest level sent to the LogCollector
+    void SetNetLevel(int level) { m_netlevel = level; UpdateMinLevel(); }
+    void SetNetLevel(const std::string &level) {
+      SetNetLevel(Status::String2Level(level));
+    }
+    /// Messages below WARN per second and burst allowance, 0 for no limit (default)
+    void SetRateLimit(uint32_t per_sec, uint32_t burst);
+    /// Reports pending repetitions and rate limited messages now
+    void Flush();
     bool IsLogged(const std::string &level) {
-      return Status::String2Level(level) >= m_level;
+      return Rank(Status::String2Level(level)) >= m_level;
+    }
+    /// True if the console or the LogCollector wants messages of this level
+    bool IsLogged(int level) const {
+      return Rank(level) >= m_minlevel.load(std::memory_order_relaxed);
     }
 
   private:
+    static int Rank(int level) {
+      return (level == Status::LVL_THROW || level == Status::LVL_OK) ?
+	Status::LVL_WARN : level;
+    }
+    void UpdateMinLevel();
+    bool Admit(const LogMessage &msg, std::ostream &out, std::ostream &error_out);
+    void Emit(const LogMessage &msg, std::ostream &out, std::ostream &error_out);
+    void FlushRepeat(std::ostream &out, std::ostream &error_out);
+    void FlushPending(std::ostream &out, std::ostream &error_out);
+    void AsyncSending();
+    void StopSending();
     std::string m_name;
     TransportClient *m_logclient;
     int m_level;
     int m_errlevel;
+    int m_netlevel;
+    std::atomic<int> m_minlevel;
     bool m_shownotconnected;
     bool isConnected = false;
     std::recursive_mutex m_mutex;
+
+    // deduplication of immediately repeated messages
+    std::string m_last_key;
+    int m_last_level;
+    uint32_t m_last_repeat;
+    std::chrono::steady_clock::time_point m_tp_last;
+    // token bucket for messages below WARN
+    uint32_t m_rate;
+    uint32_t m_burst;
+    double m_tokens;
+    uint64_t m_rate_dropped;
+    std::chrono::steady_clock::time_point m_tp_tokens;
+    std::chrono::steady_clock::time_point m_tp_rate_report;
+
+    // queue towards the LogCollector
+    std::thread m_th_send;
+    std::mutex m_mx_qu;
+    std::condition_variable m_cv_qu;
+    std::deque<LogMessage> m_qu;
+    bool m_stop_send;
+    bool m_send_failed;
+    uint64_t m_qu_dropped;
   };
 }
 
@@ -15,10 +15,15 @@ namespace eudaq {
 #define EUDAQ_LOG_CONNECT(type, name, server)                                  \
   ::eudaq::GetLogger().Connect(type, name, server)
 
+#define EUDAQ_LOG_NET_LEVEL(level) ::eudaq::GetLogger().SetNetLevel(level)
+
+// The message is only built if the console or the LogCollector wants the level
 #define EUDAQ_LOG(level, msg)                                                  \
-  ::eudaq::GetLogger().SendLogMessage(                                         \
-      ::eudaq::LogMessage(msg, ::eudaq::LogMessage::LVL_##level)               \
-          .SetLocation(__FILE__, __LINE__, EUDAQ_FUNC))
+  (::eudaq::GetLogger().IsLogged(::eudaq::LogMessage::LVL_##level)             \
+   ? ::eudaq::GetLogger().SendLogMessage(                                      \
+       ::eudaq::LogMessage(msg, ::eudaq::LogMessage::LVL_##level)              \
+           .SetLocation(__FILE__, __LINE__, EUDAQ_FUNC))                       \
+   : (void)0)
 #define EUDAQ_DEBUG(msg) EUDAQ_LOG(DEBUG, msg)
 #define EUDAQ_EXTRA(msg) EUDAQ_LOG(EXTRA, msg)
 #define EUDAQ_INFO(msg) EUDAQ_LOG(INFO, msg)
@@ -27,10 +32,12 @@ namespace eudaq {
 #define EUDAQ_USER(msg) EUDAQ_LOG(USER, msg)
 
 #define EUDAQ_LOG_STREAMOUT(level, msg, outStream, error_stream)               \
-  ::eudaq::GetLogger().SendLogMessage(                                         \
-      ::eudaq::LogMessage(msg, ::eudaq::LogMessage::LVL_##level)               \
-          .SetLocation(__FILE__, __LINE__, EUDAQ_FUNC),                        \
-      outStream, error_stream)
+  (::eudaq::GetLogger().IsLogged(::eudaq::LogMessage::LVL_##level)             \
+   ? ::eudaq::GetLogger().SendLogMessage(                                      \
+       ::eudaq::LogMessage(msg, ::eudaq::LogMessage::LVL_##level)              \
+           .SetLocation(__FILE__, __LINE__, EUDAQ_FUNC),                       \
+       outStream, error_stream)                                                \
+   : (void)0)
 #define EUDAQ_DEBUG_STREAMOUT(msg, outStream, error_stream)  EUDAQ_LOG_STREAMOUT(DEBUG, msg, outStream, error_stream)
 #define EUDAQ_EXTRA_STREAMOUT(msg, outStream, error_stream)  EUDAQ_LOG_STREAMOUT(EXTRA, msg, outStream, error_stream)
 #define EUDAQ_INFO_STREAMOUT(msg, outStream, error_stream)   EUDAQ_LOG_STREAMOUT(INFO, msg, outStream, error_stream)
@@ -0,0 +1,42 @@
+#ifndef EUDAQ_INCLUDED_MmapFileDeserializer
+#define EUDAQ_INCLUDED_MmapFileDeserializer
+
+#include "eudaq/Deserializer.hh"
+#include "eudaq/Platform.hh"
+#include <memory>
+#include <string>
+
+namespace eudaq{
+  /** Deserializer reading from a memory-mapped file.
+   * Data is copied straight out of the mapping, and data blocks are handed
+   * out as views into it (see Deserializer::ReadShared). A file that grows
+   * while being read is remapped from the current position on, so it can
+   * follow a run being written. Only available on POSIX systems.
+   */
+  class DLLEXPORT MmapFileDeserializer : public Deserializer {
+  public:
+    MmapFileDeserializer(const std::string &fname, bool faileof = false);
+    ~MmapFileDeserializer() override;
+    bool HasData() override;
+    uint64_t Tell() const { return m_offset; }
+    void Seek(uint64_t offset);
+
+  private:
+    struct Mapping;
+    void Deserialize(uint8_t *data, size_t len) override;
+    void PreDeserialize(uint8_t *data, size_t len) override;
+    const uint8_t *DeserializeShared(size_t len,
+				     std::shared_ptr<const void> &owner) override;
+    bool Remap();
+    bool Covers(uint64_t offset, size_t len) const;
+    const uint8_t *Address(uint64_t offset) const;
+    void Require(size_t len);
+    std::string m_filename;
+    int m_fd;
+    bool m_faileof;
+    std::shared_ptr<const Mapping> m_map;
+    uint64_t m_offset;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_MmapFileDeserializer
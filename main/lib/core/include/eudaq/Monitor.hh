@@ -8,6 +8,7 @@
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
 #include "eudaq/Factory.hh"
+#include "eudaq/RunBlockCache.hh"
 
 #include <string>
 #include <vector>
@@ -55,6 +56,7 @@ namespace eudaq {
   private:
     std::string m_data_addr;
     uint32_t m_evt_c;
+    RunBlockCache m_run_blocks;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
 }
@@ -41,4 +41,12 @@ using std::size_t;
 
 #include <memory>
 
+// The serialization format is little-endian; on hosts with the same byte
+// order arrays of numbers can be copied to and from buffers as a whole.
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define EUDAQ_BIG_ENDIAN 1
+#else
+#define EUDAQ_BIG_ENDIAN 0
+#endif
+
 #endif // EUDAQ_INCLUDED_Platform
@@ -10,6 +10,7 @@
 #include "eudaq/Utils.hh"
 
 #include <string>
+#include <chrono>
 
 namespace eudaq {
   class Producer;
@@ -42,6 +43,12 @@ namespace eudaq {
     virtual void DoStatus(){};
     
     void SendEvent(EventSP ev);
+    /// Sends evs in a single packet, the DataCollectors receive them one by one
+    void SendEvents(const std::vector<EventSP> &evs);
+    /// Sets a block which is constant during a run. It is only sent with the
+    /// BORE, the receivers attach it to the later events (Event::GetRunBlocks).
+    /// The blocks are cleared on configure and reset, set them in DoConfigure or DoStartRun.
+    void SetRunBlock(uint32_t id, const std::vector<uint8_t> &data);
     static ProducerSP Make(const std::string &code_name, const std::string &run_name,
 			   const std::string &runcontrol);
 
@@ -53,6 +60,8 @@ namespace eudaq {
     void OnReset() override final;
     void OnTerminate() override final;
     void OnStatus() override;
+    void StampEvent(EventSP ev);
+    void DispatchEvent(EventSP ev);
   
   protected:
     uint32_t m_evt_c;
@@ -60,6 +69,9 @@ namespace eudaq {
     uint32_t m_pdc_n;
     std::mutex m_mtx_sender;
     std::map<std::string, std::shared_ptr<DataSender>> m_senders;
+    std::map<uint32_t, std::vector<uint8_t>> m_run_blocks;
+    uint64_t m_send_bytes_last;
+    std::chrono::steady_clock::time_point m_tp_send_last;
   };
   //----------DOC-MARK-----ENDDECLEAR-----DOC-MARK----------
 }
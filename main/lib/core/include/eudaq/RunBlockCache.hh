@@ -0,0 +1,30 @@
+#ifndef EUDAQ_INCLUDED_RunBlockCache
+#define EUDAQ_INCLUDED_RunBlockCache
+
+#include "eudaq/Event.hh"
+#include "eudaq/Platform.hh"
+
+#include <map>
+#include <utility>
+#include <cstdint>
+
+namespace eudaq {
+
+  /** Remembers the run-constant blocks of the BORE of each stream and
+   * attaches them to the later events of that stream, see
+   * Producer::SetRunBlock. Used where events come in in order: the
+   * DataCollector, the Monitor and the file reader.
+   */
+  class DLLEXPORT RunBlockCache {
+  public:
+    /// Also processes the sub-events. ev must not be shared yet.
+    void Process(EventSP ev);
+    void Clear();
+    bool Empty() const {return m_blocks.empty();}
+  private:
+    // stream number and description hash of the events
+    std::map<std::pair<uint32_t, uint32_t>, EventBlocksSPC> m_blocks;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_RunBlockCache
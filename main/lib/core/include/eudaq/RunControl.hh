@@ -12,6 +12,9 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
 
 namespace eudaq {
 
@@ -61,6 +64,7 @@ namespace eudaq {
     void StartRunControl(); 
     void CloseRunControl();
     bool IsActiveRunControl() const {return m_thd_server.joinable();}
+    std::string GetListenAddress() const;
     virtual void Exec();
     
     void SetRunN(uint32_t n){m_run_n = n;};
@@ -75,6 +79,14 @@ namespace eudaq {
     void SendCommand(const std::string &cmd,
 		     const std::string &param = "",
                      ConnectionSPC id = ConnectionSPC());
+    std::vector<std::string> SendCommandAndWait(const std::string &cmd, const std::string &param,
+						const std::vector<ConnectionSPC> &conns,
+						const std::function<bool(int)> &reached,
+						std::chrono::steady_clock::duration timeout);
+    std::vector<std::string> SendCommandInGroups(const std::string &cmd, const std::string &param,
+						 const std::vector<ConnectionSPC> &conns,
+						 const std::function<bool(int)> &reached,
+						 const Configuration &conf);
     void CommandHandler(TransportEvent &ev);
     void CommandThread();
     void StatusThread();
@@ -87,7 +99,10 @@ namespace eudaq {
     std::shared_ptr<Configuration> m_conf;
     std::shared_ptr<Configuration> m_conf_init;
     std::map<ConnectionSPC, StatusSPC> m_conn_status;
+    // commands sent to each connection, by name
+    std::map<ConnectionSPC, std::map<std::string, uint32_t>> m_n_sent;
     std::mutex m_mtx_conn;
+    std::condition_variable m_cv_status;
 
     std::string m_addr_log;
     std::mutex m_mtx_sendcmd;
@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <type_traits>
 
 namespace eudaq {
 
@@ -31,6 +32,8 @@ namespace eudaq {
     virtual uint64_t GetCheckSum();
   private:
     template <typename T> friend struct WriteHelper;
+    template <typename T> void write_elements(const std::vector<T> &t, std::false_type);
+    template <typename T> void write_elements(const std::vector<T> &t, std::true_type);
     virtual void Serialize(const uint8_t *, size_t) = 0;
   };
 
@@ -115,11 +118,36 @@ namespace eudaq {
   template <typename T> inline void Serializer::write(const std::vector<T> &t) {
     unsigned len = t.size();
     write(len);
-    for (size_t i = 0; i < len; ++i) {
+    write_elements(t, std::integral_constant<bool, std::is_arithmetic<T>::value &&
+                                          !std::is_same<T, bool>::value>());
+  }
+
+  template <typename T>
+  inline void Serializer::write_elements(const std::vector<T> &t, std::false_type) {
+    for (size_t i = 0; i < t.size(); ++i) {
       write(t[i]);
     }
   }
 
+  // numbers are written as one contiguous block, byte-swapped on big-endian hosts
+  template <typename T>
+  inline void Serializer::write_elements(const std::vector<T> &t, std::true_type) {
+    if (t.empty())
+      return;
+#if EUDAQ_BIG_ENDIAN
+    std::vector<uint8_t> buf(t.size() * sizeof(T));
+    const uint8_t *src = reinterpret_cast<const uint8_t *>(t.data());
+    for (size_t i = 0; i < t.size(); ++i) {
+      for (size_t b = 0; b < sizeof(T); ++b) {
+        buf[i * sizeof(T) + b] = src[i * sizeof(T) + sizeof(T) - 1 - b];
+      }
+    }
+    Serialize(buf.data(), buf.size());
+#else
+    Serialize(reinterpret_cast<const uint8_t *>(t.data()), t.size() * sizeof(T));
+#endif
+  }
+
   template <>
   inline void
   Serializer::write<uint8_t>(const std::vector<uint8_t> &t) {
@@ -0,0 +1,108 @@
+#ifndef EUDAQ_INCLUDED_SpscQueue
+#define EUDAQ_INCLUDED_SpscQueue
+
+#include <vector>
+#include <atomic>
+#include <utility>
+#include <cstddef>
+
+namespace eudaq {
+
+  /** Bounded lock-free queue for one producer and one consumer thread.
+   * TryPush() and TryDropFront() may only be called from the producer
+   * thread, TryPop() only from the consumer thread. None of them blocks:
+   * they fail if the queue is full or empty, and the caller decides how to
+   * wait or what to drop.
+   * Each slot carries the position it is valid for, so that the producer
+   * can discard the oldest entry while the consumer is popping.
+   */
+  template <typename T> class SpscQueue {
+  public:
+    explicit SpscQueue(size_t capacity)
+      : m_slots(capacity ? capacity : 1), m_head(0), m_tail(0) {
+      for (size_t i = 0; i < m_slots.size(); i++)
+        m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /// droppable marks the entries TryDropFront() may discard
+    bool TryPush(T &&v, bool droppable = true) {
+      size_t head = m_head.load(std::memory_order_relaxed);
+      Slot &slot = m_slots[head % m_slots.size()];
+      if (slot.seq.load(std::memory_order_acquire) != head)
+        return false;
+      slot.value = std::move(v);
+      slot.droppable = droppable;
+      slot.seq.store(head + 1, std::memory_order_release);
+      m_head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool TryPop(T &v) {
+      size_t tail;
+      Slot *slot = Claim(false, tail);
+      if (!slot)
+        return false;
+      v = std::move(slot->value);
+      Release(*slot, tail);
+      return true;
+    }
+
+    /// Discards the oldest entry if it is droppable
+    bool TryDropFront() {
+      size_t tail;
+      Slot *slot = Claim(true, tail);
+      if (!slot)
+        return false;
+      Release(*slot, tail);
+      return true;
+    }
+
+    size_t Size() const {
+      size_t tail = m_tail.load(std::memory_order_acquire);
+      size_t head = m_head.load(std::memory_order_acquire);
+      return head > tail ? head - tail : 0;
+    }
+    bool Empty() const { return Size() == 0; }
+    size_t Capacity() const { return m_slots.size(); }
+
+  private:
+    struct Slot {
+      std::atomic<size_t> seq;
+      // written and read by the producer only
+      bool droppable = false;
+      T value;
+    };
+
+    Slot *Claim(bool only_droppable, size_t &tail) {
+      tail = m_tail.load(std::memory_order_relaxed);
+      while (true) {
+        Slot &slot = m_slots[tail % m_slots.size()];
+        size_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq != tail + 1) {
+          if (seq == tail)
+            return nullptr; // empty
+          tail = m_tail.load(std::memory_order_relaxed);
+          continue;
+        }
+        if (only_droppable && !slot.droppable)
+          return nullptr;
+        if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+          return &slot;
+      }
+    }
+
+    void Release(Slot &slot, size_t tail) {
+      slot.value = T();
+      slot.seq.store(tail + m_slots.size(), std::memory_order_release);
+    }
+
+    std::vector<Slot> m_slots;
+    // head and tail on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_SpscQueue
@@ -45,13 +45,13 @@ namespace eudaq {
      * @brief Set begin time of event in picoseconds
      * @param begin Begin of events in picoseconds
      */
-    void SetTimeBegin(uint64_t begin) { time_begin = begin; };
+    void SetTimeBegin(uint64_t begin) { ClearSerialized(); time_begin = begin; };
 
     /**
      * @brief Set end time of event in picoseconds
      * @param end End of events in picoseconds
      */
-     void SetTimeEnd(uint64_t end) { time_end = end; };
+     void SetTimeEnd(uint64_t end) { ClearSerialized(); time_end = end; };
 
     static StdEventSP MakeShared();
     static const uint32_t m_id_factory = cstr2hash("StandardEvent");
@@ -9,6 +9,7 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
 
 namespace eudaq {
 
@@ -90,10 +91,10 @@ namespace eudaq {
     void SetPivot(uint32_t index, uint32_t frame, bool PivotFlag);
     // defined for short, int, double
     template <typename T> std::vector<T> GetPixels() const {
-      SetupResult();
-      std::vector<T> result(m_result_pix->size());
+      const std::vector<pixel_t> &pix = ResultPix(SetupResult());
+      std::vector<T> result(pix.size());
       for (size_t i = 0; i < result.size(); ++i) {
-	result[i] = static_cast<T>((*m_result_pix)[i] * Polarity());
+	result[i] = static_cast<T>(pix[i] * Polarity());
       }
       return result;
     }
@@ -128,9 +129,74 @@ namespace eudaq {
     void Print(std::ostream &) const;
     void Print(std::ostream &os ,size_t offset) const;
   private:
+    // Samples of one waveform in the plane's waveform pool
+    struct Waveform {
+      uint32_t offset;
+      uint32_t size;
+      double x0;
+      double dx;
+    };
+
+    // Hits of the plane as seen by the frame-less getters. A channel the
+    // result shares with frame 0 of the plane is left empty and not owned.
+    struct Result {
+      bool own_pix = false, own_hits = false; // own_hits: x, y, time, waveform
+      std::vector<pixel_t> pix;
+      std::vector<uint32_t> x, y;
+      std::vector<uint64_t> time;
+      std::vector<Waveform> waveform;
+    };
+    // Coordinates as coord_t for XVector()/YVector(): per frame and result
+    struct Coords {
+      std::vector<std::vector<coord_t>> x, y;
+      std::vector<coord_t> result_x, result_y;
+    };
+
+    // Value computed at most once per state of the plane and then shared by
+    // all readers. Const access is safe from several threads: a thread that
+    // loses the race to publish discards its copy. Reset() is only called by
+    // the (non-const) modifiers. Copies of a plane start without a value.
+    template <typename T> class OnceCache {
+    public:
+      OnceCache() : m_ptr(nullptr) {}
+      OnceCache(const OnceCache &) : m_ptr(nullptr) {}
+      OnceCache(OnceCache &&o) noexcept : m_ptr(o.m_ptr.exchange(nullptr)) {}
+      OnceCache &operator=(const OnceCache &) { Reset(); return *this; }
+      OnceCache &operator=(OnceCache &&o) noexcept {
+        delete m_ptr.exchange(o.m_ptr.exchange(nullptr));
+        return *this;
+      }
+      ~OnceCache() { Reset(); }
+      template <typename F> const T &Get(F build) const {
+        const T *p = m_ptr.load(std::memory_order_acquire);
+        if (p)
+          return *p;
+        T *n = new T(build());
+        if (m_ptr.compare_exchange_strong(p, n, std::memory_order_acq_rel))
+          return *n;
+        delete n;
+        return *p;
+      }
+      void Reset() {
+        if (m_ptr.load(std::memory_order_relaxed))
+          delete m_ptr.exchange(nullptr);
+      }
+    private:
+      mutable std::atomic<const T *> m_ptr;
+    };
+
     const std::vector<pixel_t> &
       GetFrame(const std::vector<std::vector<pixel_t>> &v, uint32_t f) const;
-    void SetupResult() const;
+    uint32_t CoordFrame(uint32_t frame) const;
+    void Invalidate();
+    const Result &SetupResult() const;
+    Result BuildResult() const;
+    Coords BuildCoords() const;
+    const std::vector<pixel_t> &ResultPix(const Result &r) const;
+    const std::vector<uint32_t> &ResultX(const Result &r) const;
+    const std::vector<uint32_t> &ResultY(const Result &r) const;
+    Waveform ResultWaveform(const Result &r, uint32_t index) const;
+    void ReadLegacy(Deserializer &ds);
 
     std::string m_type;
     std::string m_sensor;
@@ -142,28 +208,19 @@ namespace eudaq {
 
     // Timestamp of this plane in picoseconds
     uint64_t m_timestamp{};
+    // Hits are stored as structure of arrays. m_pix has one entry per frame,
+    // the per-hit channels one per frame with FLAG_DIFFCOORDS, otherwise one.
     std::vector<std::vector<pixel_t>> m_pix;
-    std::vector<std::vector<std::vector<double>>> m_waveform;
-    std::vector<std::vector<double>> m_waveform_x0;
-    std::vector<std::vector<double>> m_waveform_dx;
-    std::vector<std::vector<coord_t>> m_x, m_y;
+    std::vector<std::vector<uint32_t>> m_x, m_y;
+    // Optional channels, empty until the first non-zero timestamp or waveform
     std::vector<std::vector<uint64_t>> m_time;
+    std::vector<std::vector<Waveform>> m_waveform;
+    std::vector<double> m_waveform_pool;
     std::vector<std::vector<bool>> m_pivot;
     std::vector<uint32_t> m_mat;
 
-    mutable const std::vector<pixel_t> *m_result_pix;
-    mutable const std::vector<coord_t> *m_result_x, *m_result_y;
-    mutable const std::vector<uint64_t> *m_result_time;
-    mutable const std::vector<std::vector<double>> *m_result_waveform;
-    mutable const std::vector<double> *m_result_waveform_x0;
-    mutable const std::vector<double> *m_result_waveform_dx;
-
-    mutable std::vector<pixel_t> m_temp_pix;
-    mutable std::vector<coord_t> m_temp_x, m_temp_y;
-    mutable std::vector<uint64_t> m_temp_time;
-    mutable std::vector<std::vector<double>> m_temp_waveform;
-    mutable std::vector<double> m_temp_waveform_x0;
-    mutable std::vector<double> m_temp_waveform_dx;
+    OnceCache<Result> m_result;
+    OnceCache<Coords> m_coords;
   };
 
 } // namespace eudaq
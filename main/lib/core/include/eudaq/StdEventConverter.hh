@@ -40,6 +40,8 @@ namespace eudaq{
     StdEventConverter& operator = (const StdEventConverter&) = delete;
     bool Converting(EventSPC d1, StdEventSP d2, ConfigurationSPC conf) const override = 0;
     static bool Convert(EventSPC d1, StdEventSP d2, ConfigurationSPC conf);
+    /// The calling thread's cached converter for a factory ID, nullptr if unknown
+    static StdEventConverter* GetConverter(uint32_t id, uint32_t run_n, ConfigurationSPC conf);
   };
 
 }
@@ -0,0 +1,141 @@
+#ifndef EUDAQ_INCLUDED_TimestampEventBuilder
+#define EUDAQ_INCLUDED_TimestampEventBuilder
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <utility>
+
+namespace eudaq {
+
+  /** Builds events from several streams of timestamped events.
+   * Every stream (one per producer) is addressed by the integer id returned
+   * by AddStream(). The events of one stream must not overlap and must come
+   * in order of their begin timestamp. Each built event covers a time window
+   * and holds, in stream order, queued events overlapping it:
+   *  - with a window width of 0 (the default) the window runs from the
+   *    earliest begin to the earliest end of the first not yet built event
+   *    of every stream, and each stream adds at most one event to it, as
+   *    the timestamp data collectors always did;
+   *  - otherwise time is cut into fixed slices [n*width, (n+1)*width), the
+   *    slice holding the earliest not yet built event is built next and
+   *    every overlapping event of every stream is added to it.
+   * Windows never overlap. An event reaching into the next window is also
+   * attached to that window, unless SetShareSpanning(false) was called.
+   *
+   * A window is built once every open stream has delivered an event that
+   * ends at or after the end of the window. A stream that has not delivered
+   * anything for longer than the timeout is considered stalled and is not
+   * waited for; its events arriving later than the built windows are
+   * dropped and counted. The streams sit in a min-heap by the begin of their
+   * first not yet built event, so building costs O(log streams) per attached
+   * event instead of a scan over all streams.
+   * The class is not thread-safe.
+   */
+  class DLLEXPORT TimestampEventBuilder {
+  public:
+    using Clock = std::chrono::steady_clock;
+    struct Built {
+      uint64_t ts_begin;
+      uint64_t ts_end;
+      std::vector<EventSPC> events;
+    };
+
+    TimestampEventBuilder();
+    void SetWindow(uint64_t width);
+    void SetShareSpanning(bool share);
+    /// 0 waits for stalled streams forever
+    void SetTimeout(Clock::duration timeout);
+
+    uint32_t AddStream();
+    /// No more events will come: the stream is not waited for any more and
+    /// is removed once its queued events are built
+    void CloseStream(uint32_t id);
+    bool IsOpen(uint32_t id) const;
+    /// Drops all queued events and forgets the streams and their ids
+    void Reset();
+
+    /// The clock is only read when a timeout is set
+    void Push(uint32_t id, EventSPC ev);
+    void Push(uint32_t id, EventSPC ev, Clock::time_point now);
+    bool Pop(Built &out);
+    bool Pop(Built &out, Clock::time_point now);
+    /// Builds the queued events without waiting for any stream, e.g. at the
+    /// end of a run; the builder waits again after the next Push()
+    void Flush();
+
+    size_t GetNumQueued() const {return m_n_queued;}
+    uint64_t GetNumDropped() const {return m_n_dropped;}
+    uint32_t GetNumStalled() const;
+    uint32_t GetNumStalled(Clock::time_point now) const;
+
+  private:
+    // the timestamps are kept next to the event to spare the lookups
+    struct Queued {
+      uint64_t ts_begin;
+      uint64_t ts_end;
+      EventSPC ev;
+    };
+    struct Stream {
+      std::deque<Queued> que;
+      bool open = false;
+      bool in_watermark = false;
+      bool in_heads = false;
+      // the first queued event was built already and reaches into the
+      // next window
+      bool front_shared = false;
+      bool member = false;
+      uint64_t last_begin = 0;
+      uint64_t last_end = 0;
+      Clock::time_point last_arrival;
+    };
+    // first not yet built event of a stream
+    struct HeadEntry {
+      uint64_t ts_begin;
+      uint64_t ts_end;
+      uint32_t id;
+    };
+    // (end of the last event, stream id)
+    using MarkEntry = std::pair<uint64_t, uint32_t>;
+
+    Clock::time_point Now() const;
+    bool IsStalled(const Stream &s, Clock::time_point now) const;
+    uint64_t Watermark(Clock::time_point now);
+    void PushHead(uint32_t id, const Queued &q);
+    uint64_t MinHeadEnd();
+    void Requeue(uint32_t id);
+    void Attach(uint32_t id, uint64_t beg, uint64_t end, Built &out);
+    void AttachOne(uint32_t id, uint64_t beg, uint64_t end, Built &out);
+
+    std::vector<Stream> m_streams;
+    // min-heap of the streams with events not built yet, by the begin of
+    // the first of them; a plain vector, so MinHeadEnd() can walk it
+    std::vector<HeadEntry> m_heads;
+    // open streams not in m_heads, the only ones an event-defined window
+    // can wait for
+    uint32_t m_n_idle;
+    // earliest end in m_heads, while m_min_end_ok
+    uint64_t m_min_end;
+    bool m_min_end_ok;
+    std::vector<size_t> m_walk;
+    // streams whose first event is shared with the next window
+    std::vector<uint32_t> m_shared;
+    std::vector<uint32_t> m_members;
+    // min-heap with one entry per open stream by the end of its last event;
+    // an entry may be outdated by newer events, which only raise the end,
+    // and is refreshed or removed once it is on top
+    std::vector<MarkEntry> m_watermark;
+    uint64_t m_width;
+    bool m_share;
+    Clock::duration m_timeout;
+    bool m_flush;
+    uint64_t m_last_end;
+    size_t m_n_queued;
+    uint64_t m_n_dropped;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_TimestampEventBuilder
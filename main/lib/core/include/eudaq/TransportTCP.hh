@@ -12,6 +12,7 @@
 #endif
 #else
 #include <sys/select.h>
+#include <netinet/in.h>
 typedef int SOCKET;
 #endif
 
@@ -26,7 +27,7 @@ namespace eudaq {
     ConnectionInfoTCP(const ConnectionInfoTCP&) = delete;
     ConnectionInfoTCP& operator = (const ConnectionInfoTCP&) = delete;   
     ConnectionInfoTCP(SOCKET fd, const std::string &host = "")
-      : m_fd(fd), m_host(host), m_len(0), m_buf(""), ConnectionInfo("") {}
+      : m_fd(fd), m_host(host), m_len(0), m_buf(""), m_pos(0), ConnectionInfo("") {}
     void append(size_t length, const char *data);
     bool havepacket() const;
     std::string getpacket();
@@ -41,6 +42,7 @@ namespace eudaq {
     std::string m_host;
     size_t m_len;
     std::string m_buf;
+    size_t m_pos; // start of the unconsumed bytes in m_buf
   };
   
   class TCPServer : public TransportServer {
@@ -55,7 +57,8 @@ namespace eudaq {
     std::string ConnectionString() const override;
     std::vector<ConnectionSPC> GetConnections() const  override;
     static const std::string name;
-  private:
+  protected:
+    std::shared_ptr<ConnectionInfoTCP> AddConnection(SOCKET peersock, const sockaddr_in &addr);
     std::vector<std::shared_ptr<ConnectionInfoTCP>> m_conn;
     std::mutex m_mtx_conn;
     
@@ -64,6 +67,7 @@ namespace eudaq {
     SOCKET m_maxfd;
     fd_set m_fdset;
 
+  private:
     std::shared_ptr<ConnectionInfoTCP> GetInfo(SOCKET fd) const;
   };
 
@@ -77,13 +81,46 @@ namespace eudaq {
                             bool = false);
     virtual void ProcessEvents(int timeout = -1);
     static const std::string name;
-  private:
+  protected:
     void OpenConnection();
     std::string m_server;
     int m_port;
     SOCKET m_sock;
     std::shared_ptr<ConnectionInfoTCP> m_buf;
   };
+
+#if EUDAQ_PLATFORM_IS(LINUX)
+  /** TCP server driven by epoll instead of select().
+   * Not limited to FD_SETSIZE connections, only the ready sockets are
+   * visited and the receive buffer grows with the incoming data rate.
+   * Selected by the "epoll://" scheme; speaks the same protocol as "tcp://".
+   */
+  class EpollTCPServer : public TCPServer {
+  public:
+    EpollTCPServer(const std::string &param);
+    ~EpollTCPServer() override;
+    void Close(const ConnectionInfo &id) override;
+    void ProcessEvents(int timeout) override;
+    std::string ConnectionString() const override;
+    static const std::string name;
+  private:
+    bool Receive(const std::shared_ptr<ConnectionInfoTCP> &conn);
+    int m_epfd;
+    std::map<SOCKET, std::shared_ptr<ConnectionInfoTCP>> m_fdconn;
+    std::vector<char> m_rbuf;
+  };
+
+  class EpollTCPClient : public TCPClient {
+  public:
+    EpollTCPClient(const std::string &param);
+    ~EpollTCPClient() override;
+    void ProcessEvents(int timeout = -1) override;
+    static const std::string name;
+  private:
+    int m_epfd;
+    std::vector<char> m_rbuf;
+  };
+#endif
 }
 
 #endif // EUDAQ_INCLUDED_TransportTCP
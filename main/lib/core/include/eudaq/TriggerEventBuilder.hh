@@ -0,0 +1,129 @@
+#ifndef EUDAQ_INCLUDED_TriggerEventBuilder
+#define EUDAQ_INCLUDED_TriggerEventBuilder
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <chrono>
+
+namespace eudaq {
+
+  /** Builds events from several streams of events by their trigger number.
+   * Every stream (one per producer) is addressed by the integer id returned
+   * by AddStream(). The events waiting for the other streams sit in a ring
+   * of slots indexed by trigger number, as long as the numbers come about
+   * in order; numbers far ahead of or behind the ring are looked up in a
+   * hash map with a min-heap. The built events come out in
+   * increasing trigger number holding at most one event per stream, in
+   * stream order. A trigger number is built
+   *  - once every open stream has delivered it;
+   *  - once every open stream has delivered a trigger number more than the
+   *    reorder window beyond it, the streams lacking it skipped it;
+   *  - once it waited longer than the timeout, if one is set.
+   * The last two build partial events and count the trigger as missing for
+   * the open streams lacking it, so a skipped trigger neither blocks the
+   * builder nor shifts the pairing of the following ones. A second event of
+   * a stream with the same trigger number is dropped as duplicated, an event
+   * whose trigger number was built already is dropped as late.
+   * The class is not thread-safe.
+   */
+  class DLLEXPORT TriggerEventBuilder {
+  public:
+    using Clock = std::chrono::steady_clock;
+    struct Built {
+      uint32_t trigger_n;
+      std::vector<EventSPC> events;
+      /// stream id of each of the events
+      std::vector<uint32_t> streams;
+    };
+
+    TriggerEventBuilder();
+    /// How far beyond a trigger number a stream may have delivered before
+    /// the trigger number is taken as skipped; 0 for streams in order
+    void SetReorderWindow(uint32_t n);
+    /// 0 waits for missing events forever
+    void SetTimeout(Clock::duration timeout);
+
+    uint32_t AddStream();
+    /// No more events will come: the stream is not waited for any more
+    void CloseStream(uint32_t id);
+    bool IsOpen(uint32_t id) const {return id < m_streams.size() && m_streams[id].open;}
+    /// Drops all waiting events and forgets the streams and their ids
+    void Reset();
+
+    /// The clock is only read when a timeout is set
+    void Push(uint32_t id, EventSPC ev);
+    /// Matches by n instead of the trigger number, e.g. by the event number
+    void Push(uint32_t id, uint32_t n, EventSPC ev);
+    void Push(uint32_t id, uint32_t n, EventSPC ev, Clock::time_point now);
+    bool Pop(Built &out);
+    bool Pop(Built &out, Clock::time_point now);
+    /// Builds the waiting events without waiting for any stream, e.g. at
+    /// the end of a run; the builder waits again after the next Push()
+    void Flush();
+
+    size_t GetNumPending() const {return m_n_pending;}
+    uint64_t GetNumMissing(uint32_t id) const;
+    uint64_t GetNumDuplicated(uint32_t id) const;
+    uint64_t GetNumLate(uint32_t id) const;
+
+  private:
+    struct Stream {
+      bool open = false;
+      bool delivered = false;
+      uint32_t last_n = 0;
+      uint32_t max_n = 0;
+      uint64_t n_missing = 0;
+      uint64_t n_duplicated = 0;
+      uint64_t n_late = 0;
+    };
+    struct Pending {
+      // indexed by stream id, null pointers while the slot is not used
+      std::vector<EventSPC> events;
+      bool used = false;
+      // open streams delivered
+      uint32_t n_open = 0;
+      Clock::time_point first_arrival;
+    };
+    using MinHeap = std::priority_queue<uint32_t, std::vector<uint32_t>,
+					std::greater<uint32_t>>;
+
+    // inline, so that they are inlined in the shared library too
+    inline Clock::time_point Now() const;
+    inline Pending &GetPending(uint32_t n, Clock::time_point now);
+    void GrowRing(uint64_t n_slot);
+    inline bool IsPast(const Stream &s, uint32_t n) const;
+    inline bool IsReady(uint32_t n, const Pending &p, Clock::time_point now);
+
+    std::vector<Stream> m_streams;
+    uint32_t m_n_open;
+    // slots for the trigger numbers m_ring_base to m_ring_base+m_ring_n-1,
+    // trigger number n at n modulo the size, a power of two; the slots keep
+    // their event vectors for the next trigger numbers
+    std::vector<Pending> m_ring;
+    size_t m_ring_mask;
+    uint32_t m_ring_base;
+    uint32_t m_ring_n;
+    // the trigger numbers out of the ring
+    std::unordered_map<uint32_t, Pending> m_pending;
+    // the trigger numbers of m_pending, and of entries since moved to
+    // m_ring, which are skipped
+    MinHeap m_order;
+    size_t m_n_pending;
+    // number of open streams past m_past_n, the next trigger number to
+    // build, kept up to date by Push() and recounted when m_past_n changes
+    bool m_past_valid;
+    uint32_t m_past_n;
+    uint32_t m_n_past;
+    uint32_t m_window;
+    Clock::duration m_timeout;
+    bool m_flush;
+    bool m_has_built;
+    uint32_t m_last_built;
+  };
+}
+
+#endif // EUDAQ_INCLUDED_TriggerEventBuilder
@@ -42,4 +42,42 @@ namespace eudaq {
   }
 
 
+  BufferDeserializer::BufferDeserializer(std::shared_ptr<const std::string> buf)
+    : m_owner(buf), m_data(reinterpret_cast<const uint8_t *>(buf->data())),
+      m_size(buf->size()), m_offset(0) {}
+
+  BufferDeserializer::BufferDeserializer(std::shared_ptr<const std::vector<uint8_t>> buf)
+    : m_owner(buf), m_data(buf->data()), m_size(buf->size()), m_offset(0) {}
+
+  void BufferDeserializer::CheckAvailable(size_t len) const {
+    if (len + m_offset > m_size) {
+      EUDAQ_THROW("Deserialize asked for " + to_string(len) + ", only have " +
+                  to_string(m_size - m_offset));
+    }
+  }
+
+  void BufferDeserializer::Deserialize(unsigned char *data, size_t len) {
+    if (!len)
+      return;
+    CheckAvailable(len);
+    std::copy(m_data + m_offset, m_data + m_offset + len, data);
+    m_offset += len;
+  }
+
+  void BufferDeserializer::PreDeserialize(unsigned char *data, size_t len) {
+    if (!len)
+      return;
+    CheckAvailable(len);
+    std::copy(m_data + m_offset, m_data + m_offset + len, data);
+  }
+
+  const uint8_t *BufferDeserializer::DeserializeShared(size_t len,
+						       std::shared_ptr<const void> &owner) {
+    CheckAvailable(len);
+    const uint8_t *view = m_data + m_offset;
+    m_offset += len;
+    owner = m_owner;
+    return view;
+  }
+
 }
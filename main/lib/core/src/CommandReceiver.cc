@@ -51,6 +51,8 @@ namespace eudaq {
     std::unique_lock<std::mutex> lk_st(m_mtx_status);
     m_status.Serialize(ser);
     lk_st.unlock();
+    // called from the command thread and by SetStatus() from any thread
+    std::unique_lock<std::mutex> lk_send(m_mtx_send);
     if(m_cmdclient)
       m_cmdclient->SendPacket(ser);
   }
@@ -64,7 +66,13 @@ namespace eudaq {
       level = Status::LVL_OK;
 
     std::unique_lock<std::mutex> lk(m_mtx_status);
+    bool is_changed = m_status.GetState() != state;
     m_status.ResetStatus(state, level, info);
+    lk.unlock();
+    // a new state is pushed to the RunControl right away, not at its next
+    // status request
+    if(is_changed)
+      SendStatus();
   }
 
   void CommandReceiver::SetStatusMsg(const std::string &msg){
@@ -93,6 +101,18 @@ namespace eudaq {
     // if(!log_addr.empty())
     //   EUDAQ_LOG_CONNECT(m_type, m_name, log_addr);
     // GetInitConfiguration()->SetSection(cur_backup);
+    auto conf = GetInitConfiguration();
+    if(conf){
+      std::string lvl = conf->Get("EUDAQ_LOG_LEVEL", "");
+      if(!lvl.empty())
+	EUDAQ_LOG_LEVEL(lvl);
+      lvl = conf->Get("EUDAQ_LOG_NET_LEVEL", "");
+      if(!lvl.empty())
+	EUDAQ_LOG_NET_LEVEL(lvl);
+      int rate = conf->Get("EUDAQ_LOG_RATE_LIMIT", 0);
+      if(rate > 0)
+	GetLogger().SetRateLimit(rate, conf->Get("EUDAQ_LOG_RATE_BURST", 5 * rate));
+    }
     SetStatus(Status::STATE_UNCONF, "Initialized");
     EUDAQ_INFO(GetFullName() + " is initialised.");
   }
@@ -305,6 +325,10 @@ namespace eudaq {
       } else {
         OnUnrecognised(cmd, param);
       }
+      // tells the RunControl which command this status answers, also if
+      // the state stays the same
+      if(cmd != "STATUS")
+	SetStatusTag("_CMD_" + cmd, std::to_string(++m_n_cmd[cmd]));
       SendStatus();
     }
     return 0;
@@ -363,6 +387,7 @@ namespace eudaq {
     CHECK_FOR_REFUSE_CONNECTION(splitted_res, 0, "OK");
 
     m_addr_client = addr_client;
+    m_n_cmd.clear();
     m_cmdclient.reset(cmdclient);    
     m_is_connected = true;
     m_fut_async_rcv = std::async(std::launch::async, &CommandReceiver::AsyncReceiving, this); 
@@ -12,13 +12,21 @@ namespace eudaq {
   Factory<DataCollector>::Instance<const std::string&, const std::string&>(); //TODO
   
   DataCollector::DataCollector(const std::string &name, const std::string &runcontrol)
-    :CommandReceiver("DataCollector", name, runcontrol){
+    :CommandReceiver("DataCollector", name, runcontrol),
+     m_mn_qu_capacity(100), m_mn_qu_policy("drop-newest"),
+     m_qu_wr_capacity(10000), m_is_writing(false), m_is_wr_alive(false){
     m_dct_n= str2hash(GetFullName());
     m_evt_c = 0;
     m_fraction = 1;
   }
 
   DataCollector::~DataCollector(){  
+    try{
+      StopWriting();
+    }
+    catch(...){
+      EUDAQ_WARN("DataCollector:: execption from the writing thread");
+    }
   }
 
   void DataCollector::DoInitialise(){
@@ -51,6 +59,9 @@ namespace eudaq {
   void DataCollector::DoReceive(ConnectionSPC id, EventSP ev){
   }
 
+  void DataCollector::DoIdle(){
+  }
+
   void DataCollector::SetServerAddress(const std::string &addr){
     m_data_addr = addr;
   }
@@ -81,6 +92,11 @@ namespace eudaq {
       m_fwpatt = conf->Get("EUDAQ_FW_PATTERN", "$12D_run$6R$X");
       m_dct_n = conf->Get("EUDAQ_ID", m_dct_n);
       m_fraction = conf->Get("EUDAQ_DATACOL_SEND_MONITOR_FRACTION", 10);
+      m_qu_wr_capacity = conf->Get("EUDAQ_DATACOL_WRITE_QUEUE_SIZE", 10000);
+      m_mn_qu_capacity = conf->Get("EUDAQ_DATACOL_MONITOR_QUEUE_SIZE", 100);
+      m_mn_qu_policy = conf->Get("EUDAQ_DATACOL_MONITOR_QUEUE_POLICY", "drop-newest");
+      SetQueue(conf->Get("EUDAQ_DATA_QUEUE_SIZE", 50000),
+	       conf->Get("EUDAQ_DATA_QUEUE_POLICY", "drop-oldest"));
       DoConfigure();
       CommandReceiver::OnConfigure();
     }catch (const Exception &e) {
@@ -95,8 +111,16 @@ namespace eudaq {
     try {
       m_data_addr = Listen(m_data_addr);
       SetStatusTag("_SERVER", m_data_addr);
-      m_writer = Factory<FileWriter>::Create<std::string&>(str2hash(m_fwtype), m_fwpatt);
+      FileWriterSP writer = Factory<FileWriter>::Create<std::string&>(str2hash(m_fwtype), m_fwpatt);
+      if(writer)
+	writer->SetConfiguration(GetConfiguration());
+      std::unique_lock<std::mutex> lk_file(m_mx_wr_file);
+      m_writer = writer;
+      lk_file.unlock();
       m_evt_c = 0;
+      m_lat_build.Reset();
+      m_lat_write.Reset();
+      m_lat_monitor.Reset();
 
       std::string mn_str = GetConfiguration()->Get("EUDAQ_MN", "");
       std::vector<std::string> col_mn_name = split(mn_str, ";,", true);
@@ -108,11 +132,21 @@ namespace eudaq {
 	if(!mn_addr.empty()){
 	  m_senders[mn_addr]
 	    = std::shared_ptr<DataSender>(new DataSender("DataCollector", GetName()));
+	  // a slow monitor loses events instead of holding up the writing
+	  m_senders[mn_addr]->SetQueue(m_mn_qu_capacity, m_mn_qu_policy);
+	  m_senders[mn_addr]->SetLatencyHistogram(&m_lat_monitor);
 	  m_senders[mn_addr]->Connect(mn_addr);
 	}
 	lk.unlock();
       }
       GetConfiguration()->SetSection(cur_backup);
+      if(m_qu_wr_capacity){
+	StopWriting();
+	std::unique_lock<std::mutex> lk(m_mx_qu_wr);
+	m_is_writing = true;
+	m_is_wr_alive = true;
+	m_fut_async_wr = std::async(std::launch::async, &DataCollector::AsyncWriting, this);
+      }
       DoStartRun();
       CommandReceiver::OnStartRun();
     } catch (const Exception &e) {
@@ -126,10 +160,16 @@ namespace eudaq {
     EUDAQ_INFO("RUN #" + std::to_string(GetRunNumber()) + " is to be stopped...");
     try {
       DoStopRun();
+      StopListen();
+      // the events built on the disconnection of the producers are written
+      // and sent before the monitors are disconnected
+      StopWriting();
       std::unique_lock<std::mutex> lk(m_mtx_sender);
       m_senders.clear();
       lk.unlock();
-      StopListen();
+      std::unique_lock<std::mutex> lk_file(m_mx_wr_file);
+      if(m_writer)
+	m_writer->Flush();
       CommandReceiver::OnStopRun();
     } catch (const Exception &e) {
       std::string msg = "Error stopping for run " + std::to_string(GetRunNumber()) + ": " + e.what();
@@ -146,6 +186,7 @@ namespace eudaq {
       m_senders.clear();
       lk.unlock();
       StopListen();
+      StopWriting();
       CommandReceiver::OnReset();
     } catch (const std::exception &e) {
       EUDAQ_THROW( std::string("DataCollector Reset:: Caught exception: ") + e.what() );
@@ -165,6 +206,29 @@ namespace eudaq {
   void DataCollector::OnStatus(){
     SetStatusTag("EventN", std::to_string(m_evt_c));
     SetStatusTag("MonitorEventN", std::to_string(float(m_evt_c/m_fraction)));
+    SetStatusTag("QueueDroppedN", std::to_string(GetQueueDropped()));
+    SetStatusTag("QueueHighWater", std::to_string(GetQueueHighWater()));
+    std::unique_lock<std::mutex> lk_wr(m_mx_qu_wr);
+    size_t wr_depth = m_qu_wr.size();
+    bool wr_alive = m_is_wr_alive;
+    lk_wr.unlock();
+    uint64_t mn_dropped = 0;
+    std::unique_lock<std::mutex> lk(m_mtx_sender);
+    for(auto &e: m_senders)
+      if(e.second)
+	mn_dropped += e.second->GetQueueDropped();
+    lk.unlock();
+    // without writing thread nobody else flushes while no events arrive
+    if(!wr_alive){
+      std::unique_lock<std::mutex> lk_file(m_mx_wr_file, std::try_to_lock);
+      if(lk_file && m_writer)
+	m_writer->FlushIfDue();
+    }
+    SetStatusTag("WriteQueueDepth", std::to_string(wr_depth));
+    SetStatusTag("MonitorDroppedN", std::to_string(mn_dropped));
+    SetStatusTag("BuildLatency", m_lat_build.ToString());
+    SetStatusTag("WriteLatency", m_lat_write.ToString());
+    SetStatusTag("MonitorLatency", m_lat_monitor.ToString());
     DoStatus();
     // if(m_writer && m_writer->FileBytes()){
     //   SetStatusTag("FILEBYTES", std::to_string(m_writer->FileBytes()));
@@ -180,44 +244,144 @@ namespace eudaq {
   }
     
   void DataCollector::OnReceive(ConnectionSPC id, EventSP ev){
-    DoReceive(id, ev);
+    auto t0 = std::chrono::steady_clock::now();
+    m_run_blocks.Process(ev);
+    // a batch of Producer::SendEvents, nobody else holds its sub-events
+    if(ev->IsFlagPacket() && ev->GetDescription() == "EventBatch"){
+      for(auto &subev: ev->GetSubEvents())
+	DoReceive(id, std::const_pointer_cast<Event>(subev));
+    }
+    else
+      DoReceive(id, ev);
+    m_lat_build.Add(std::chrono::steady_clock::now() - t0);
   }  
+
+  void DataCollector::OnIdle(){
+    DoIdle();
+  }
     
   void DataCollector::WriteEvent(EventSP ev){
+    if(ev->IsBORE()){
+      if(GetConfiguration())
+	ev->SetTag("EUDAQ_CONFIG_DC", to_string(*GetConfiguration()));
+      if(GetInitConfiguration())
+	ev->SetTag("EUDAQ_CONFIG_INIT_DC", to_string(*GetInitConfiguration()));
+    }
+    // numbered under the lock, so that the file keeps the order of the numbers
+    std::unique_lock<std::mutex> lk(m_mx_qu_wr);
+    ev->SetRunN(GetRunNumber());
+    ev->SetEventN(m_evt_c);
+    uint32_t evt_c = ++m_evt_c;
+    ev->SetStreamN(m_dct_n);
+    QueuedEvent item{std::move(ev), evt_c%m_fraction == 0 || evt_c == 1,
+		     std::chrono::steady_clock::now()};
+    if(!m_is_wr_alive){
+      // no writing thread: written by the caller, outside of the queue lock
+      // but in the order of the numbers
+      std::unique_lock<std::mutex> lk_file(m_mx_wr_file);
+      lk.unlock();
+      Write(item);
+      return;
+    }
+    // no more waiting for room once stopping, the thread drains the queue
+    m_cv_wr_not_full.wait(lk, [this]{
+	return m_qu_wr.size() < m_qu_wr_capacity || !m_is_writing || !m_is_wr_alive;});
+    if(!m_is_wr_alive){
+      std::unique_lock<std::mutex> lk_file(m_mx_wr_file);
+      lk.unlock();
+      Write(item);
+      return;
+    }
+    m_qu_wr.push_back(std::move(item));
+    m_cv_wr_not_empty.notify_one();
+  }
+
+  // Writes the queued events until stopped and drained. On any exit the
+  // callers of WriteEvent() fall back to writing themselves.
+  bool DataCollector::AsyncWriting(){
     try{
-      if(ev->IsBORE()){
-	if(GetConfiguration())
-	  ev->SetTag("EUDAQ_CONFIG_DC", to_string(*GetConfiguration()));
-	if(GetInitConfiguration())
-	  ev->SetTag("EUDAQ_CONFIG_INIT_DC", to_string(*GetInitConfiguration()));
+      while(true){
+	std::unique_lock<std::mutex> lk(m_mx_qu_wr);
+	// the time based flushing of the writer must not wait for the next event
+	if(!m_cv_wr_not_empty.wait_for(lk, std::chrono::milliseconds(100), [this]{
+	      return !m_qu_wr.empty() || !m_is_writing;})){
+	  lk.unlock();
+	  std::unique_lock<std::mutex> lk_file(m_mx_wr_file);
+	  if(m_writer)
+	    m_writer->FlushIfDue();
+	  continue;
+	}
+	if(m_qu_wr.empty()){
+	  m_is_wr_alive = false;
+	  m_cv_wr_not_full.notify_all();
+	  return true;
+	}
+	QueuedEvent item = std::move(m_qu_wr.front());
+	m_qu_wr.pop_front();
+	m_cv_wr_not_full.notify_one();
+	lk.unlock();
+	std::unique_lock<std::mutex> lk_file(m_mx_wr_file);
+	Write(item);
       }
-      
-      ev->SetRunN(GetRunNumber());
-      ev->SetEventN(m_evt_c);
-      m_evt_c ++;
-      ev->SetStreamN(m_dct_n);
+    }
+    catch(...){
+      std::unique_lock<std::mutex> lk(m_mx_qu_wr);
+      m_is_wr_alive = false;
+      m_cv_wr_not_full.notify_all();
+      throw;
+    }
+  }
+
+  void DataCollector::StopWriting(){
+    std::unique_lock<std::mutex> lk(m_mx_qu_wr);
+    m_is_writing = false;
+    m_cv_wr_not_empty.notify_all();
+    m_cv_wr_not_full.notify_all();
+    lk.unlock();
+    if(m_fut_async_wr.valid())
+      m_fut_async_wr.get();
+  }
+
+  // Called with m_mx_wr_file locked. The delivery to the monitors is
+  // timed by their DataSenders.
+  void DataCollector::Write(const QueuedEvent &item){
+    std::string msg;
+    try{
       auto file_writer = m_writer;
       if(file_writer)
-	file_writer->WriteEvent(ev);
+	file_writer->WriteEvent(item.ev);
       else
 	EUDAQ_THROW("FileWriter is not created before writing.");
-      std::unique_lock<std::mutex> lk(m_mtx_sender);
-      auto senders = m_senders;
-      lk.unlock();
-      if(m_evt_c%m_fraction != 0 && m_evt_c!=1){
-	return;
-      }
-      for(auto &e: senders){
-	if(e.second)
-	  e.second->SendEvent(ev);
-	else
-	  EUDAQ_THROW("DataCollector::WriterEvent, using a null pointer of DataSender");
+      m_lat_write.Add(std::chrono::steady_clock::now() - item.t_queued);
+      if(item.monitor)
+	Publish(item.ev);
+      return;
+    }catch (const std::exception &e) {
+      msg = std::string("Exception writing to file: ") + e.what();
+    }catch (...) {
+      msg = "Unknown exception writing to file";
+    }
+    EUDAQ_ERROR(msg);
+    SetStatus(Status::STATE_ERROR, msg);
+  }
+
+  // Only queues the event at each monitor: sending is done by the threads
+  // of the DataSenders. A failing monitor is dropped, data taking goes on.
+  void DataCollector::Publish(const EventSP &ev){
+    std::unique_lock<std::mutex> lk(m_mtx_sender);
+    auto senders = m_senders;
+    lk.unlock();
+    for(auto &e: senders){
+      if(!e.second)
+	EUDAQ_THROW("DataCollector::WriterEvent, using a null pointer of DataSender");
+      try{
+	e.second->SendEvent(ev);
+      }catch (const Exception &ex) {
+	EUDAQ_WARN("DataCollector:: monitor " + e.first + " is dropped: " + ex.what());
+	lk.lock();
+	m_senders.erase(e.first);
+	lk.unlock();
       }
-    }catch (const Exception &e) {
-      std::string msg = "Exception writing to file: ";
-      msg += e.what();
-      EUDAQ_ERROR(msg);
-      SetStatus(Status::STATE_ERROR, msg);
     }
   }
 
@@ -10,7 +10,9 @@
 namespace eudaq {
   
   DataReceiver::DataReceiver()
-    :m_is_listening(false),m_is_destructing(false), m_last_addr("tcp://0"){
+    :m_is_listening(false),m_is_destructing(false), m_last_addr("tcp://0"),
+     m_qu_capacity(50000), m_qu_policy(QUEUE_DROP_OLDEST), m_qu_policy_conf(QUEUE_DROP_OLDEST),
+     m_qu_dropped(0), m_qu_hwm(0), m_fwd_waiting(false){
   }
 
   DataReceiver::~DataReceiver(){
@@ -28,7 +30,69 @@ namespace eudaq {
   
   void DataReceiver::OnReceive(ConnectionSPC id, EventSP ev){
   }
+
+  void DataReceiver::OnIdle(){
+  }
   
+  void DataReceiver::SetQueue(size_t capacity, const std::string &policy){
+    QueuePolicy p;
+    if(policy == "block")
+      p = QUEUE_BLOCK;
+    else if(policy == "drop-oldest")
+      p = QUEUE_DROP_OLDEST;
+    else if(policy == "drop-newest")
+      p = QUEUE_DROP_NEWEST;
+    else
+      EUDAQ_THROW("DataReceiver: Unknown queue policy '" + policy + "'");
+    std::unique_lock<std::mutex> lk_deamon(m_mx_deamon);
+    m_qu_capacity = capacity ? capacity : 1;
+    m_qu_policy_conf = p;
+  }
+
+  uint64_t DataReceiver::GetQueueDropped() const{
+    return m_qu_dropped;
+  }
+
+  size_t DataReceiver::GetQueueHighWater() const{
+    return m_qu_hwm;
+  }
+
+  // Called from the receiving thread only, the single producer of m_qu_ev.
+  // Connect/disconnect entries, BOREs and EOREs are never dropped. Only the block policy, or
+  // a full queue led by a connect/disconnect entry, makes it wait.
+  void DataReceiver::PushQueue(std::pair<EventSP, ConnectionSPC> &&item, bool droppable){
+    while(!m_qu_ev->TryPush(std::move(item), droppable)){
+      if(m_qu_policy == QUEUE_DROP_OLDEST && m_qu_ev->TryDropFront()){
+	if(m_qu_dropped++ % 10000 == 0)
+	  EUDAQ_WARN("DataReceiver: Buffer of receving event is full, dropping old events.");
+	continue;
+      }
+      if(droppable && m_qu_policy != QUEUE_BLOCK){
+	if(m_qu_dropped++ % 10000 == 0)
+	  EUDAQ_WARN("DataReceiver: Buffer of receving event is full, dropping new events.");
+	return;
+      }
+      if(!m_is_listening && droppable)
+	return;
+      NotifyForwarder();
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    size_t n = m_qu_ev->Size();
+    if(n > m_qu_hwm)
+      m_qu_hwm = n;
+    NotifyForwarder();
+  }
+
+  // Pairs with the check in AsyncForwarding(): either the forwarder sees the
+  // new entry, or this sees it waiting and wakes it under the lock.
+  void DataReceiver::NotifyForwarder(){
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_fwd_waiting){
+      std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+      m_cv_not_empty.notify_all();
+    }
+  }
+
   void DataReceiver::DataHandler(TransportEvent &ev) {
     auto con = ev.id;
     bool has_con_for_discon = false;
@@ -42,9 +106,7 @@ namespace eudaq {
       for (size_t i = 0; i < m_vt_con.size(); ++i){
 	if (m_vt_con[i] == con){
 	  m_vt_con.erase(m_vt_con.begin() + i);
-	  std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	  m_qu_ev.push(std::make_pair<EventSP, ConnectionSPC>(nullptr, con));
-	  m_cv_not_empty.notify_all();
+	  PushQueue(std::make_pair<EventSP, ConnectionSPC>(nullptr, con), false);
 	  has_con_for_discon = true;
 	}
       }
@@ -87,23 +149,21 @@ namespace eudaq {
         con->SetState(1); // successfully identified
 	EUDAQ_INFO("DataReceiver: Connection from " + to_string(*con));
 	m_vt_con.push_back(con);
-	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	m_qu_ev.push(std::make_pair<EventSP, ConnectionSPC>(nullptr, con));
-	m_cv_not_empty.notify_all();
+	PushQueue(std::make_pair<EventSP, ConnectionSPC>(nullptr, con), false);
       }
       else{ //identified connection  
-	BufferSerializer ser(ev.packet.begin(), ev.packet.end());
+	// the packet becomes the shared receive buffer: event blocks are views into it
+	auto packet = std::make_shared<const std::string>(std::move(ev.packet));
+	BufferDeserializer ser(packet);
 	uint32_t id;
 	ser.PreRead(id);
-	auto ev_con = std::make_pair<EventSP, ConnectionSPC>
-	  (Factory<Event>::MakeUnique<Deserializer&>(id, ser), con);
-	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-	m_qu_ev.push(ev_con);
-	if(m_qu_ev.size() > 50000){
-	  m_qu_ev.pop();
-	  EUDAQ_WARN("DataReceiver: Buffer of receving event is full.");
-	}
-	m_cv_not_empty.notify_all();
+	EventSP rcv_ev = Factory<Event>::MakeUnique<Deserializer&>(id, ser);
+	// forwarded or written as received, until it is modified
+	if(rcv_ev && !ser.HasData())
+	  rcv_ev->SetSerialized(packet);
+	// a BORE carries the run blocks, it is never dropped
+	bool droppable = !rcv_ev || (!rcv_ev->HasBORE() && !rcv_ev->IsEORE());
+	PushQueue(std::make_pair(std::move(rcv_ev), con), droppable);
       }
       break;
     default:
@@ -122,23 +182,23 @@ namespace eudaq {
 
   bool DataReceiver::AsyncForwarding(){
     while(!m_is_async_rcv_return){
-      std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-      while(m_qu_ev.empty()){
-	while(m_cv_not_empty.wait_for(lk, std::chrono::seconds(1))
-	      ==std::cv_status::timeout){
-	  if(m_is_async_rcv_return){
-	    for(auto &con: m_vt_con){
-	      OnDisconnect(con);
-	    }
-	    m_vt_con.clear();
-	    return 0;
-	  }
-	}
+      std::pair<EventSP, ConnectionSPC> item;
+      if(!m_qu_ev->TryPop(item)){
+	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+	m_fwd_waiting = true;
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	bool idle = false;
+	if(m_qu_ev->Empty())
+	  idle = m_cv_not_empty.wait_for(lk, std::chrono::milliseconds(100))
+	    == std::cv_status::timeout;
+	m_fwd_waiting = false;
+	lk.unlock();
+	if(idle)
+	  OnIdle();
+	continue;
       }
-      auto ev = m_qu_ev.front().first;
-      auto con = m_qu_ev.front().second;
-      m_qu_ev.pop();
-      lk.unlock();
+      auto ev = item.first;
+      auto con = item.second;
       if(ev){
 	OnReceive(con, ev);
       }
@@ -177,6 +237,10 @@ namespace eudaq {
     
     m_last_addr = dataserver->ConnectionString();
     m_dataserver.reset(dataserver);
+    m_qu_ev.reset(new SpscQueue<std::pair<EventSP, ConnectionSPC>>(m_qu_capacity));
+    m_qu_policy = m_qu_policy_conf;
+    m_qu_dropped = 0;
+    m_qu_hwm = 0;
     m_is_listening = true;
     m_is_async_rcv_return = false;
     m_fut_async_rcv = std::async(std::launch::async, &DataReceiver::AsyncReceiving, this); 
@@ -224,9 +288,9 @@ namespace eudaq {
 	  if(m_fut_async_fwd.valid()){
 	    m_fut_async_fwd.get();
 	  }
-	  if(!m_qu_ev.empty()){
+	  if(m_qu_ev && !m_qu_ev->Empty()){
 	    EUDAQ_WARN("DataReceiver: Data buffer is not empty during the stopping");
-	    m_qu_ev = std::queue<std::pair<EventSP, ConnectionSPC>>();
+	    m_qu_ev.reset();
 	  }
 	  if(m_dataserver)
 	    m_dataserver.reset();
@@ -245,9 +309,9 @@ namespace eudaq {
       if(m_fut_async_fwd.valid()){
 	m_fut_async_fwd.get();
       }
-      if(!m_qu_ev.empty()){
+      if(m_qu_ev && !m_qu_ev->Empty()){
 	EUDAQ_WARN("DataReceiver: Data buffer is not empty during the exiting");
-	m_qu_ev = std::queue<std::pair<EventSP, ConnectionSPC>>();
+	m_qu_ev.reset();
       }
       if(m_dataserver)
 	m_dataserver.reset();
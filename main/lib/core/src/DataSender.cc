@@ -10,20 +10,70 @@ namespace eudaq {
   DataSender::DataSender(const std::string & type, const std::string & name)
     : m_type(type),
     m_name(name),
-    m_packetCounter(0) {}
+    m_packetCounter(0),
+    m_is_connected(false),
+    m_qu_capacity(10000),
+    m_qu_policy(QUEUE_BLOCK),
+    m_qu_dropped(0),
+    m_bytes_sent(0),
+    m_lat(nullptr){}
 
 
   DataSender::~DataSender(){
     std::cout<<"dataSender clearing"<<std::endl;
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
     m_is_connected = false;
-    if(m_fut_async.valid()){
-      m_fut_async.get();
+    m_cv_not_empty.notify_all();
+    lk.unlock();
+    try{
+      if(m_fut_async.valid()){
+	m_fut_async.get();
+      }
+    }
+    catch(...){
+      EUDAQ_WARN("DataSender:: execption from the sending thread");
     }
     std::cout<< "dataSender cleared"<<std::endl;
   }
 
+  void DataSender::SetQueue(size_t capacity, const std::string &policy){
+    QueuePolicy p;
+    if(policy == "block")
+      p = QUEUE_BLOCK;
+    else if(policy == "drop-oldest")
+      p = QUEUE_DROP_OLDEST;
+    else if(policy == "drop-newest")
+      p = QUEUE_DROP_NEWEST;
+    else
+      EUDAQ_THROW("DataSender:: Unknown queue policy '" + policy + "'");
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    m_qu_capacity = capacity;
+    m_qu_policy = p;
+  }
+
+  void DataSender::SetLatencyHistogram(LatencyHistogram *lat){
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    m_lat = lat;
+  }
+
+  size_t DataSender::GetQueueDepth() const{
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
+    return m_qu_ev.size();
+  }
+
+  uint64_t DataSender::GetQueueDropped() const{
+    return m_qu_dropped;
+  }
+
+  uint64_t DataSender::GetBytesSent() const{
+    return m_bytes_sent;
+  }
+
   void DataSender::Connect(const std::string & server) {
+    std::unique_lock<std::mutex> lk(m_mx_qu_ev);
     m_is_connected = false;
+    m_cv_not_empty.notify_all();
+    lk.unlock();
     try{
       if(m_fut_async.valid()){
 	m_fut_async.get();
@@ -34,8 +84,9 @@ namespace eudaq {
       EUDAQ_WARN("DataSender:: connection execption from disconnetion");
     }
     
-    std::unique_lock<std::mutex> lk(m_mx_qu_ev);    
-    m_qu_ev = std::queue<EventSPC>();    
+    lk.lock();
+    m_qu_ev.clear();
+    m_err = nullptr;
     lk.unlock();
     m_dataclient.reset(TransportClient::CreateClient(server));
     std::string packet;
@@ -75,52 +126,89 @@ namespace eudaq {
     if (std::string(packet, 0, i1) != "OK")
       EUDAQ_THROW("DataSender:: Connection refused by DataReceiver server: " + packet);
     m_is_connected = true;
-    m_fut_async = std::async(std::launch::async, &DataSender::AsyncSending, this);
+    if(m_qu_capacity)
+      m_fut_async = std::async(std::launch::async, &DataSender::AsyncSending, this);
   }
 
   void DataSender::SendEvent(EventSPC ev){
     if (!m_dataclient)
       EUDAQ_THROW("DataSender:: Transport not connected error");
+    auto t_queued = std::chrono::steady_clock::now();
+    if(!m_qu_capacity){
+      Send(ev);
+      if(m_lat)
+	m_lat->Add(std::chrono::steady_clock::now() - t_queued);
+      return;
+    }
 
-    /*
+    bool dropped = false;
     std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-    m_qu_ev.push(ev);
-    if(m_qu_ev.size() > 50000){
-      m_qu_ev.pop();
-      EUDAQ_WARN("DataSender:: Buffer of sending event is full.");
-    }    
-    m_cv_not_empty.notify_all();
-    */
+    if(m_err)
+      std::rethrow_exception(m_err);
+    // BORE and EORE are always queued, even beyond the capacity, also when
+    // the BORE is a sub-event of a batch or of a built event
+    if(m_qu_ev.size() >= m_qu_capacity && !ev->HasBORE() && !ev->IsEORE()){
+      if(m_qu_policy == QUEUE_DROP_NEWEST){
+	dropped = true;
+      }
+      else if(m_qu_policy == QUEUE_DROP_OLDEST){
+	for(auto it = m_qu_ev.begin(); it != m_qu_ev.end(); ++it){
+	  if(!it->ev->HasBORE() && !it->ev->IsEORE()){
+	    m_qu_ev.erase(it);
+	    dropped = true;
+	    break;
+	  }
+	}
+      }
+      else{
+	m_cv_not_full.wait(lk, [this]{
+	    return m_qu_ev.size() < m_qu_capacity || m_err || !m_is_connected;});
+	if(m_err)
+	  std::rethrow_exception(m_err);
+      }
+    }
+    if(!dropped || m_qu_policy == QUEUE_DROP_OLDEST){
+      m_qu_ev.push_back(QueuedEvent{ev, t_queued});
+      m_cv_not_empty.notify_one();
+    }
+    lk.unlock();
+    if(dropped && m_qu_dropped++ % 10000 == 0)
+      EUDAQ_WARN("DataSender:: Buffer of sending event is full, dropping events.");
+  }
 
-    BufferSerializer ser;
-    ev->Serialize(ser);
+  void DataSender::Send(const EventSPC &ev){
+    // shared with the other senders and the file writer of the same event
+    auto buf = ev->GetSerialized();
     m_packetCounter += 1;
-    //TODO: catch exception below
-    m_dataclient->SendPacket(ser);
+    m_dataclient->SendPacket(*buf);
+    m_bytes_sent += buf->size();
   }
 
+  // Sends the queued events until disconnected and drained.
+  // A failure is handed to the next SendEvent() call.
   bool DataSender::AsyncSending(){
-    while(m_is_connected){//TODO:
+    while(true){
       std::unique_lock<std::mutex> lk(m_mx_qu_ev);
-      while(m_qu_ev.empty()){
-	while(m_cv_not_empty.wait_for(lk, std::chrono::milliseconds(100))
-	      ==std::cv_status::timeout){
-	  if(!m_is_connected){
-	    return false;
-	  }
-	}
-      }
-      auto ev = m_qu_ev.front();
-      m_qu_ev.pop();
+      m_cv_not_empty.wait(lk, [this]{return !m_qu_ev.empty() || !m_is_connected;});
+      if(m_qu_ev.empty())
+	return true;
+      QueuedEvent item = std::move(m_qu_ev.front());
+      m_qu_ev.pop_front();
+      m_cv_not_full.notify_one();
       lk.unlock();
-      BufferSerializer ser;
-      ev->Serialize(ser);
-      m_packetCounter += 1;
-      //TODO: catch exception below
-      m_dataclient->SendPacket(ser);
+      try{
+	Send(item.ev);
+	if(m_lat)
+	  m_lat->Add(std::chrono::steady_clock::now() - item.t_queued);
+      }
+      catch(...){
+	lk.lock();
+	m_err = std::current_exception();
+	m_qu_ev.clear();
+	m_cv_not_full.notify_all();
+	return false;
+      }
     }
-
-    return true;
   }
 
 }
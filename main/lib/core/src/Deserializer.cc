@@ -30,4 +30,14 @@ namespace eudaq{
     PreDeserialize(dst, size);
   }
 
+  const uint8_t *Deserializer::ReadShared(size_t size,
+					  std::shared_ptr<const void> &owner){
+    return DeserializeShared(size, owner);
+  }
+
+  const uint8_t *Deserializer::DeserializeShared(size_t,
+						 std::shared_ptr<const void> &){
+    return nullptr;
+  }
+
 }
@@ -2,6 +2,8 @@
 #include "eudaq/BufferSerializer.hh"
 #include "eudaq/Logger.hh"
 
+#include <algorithm>
+
 namespace eudaq {
   
   template class DLLEXPORT Factory<Event>;
@@ -67,6 +69,7 @@ namespace eudaq {
 
 
   void Event::AddSubEvent(EventSPC ev){
+    ClearSerialized();
     bool exist = false;
     for(auto &e : m_sub_events){
       if(ev == e){
@@ -78,6 +81,7 @@ namespace eudaq {
     }
   
   void Event::SetTimestamp(uint64_t tb, uint64_t te, bool flag){
+    ClearSerialized();
     m_ts_begin = tb;
     m_ts_end = te;
     if(flag)
@@ -100,14 +104,64 @@ namespace eudaq {
     ser.write(m_blocks);
     ser.write((uint32_t)m_sub_events.size());
     for(auto &ev: m_sub_events){
-      ser.write(*ev);
+      // a sub-event received from a producer is copied as it came
+      auto buf = std::atomic_load(&ev->m_ser_cache);
+      if(buf)
+	ser.append(reinterpret_cast<const uint8_t*>(buf->data()), buf->size());
+      else
+	ser.write(*ev);
     }
   }
 
+  namespace{
+    class StringSerializer : public Serializer {
+    public:
+      explicit StringSerializer(std::string &buf) :m_buf(buf){}
+    private:
+      void Serialize(const uint8_t *data, size_t len) override {
+	m_buf.append(reinterpret_cast<const char*>(data), len);
+      }
+      std::string &m_buf;
+    };
+  }
+
+  std::shared_ptr<const std::string> Event::GetSerialized() const{
+    auto buf = std::atomic_load(&m_ser_cache);
+    if(buf)
+      return buf;
+    // concurrent first callers may both serialize, either result is kept
+    auto made = std::make_shared<std::string>();
+    StringSerializer ser(*made);
+    Serialize(ser);
+    buf = std::move(made);
+    std::atomic_store(&m_ser_cache, buf);
+    return buf;
+  }
+
+  void Event::SetSerialized(std::shared_ptr<const std::string> buf){
+    std::atomic_store(&m_ser_cache, std::move(buf));
+  }
+
+  void Event::ClearSerialized(){
+    if(m_ser_cache)
+      std::atomic_store(&m_ser_cache, std::shared_ptr<const std::string>());
+  }
+
   std::vector<uint8_t> Event::GetBlock(uint32_t i) const{
+    return GetBlockView(i).ToVector();
+  }
+
+  const EventBlock& Event::GetBlockView(uint32_t i) const{
+    static const EventBlock empty;
     auto it = m_blocks.find(i);
+    if(it == m_blocks.end() && m_run_blocks){
+      it = m_run_blocks->find(i);
+      if(it != m_run_blocks->end())
+	return it->second;
+    }
     if(it == m_blocks.end()){
       EUDAQ_WARN(std::string("RAWDATAEVENT:: no bolck with ID ") + std::to_string(i) + " exists");
+      return empty;
     }
     return it->second;
   }
@@ -117,6 +171,27 @@ namespace eudaq {
     for(auto &e : m_blocks){
       vnum.push_back(e.first);
     }
+    if(m_run_blocks){
+      for(auto &e : *m_run_blocks)
+	if(!m_blocks.count(e.first))
+	  vnum.push_back(e.first);
+      std::sort(vnum.begin(), vnum.end());
+    }
+    return vnum;
+  }
+
+  void Event::SetRunBlocks(EventBlocksSPC blocks){
+    m_run_blocks = blocks;
+  }
+
+  EventBlocksSPC Event::GetRunBlocks() const{
+    return m_run_blocks;
+  }
+
+  std::vector<uint32_t> Event::GetRunBlockNumList() const{
+    std::vector<uint32_t> vnum;
+    for(auto &id: split(GetTag("EUDAQ_RUN_BLOCKS"), ",", true))
+      vnum.push_back(std::stoul(id));
     return vnum;
   }
   
@@ -162,11 +237,11 @@ namespace eudaq {
 
 
   bool Event::HasTag(const std::string &name) const {return m_tags.find(name) != m_tags.end();}
-  void Event::SetTag(const std::string &name, const std::string &val) {m_tags[name] = val;}
+  void Event::SetTag(const std::string &name, const std::string &val) {ClearSerialized(); m_tags[name] = val;}
   std::map<std::string, std::string> Event::GetTags() const {return m_tags;}
     
-  void Event::SetFlagBit(uint32_t f) { m_flags |= f;}
-  void Event::ClearFlagBit(uint32_t f) { m_flags &= ~f;}
+  void Event::SetFlagBit(uint32_t f) {ClearSerialized(); m_flags |= f;}
+  void Event::ClearFlagBit(uint32_t f) {ClearSerialized(); m_flags &= ~f;}
   bool Event::IsFlagBit(uint32_t f) const { return (m_flags&f) == f;}
 
   void Event::SetBORE() {SetFlagBit(FLAG_BORE);}
@@ -178,6 +253,14 @@ namespace eudaq {
     
   bool Event::IsBORE() const { return IsFlagBit(FLAG_BORE);}
   bool Event::IsEORE() const { return IsFlagBit(FLAG_EORE);}
+  bool Event::HasBORE() const {
+    if(IsBORE())
+      return true;
+    for(auto &subev: m_sub_events)
+      if(subev->HasBORE())
+	return true;
+    return false;
+  }
   bool Event::IsFlagFake() const {return IsFlagBit(FLAG_FAKE);}
   bool Event::IsFlagPacket() const {return IsFlagBit(FLAG_PACK);}
   bool Event::IsFlagTimestamp() const {return IsFlagBit(FLAG_TIME);}
@@ -187,15 +270,15 @@ namespace eudaq {
   EventSPC Event::GetSubEvent(uint32_t i) const {return m_sub_events.at(i);}
   std::vector<EventSPC> Event::GetSubEvents() const {return m_sub_events;}
     
-  void Event::SetType(uint32_t id){m_type = id;}
-  void Event::SetVersion(uint32_t v){m_version = v;}
-  void Event::SetFlag(uint32_t f) {m_flags = f;}
-  void Event::SetRunN(uint32_t n){m_run_n = n;}
-  void Event::SetEventN(uint32_t n){m_ev_n = n;}
-  void Event::SetDeviceN(uint32_t n){m_stm_n = n;}
-  void Event::SetTriggerN(uint32_t n, bool flag){m_tg_n = n; if(flag) SetFlagBit(FLAG_TRIG);}
-  void Event::SetExtendWord(uint32_t n){m_extend = n;}
-  void Event::SetDescription(const std::string &t) {m_dspt = t;}
+  void Event::SetType(uint32_t id){ClearSerialized(); m_type = id;}
+  void Event::SetVersion(uint32_t v){ClearSerialized(); m_version = v;}
+  void Event::SetFlag(uint32_t f) {ClearSerialized(); m_flags = f;}
+  void Event::SetRunN(uint32_t n){ClearSerialized(); m_run_n = n;}
+  void Event::SetEventN(uint32_t n){ClearSerialized(); m_ev_n = n;}
+  void Event::SetDeviceN(uint32_t n){ClearSerialized(); m_stm_n = n;}
+  void Event::SetTriggerN(uint32_t n, bool flag){ClearSerialized(); m_tg_n = n; if(flag) SetFlagBit(FLAG_TRIG);}
+  void Event::SetExtendWord(uint32_t n){ClearSerialized(); m_extend = n;}
+  void Event::SetDescription(const std::string &t) {ClearSerialized(); m_dspt = t;}
     
   uint32_t Event::GetType() const {return m_type;};
   uint32_t Event::GetVersion()const {return m_version;}
@@ -209,15 +292,17 @@ namespace eudaq {
   uint64_t Event::GetTimestampEnd() const {return m_ts_end;}
   std::string Event::GetDescription() const {return m_dspt;}
 
-  void Event::SetEventID(uint32_t id){m_type = id;}
+  void Event::SetEventID(uint32_t id){ClearSerialized(); m_type = id;}
   uint32_t Event::GetEventID() const {return m_type;};
-  void Event::SetStreamN(uint32_t n){m_stm_n = n;}
+  void Event::SetStreamN(uint32_t n){ClearSerialized(); m_stm_n = n;}
   uint32_t Event::GetStreamN() const {return m_stm_n;}
   uint32_t Event::GetEventNumber()const {return m_ev_n;}
   uint32_t Event::GetRunNumber()const {return m_run_n;}
 
-  size_t Event::GetNumBlock() const { return m_blocks.size(); }
-  size_t Event::NumBlocks() const { return m_blocks.size(); }
+  size_t Event::GetNumBlock() const { return NumBlocks(); }
+  size_t Event::NumBlocks() const {
+    return m_run_blocks ? GetBlockNumList().size() : m_blocks.size();
+  }
 
   std::string Event::GetTag(const std::string &name, const char *def) const{
     return GetTag(name, std::string(def));
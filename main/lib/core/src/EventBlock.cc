@@ -0,0 +1,64 @@
+#include "eudaq/EventBlock.hh"
+#include "eudaq/Serializer.hh"
+#include <stdexcept>
+#include <string>
+
+namespace eudaq {
+
+  EventBlock::EventBlock()
+    :m_view(nullptr), m_view_size(0){
+  }
+
+  EventBlock::EventBlock(std::vector<uint8_t> &&data)
+    :m_owned(std::move(data)), m_view(nullptr), m_view_size(0){
+  }
+
+  EventBlock::EventBlock(std::shared_ptr<const void> buffer,
+			 const uint8_t *data, size_t size)
+    :m_buffer(buffer), m_view(data), m_view_size(size){
+  }
+
+  EventBlock::EventBlock(Deserializer &ds)
+    :m_view(nullptr), m_view_size(0){
+    uint32_t len = 0;
+    ds.read(len);
+    std::shared_ptr<const void> buffer;
+    const uint8_t *view = ds.ReadShared(len, buffer);
+    if(view && buffer){
+      m_buffer = buffer;
+      m_view = view;
+      m_view_size = len;
+    }
+    else{
+      m_owned.resize(len);
+      if(len)
+	ds.read(m_owned.data(), len);
+    }
+  }
+
+  void EventBlock::Serialize(Serializer &ser) const{
+    ser.write((uint32_t)size());
+    ser.append(data(), size());
+  }
+
+  const uint8_t &EventBlock::at(size_t i) const{
+    if(i >= size())
+      throw std::out_of_range("EventBlock::at: index " + std::to_string(i) +
+			      " out of range " + std::to_string(size()));
+    return data()[i];
+  }
+
+  std::vector<uint8_t> EventBlock::ToVector() const{
+    return std::vector<uint8_t>(begin(), end());
+  }
+
+  void EventBlock::Append(const uint8_t *data, size_t size){
+    if(m_buffer){
+      m_owned.assign(m_view, m_view + m_view_size);
+      m_buffer.reset();
+      m_view = nullptr;
+      m_view_size = 0;
+    }
+    m_owned.insert(m_owned.end(), data, data + size);
+  }
+}
@@ -1,4 +1,5 @@
 #include "eudaq/FileDeserializer.hh"
+#include "eudaq/FileChunkHeader.hh"
 #include "eudaq/Logger.hh"
 #include "eudaq/Platform.hh"
 #include "eudaq/Utils.hh"
@@ -6,12 +7,36 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <iostream>
+#include <algorithm>
+#ifdef EUDAQ_WITH_ZLIB
+#include <zlib.h>
+#endif
 
 namespace eudaq {
+  namespace {
+    // 64-bit file positions, long has 32 bits on Windows
+    int SeekSet(FILE *file, uint64_t offset) {
+#if EUDAQ_PLATFORM_IS(WIN32)
+      return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+      return fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    }
+
+    uint64_t TellPos(FILE *file) {
+#if EUDAQ_PLATFORM_IS(WIN32)
+      return static_cast<uint64_t>(_ftelli64(file));
+#else
+      return static_cast<uint64_t>(ftello(file));
+#endif
+    }
+  }
+
   FileDeserializer::FileDeserializer(const std::string &fname, bool faileof,
                                      size_t buffersize)
     : m_filename(fname), m_file(0), m_faileof(faileof), m_buf(buffersize), m_start(&m_buf[0]),
-        m_stop(m_start) {
+        m_stop(m_start), m_zip(false), m_format_known(false), m_chunk_pos(0), m_chunk_start(0),
+        m_next_offset(0), m_scan_offset(0) {
     m_file = fopen(m_filename.c_str(), "rb");
     if (!m_file)
       EUDAQ_THROWX(FileNotFoundException, "Unable to open file: " + fname);
@@ -24,6 +49,39 @@ namespace eudaq {
     if (fseek(m_file, 0L, SEEK_SET) != 0) {
       EUDAQ_THROWX(FileReadException, "seek to begin failed: " + fname);
     }
+    // a file still being written may not have its first chunk yet, then
+    // the format is decided when the data arrives
+    const std::string ext(".rawz");
+    if (m_filename.size() >= ext.size() &&
+        m_filename.compare(m_filename.size() - ext.size(), ext.size(), ext) == 0)
+      SetZip(true);
+    else
+      DetectFormat(false);
+  }
+
+  void FileDeserializer::SetZip(bool zip) {
+#ifndef EUDAQ_WITH_ZLIB
+    if (zip)
+      EUDAQ_THROWX(FileReadException, "compressed file, but EUDAQ is built without zlib: " + m_filename);
+#endif
+    m_zip = zip;
+    m_format_known = true;
+  }
+
+  // Decides between plain and compressed data from the first bytes of the
+  // file. Without wait nothing is decided while they are missing.
+  bool FileDeserializer::DetectFormat(bool wait) {
+    if (m_format_known)
+      return true;
+    uint8_t head[FileChunkHeader::SIZE];
+    clearerr(m_file);
+    rewind(m_file);
+    size_t got = ReadFile(head, sizeof(head), wait ? sizeof(head) : 0);
+    rewind(m_file);
+    if (got < sizeof(head))
+      return false;
+    SetZip(FileChunkHeader::IsChunk(head));
+    return true;
   }
   
   FileDeserializer::~FileDeserializer(){
@@ -39,6 +97,8 @@ namespace eudaq {
   }
 
   size_t FileDeserializer::FillBuffer(size_t min) {
+    if (!DetectFormat(min > 0))
+      return 0;
     clearerr(m_file);
     if (level() == 0)
       m_start = m_stop = &m_buf[0];
@@ -55,9 +115,18 @@ namespace eudaq {
         min = end - m_stop;
       }
     }
-    size_t read =
-      fread(reinterpret_cast<char *>(m_stop), sizeof(char), end - m_stop, m_file);
+    if (m_zip)
+      return FillFromChunks(end, min);
+    size_t read = ReadFile(m_stop, end - m_stop, min);
     m_stop += read;
+    return read;
+  }
+
+  // Reads up to len bytes, waiting for the file to grow until there are at
+  // least min of them
+  size_t FileDeserializer::ReadFile(uint8_t *data, size_t len, size_t min) {
+    size_t read =
+      fread(reinterpret_cast<char *>(data), sizeof(char), len, m_file);
     int n_tries = 0;
     const int max_tries = 1000;    
     while (read < min) {
@@ -80,15 +149,85 @@ namespace eudaq {
       mSleep(10);
       clearerr(m_file);
       size_t bytes =
-	fread(reinterpret_cast<char *>(m_stop), sizeof(char), end - m_stop, m_file);
+	fread(reinterpret_cast<char *>(data + read), sizeof(char), len - read, m_file);
       if(bytes == 0) ++n_tries;
       else n_tries = 0;
       read += bytes;
-      m_stop += bytes;
     }
     return read;
   }
 
+  size_t FileDeserializer::FillFromChunks(uint8_t *end, size_t min) {
+    size_t read = 0;
+    while (m_stop < end) {
+      if (m_chunk_pos == m_chunk.size() && !ReadChunk(read < min))
+        break;
+      size_t n = std::min<size_t>(end - m_stop, m_chunk.size() - m_chunk_pos);
+      memcpy(m_stop, m_chunk.data() + m_chunk_pos, n);
+      m_chunk_pos += n;
+      m_stop += n;
+      read += n;
+    }
+    return read;
+  }
+
+  // Reads and decompresses the chunk at m_next_offset. Without wait, false
+  // is returned if the file ends before it.
+  bool FileDeserializer::ReadChunk(bool wait) {
+    uint8_t head_raw[FileChunkHeader::SIZE];
+    size_t got = ReadFile(head_raw, sizeof(head_raw), wait ? sizeof(head_raw) : 0);
+    if (!got)
+      return false;
+    // a partly written chunk is completed by the writer soon
+    if (got < sizeof(head_raw))
+      ReadFile(head_raw + got, sizeof(head_raw) - got, sizeof(head_raw) - got);
+    FileChunkHeader head;
+    if (!head.Decode(head_raw) ||
+        (head.codec != FileChunkHeader::CODEC_ZLIB &&
+         !(head.codec == FileChunkHeader::CODEC_STORE && head.comp_size == head.raw_size)))
+      EUDAQ_THROWX(FileReadException, "Invalid compressed chunk at " +
+                   to_string(m_next_offset) + " in file '" + m_filename + "'");
+    m_chunk.resize(head.raw_size);
+    if (head.codec == FileChunkHeader::CODEC_STORE)
+      ReadFile(m_chunk.data(), m_chunk.size(), m_chunk.size());
+    else {
+      m_zin.resize(head.comp_size);
+      ReadFile(m_zin.data(), m_zin.size(), m_zin.size());
+#ifdef EUDAQ_WITH_ZLIB
+      uLongf len = head.raw_size;
+      int err = uncompress(m_chunk.data(), &len, m_zin.data(), m_zin.size());
+      if (err != Z_OK || len != head.raw_size)
+        EUDAQ_THROWX(FileReadException, "Error decompressing chunk at " +
+                     to_string(m_next_offset) + " in file '" + m_filename +
+                     "': zlib error " + to_string(err));
+#endif
+    }
+    if (m_next_offset == m_scan_offset) {
+      m_chunks.push_back(ChunkPos{head.start, m_next_offset, head.raw_size});
+      m_scan_offset += FileChunkHeader::SIZE + head.comp_size;
+    }
+    m_next_offset += FileChunkHeader::SIZE + head.comp_size;
+    m_chunk_start = head.start;
+    m_chunk_pos = 0;
+    return true;
+  }
+
+  // Adds the next chunk not yet known to the chunk index, reading only its
+  // header. The file position is left undefined.
+  bool FileDeserializer::ScanChunk() {
+    clearerr(m_file);
+    if (SeekSet(m_file, m_scan_offset) != 0)
+      return false;
+    uint8_t head_raw[FileChunkHeader::SIZE];
+    FileChunkHeader head;
+    if (fread(head_raw, 1, sizeof(head_raw), m_file) != sizeof(head_raw) ||
+        !head.Decode(head_raw))
+      return false;
+    m_chunks.push_back(ChunkPos{head.start, m_scan_offset, head.raw_size});
+    m_scan_offset += FileChunkHeader::SIZE + head.comp_size;
+    return true;
+  }
+
   void FileDeserializer::Deserialize(uint8_t *data, size_t len) {
     if (len <= level()) {
       // The buffer contains enough data
@@ -124,6 +263,50 @@ namespace eudaq {
     }
   }
   
+  uint64_t FileDeserializer::Tell() {
+    if (!m_format_known)
+      return 0;
+    if (m_zip)
+      return m_chunk_start + m_chunk_pos - level();
+    // the file position corresponds to the end of the buffered data
+    return TellPos(m_file) - level();
+  }
+
+  void FileDeserializer::Seek(uint64_t offset) {
+    if (!DetectFormat(offset > 0))
+      return;
+    if (m_zip) {
+      while (m_chunks.empty() ||
+             m_chunks.back().start + m_chunks.back().raw_size <= offset) {
+        if (!ScanChunk())
+          break;
+      }
+      auto it = std::upper_bound(m_chunks.begin(), m_chunks.end(), offset,
+                                 [](uint64_t o, const ChunkPos &c){return o < c.start;});
+      if (it == m_chunks.begin())
+        EUDAQ_THROWX(FileReadException, "seek to " + to_string(offset) +
+                     " failed: " + m_filename);
+      --it;
+      m_next_offset = it->file_offset;
+      uint64_t pos = offset - it->start;
+      clearerr(m_file);
+      if (SeekSet(m_file, m_next_offset) != 0 ||
+          !ReadChunk(false))
+        EUDAQ_THROWX(FileReadException, "seek to " + to_string(offset) +
+                     " failed: " + m_filename);
+      // beyond the last chunk the reading continues at the end of the file
+      m_chunk_pos = std::min<uint64_t>(pos, m_chunk.size());
+      m_start = m_stop = &m_buf[0];
+      return;
+    }
+    clearerr(m_file);
+    if (SeekSet(m_file, offset) != 0) {
+      EUDAQ_THROWX(FileReadException, "seek to " + to_string(offset) +
+                   " failed: " + m_filename);
+    }
+    m_start = m_stop = &m_buf[0];
+  }
+
   bool FileDeserializer::ReadEvent(int ver, EventSP &ev,
                                    size_t skip /*= 0*/) {
     if (!HasData()) {
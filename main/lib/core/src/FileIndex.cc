@@ -0,0 +1,180 @@
+#include "eudaq/FileIndex.hh"
+#include "eudaq/FileSerializer.hh"
+#include "eudaq/FileDeserializer.hh"
+#include "eudaq/Serializer.hh"
+
+#include <cstdio>
+#include <algorithm>
+
+namespace eudaq {
+
+  namespace{
+    const std::string INDEX_MAGIC = "EUDAQIDX";
+    const uint32_t INDEX_VERSION = 2;
+
+    template <typename KEY>
+    void MakeLookup(const std::vector<FileIndex::Entry> &entries, KEY key,
+		    std::vector<std::pair<uint64_t, size_t>> &lu){
+      lu.clear();
+      bool sorted = true;
+      for(size_t i = 1; i < entries.size() && sorted; i++)
+	sorted = key(entries[i - 1]) <= key(entries[i]);
+      if(sorted)
+	return;
+      lu.reserve(entries.size());
+      for(size_t i = 0; i < entries.size(); i++)
+	lu.emplace_back(key(entries[i]), i);
+      std::stable_sort(lu.begin(), lu.end(),
+		       [](const std::pair<uint64_t, size_t> &a,
+			  const std::pair<uint64_t, size_t> &b){return a.first < b.first;});
+      for(size_t i = lu.size() - 1; i > 0; i--)
+	lu[i - 1].second = std::min(lu[i - 1].second, lu[i].second);
+    }
+
+    template <typename KEY>
+    size_t FindInLookup(const std::vector<FileIndex::Entry> &entries, KEY key,
+			const std::vector<std::pair<uint64_t, size_t>> &lu, uint64_t v){
+      if(lu.empty())
+	return std::lower_bound(entries.begin(), entries.end(), v,
+				[&key](const FileIndex::Entry &e, uint64_t v){return key(e) < v;})
+	  - entries.begin();
+      auto it = std::lower_bound(lu.begin(), lu.end(), v,
+				 [](const std::pair<uint64_t, size_t> &a, uint64_t v){return a.first < v;});
+      return it == lu.end() ? entries.size() : it->second;
+    }
+
+    uint64_t KeyEvent(const FileIndex::Entry &e){return e.ev_n;}
+    uint64_t KeyTrigger(const FileIndex::Entry &e){return e.tg_n;}
+    uint64_t KeyTimestamp(const FileIndex::Entry &e){return e.ts_end;}
+  }
+
+  std::string FileIndex::IndexPath(const std::string &datafile){
+    return datafile + ".idx";
+  }
+
+  void FileIndex::WriteHeader(Serializer &ser){
+    ser.append(reinterpret_cast<const uint8_t *>(INDEX_MAGIC.data()), INDEX_MAGIC.size());
+    ser.write(INDEX_VERSION);
+  }
+
+  void FileIndex::WriteEntry(Serializer &ser, const Entry &e){
+    ser.write(e.offset);
+    ser.write(e.ev_n);
+    ser.write(e.tg_n);
+    ser.write(e.ts_begin);
+    ser.write(e.ts_end);
+    ser.write(e.flags);
+  }
+
+  FileIndex::Entry FileIndex::MakeEntry(uint64_t offset, const Event &ev){
+    Entry e;
+    e.offset = offset;
+    e.ev_n = ev.GetEventN();
+    e.tg_n = ev.GetTriggerN();
+    e.ts_begin = ev.GetTimestampBegin();
+    e.ts_end = ev.GetTimestampEnd();
+    e.flags = ev.HasBORE() ? FLAG_BORE : 0;
+    // the timestamps of built events are usually carried by the sub-events
+    if(!e.ts_begin && !e.ts_end){
+      for(auto &subev: ev.GetSubEvents()){
+	if(!subev->IsFlagTimestamp())
+	  continue;
+	if(!e.ts_end || subev->GetTimestampBegin() < e.ts_begin)
+	  e.ts_begin = subev->GetTimestampBegin();
+	if(subev->GetTimestampEnd() > e.ts_end)
+	  e.ts_end = subev->GetTimestampEnd();
+      }
+    }
+    return e;
+  }
+
+  bool FileIndex::Load(const std::string &idxfile){
+    m_entries.clear();
+    m_has_flags = true;
+    BuildLookups();
+    FILE *fd = fopen(idxfile.c_str(), "rb");
+    if(!fd)
+      return false;
+    fclose(fd);
+    FileDeserializer des(idxfile, true);
+    std::string magic(INDEX_MAGIC.size(), ' ');
+    uint32_t version = 0;
+    try{
+      des.read(reinterpret_cast<uint8_t *>(&magic[0]), magic.size());
+      des.read(version);
+    }
+    catch(const Exception &){
+      return false;
+    }
+    if(magic != INDEX_MAGIC || version < 1 || version > INDEX_VERSION)
+      return false;
+    m_has_flags = version >= 2;
+    while(des.HasData()){
+      Entry e;
+      e.flags = 0;
+      try{
+	des.read(e.offset);
+	des.read(e.ev_n);
+	des.read(e.tg_n);
+	des.read(e.ts_begin);
+	des.read(e.ts_end);
+	if(m_has_flags)
+	  des.read(e.flags);
+      }
+      catch(const Exception &){
+	break; // truncated last record of a file still being written
+      }
+      m_entries.push_back(e);
+    }
+    BuildLookups();
+    return true;
+  }
+
+  void FileIndex::Save(const std::string &idxfile) const{
+    FileSerializer ser(idxfile, true, 1048576);
+    WriteHeader(ser);
+    for(auto &e: m_entries)
+      WriteEntry(ser, e);
+    ser.Flush();
+  }
+
+  void FileIndex::Rebuild(const std::string &datafile){
+    m_entries.clear();
+    m_has_flags = true;
+    FileDeserializer des(datafile);
+    while(des.HasData()){
+      uint64_t offset = des.Tell();
+      uint32_t id;
+      des.PreRead(id);
+      EventUP ev = Factory<Event>::Create<Deserializer&>(id, des);
+      if(!ev)
+	EUDAQ_THROW("FileIndex: unknown event type at offset " + std::to_string(offset));
+      m_entries.push_back(MakeEntry(offset, *ev));
+    }
+    BuildLookups();
+  }
+
+  void FileIndex::BuildLookups(){
+    MakeLookup(m_entries, KeyEvent, m_lu_ev);
+    MakeLookup(m_entries, KeyTrigger, m_lu_tg);
+    MakeLookup(m_entries, KeyTimestamp, m_lu_ts);
+  }
+
+  size_t FileIndex::FindEvent(uint32_t ev_n) const{
+    return FindInLookup(m_entries, KeyEvent, m_lu_ev, ev_n);
+  }
+
+  size_t FileIndex::FindTrigger(uint32_t tg_n) const{
+    return FindInLookup(m_entries, KeyTrigger, m_lu_tg, tg_n);
+  }
+
+  size_t FileIndex::FindTimestamp(uint64_t ts) const{
+    return FindInLookup(m_entries, KeyTimestamp, m_lu_ts, ts);
+  }
+
+  size_t FileIndex::NextBore(size_t pos) const{
+    while(pos < m_entries.size() && !(m_entries[pos].flags & FLAG_BORE))
+      pos++;
+    return pos;
+  }
+}
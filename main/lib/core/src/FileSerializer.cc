@@ -1,4 +1,5 @@
 #include "eudaq/FileSerializer.hh"
+#include "eudaq/FileChunkHeader.hh"
 #include "eudaq/Logger.hh"
 #include "eudaq/Platform.hh"
 #include "eudaq/Utils.hh"
@@ -6,10 +7,32 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <iostream>
+#include <algorithm>
+#include <thread>
+#ifdef EUDAQ_WITH_ZLIB
+#include <zlib.h>
+#endif
 
 namespace eudaq {
-  FileSerializer::FileSerializer(const std::string &fname, bool overwrite)
-      : m_file(0), m_filebytes(0) {
+  FileSerializer::FileSerializer(const std::string &fname, bool overwrite,
+				 size_t buffersize, bool writebehind,
+				 int compression, unsigned threads)
+    : m_file(0), m_filebytes(0), m_zbytes(0), m_bufsize(buffersize),
+      m_writebehind(writebehind && buffersize), m_compression(compression),
+      m_max_jobs(1), m_is_writing(false), m_is_stopping(false),
+      m_write_failed(false) {
+    if (m_compression) {
+#ifndef EUDAQ_WITH_ZLIB
+      EUDAQ_THROW("FileSerializer: compression is requested, but EUDAQ is built without zlib");
+#endif
+      if (!m_bufsize)
+        m_bufsize = 4194304;
+      m_writebehind = true;
+      if (!threads)
+        threads = std::min(4u, std::max(1u, std::thread::hardware_concurrency()));
+    }
+    else
+      threads = 1;
     if (!overwrite) {
       FILE *fd = fopen(fname.c_str(), "rb");
       if (fd) {
@@ -20,23 +43,207 @@ namespace eudaq {
     m_file = fopen(fname.c_str(), "wb");
     if (!m_file)
       EUDAQ_THROWX(FileNotFoundException, "Unable to open file: " + fname);
+    if (m_bufsize) {
+      m_buf.reserve(m_bufsize);
+      if (m_writebehind) {
+        // one buffer in flight without compression, otherwise enough to
+        // keep every thread busy while the oldest chunk is written
+        if (m_compression)
+          m_max_jobs = 2 * threads;
+        for (unsigned i = 0; i < threads; i++)
+          m_fut_async.push_back(std::async(std::launch::async,
+                                           &FileSerializer::AsyncWriting, this));
+      }
+    }
   }
 
   FileSerializer::~FileSerializer() {
+    try {
+      Flush();
+    } catch (const std::exception &e) {
+      std::cerr << "FileSerializer: " << e.what() << std::endl;
+    }
+    if (!m_fut_async.empty()) {
+      std::unique_lock<std::mutex> lk(m_mx_buf);
+      m_is_stopping = true;
+      m_cv_buf.notify_all();
+      lk.unlock();
+      for (auto &fut : m_fut_async)
+        fut.get();
+    }
     if (m_file) {
       fclose(m_file);
     }
   }
 
   void FileSerializer::Serialize(const uint8_t *data, size_t len) {
+    m_filebytes += len;
+    if (!m_bufsize) {
+      WriteFile(data, len);
+      return;
+    }
+    m_buf.insert(m_buf.end(), data, data + len);
+    if (m_buf.size() >= m_bufsize)
+      WriteBuffer();
+  }
+
+  void FileSerializer::WriteFile(const uint8_t *data, size_t len) {
     size_t written =
         std::fwrite(reinterpret_cast<const char *>(data), 1, len, m_file);
-    m_filebytes += written;
     if (written != len) {
       EUDAQ_THROW("Error writing to file: " + to_string(errno) + ", " +
                   strerror(errno));
     }
   }
 
-  void FileSerializer::Flush() { fflush(m_file); }
+  // Compresses the buffer of job into a chunk, job.start is its offset in
+  // the written stream. On failure zbuf is left empty and the chunk is
+  // stored uncompressed by WriteOut.
+  void FileSerializer::Compress(Job &job) {
+    if (!m_compression)
+      return;
+#ifdef EUDAQ_WITH_ZLIB
+    uLongf len = compressBound(job.buf.size());
+    job.zbuf.resize(FileChunkHeader::SIZE + len);
+    int err = compress2(job.zbuf.data() + FileChunkHeader::SIZE, &len,
+                        job.buf.data(), job.buf.size(), m_compression);
+    if (err != Z_OK) {
+      job.zbuf.clear();
+      EUDAQ_WARN("FileSerializer: zlib error " + to_string(err) +
+                 ", the chunk is stored uncompressed");
+      return;
+    }
+    FileChunkHeader head;
+    head.codec = FileChunkHeader::CODEC_ZLIB;
+    head.start = job.start;
+    head.raw_size = uint32_t(job.buf.size());
+    head.comp_size = uint32_t(len);
+    head.Encode(job.zbuf.data());
+    job.zbuf.resize(FileChunkHeader::SIZE + len);
+#endif
+  }
+
+  void FileSerializer::WriteOut(Job &job) {
+    if (m_write_failed)
+      return;
+    try {
+      if (!m_compression) {
+        WriteFile(job.buf.data(), job.buf.size());
+        return;
+      }
+      if (job.zbuf.empty()) {
+        FileChunkHeader head;
+        head.codec = FileChunkHeader::CODEC_STORE;
+        head.start = job.start;
+        head.raw_size = uint32_t(job.buf.size());
+        head.comp_size = head.raw_size;
+        uint8_t head_raw[FileChunkHeader::SIZE];
+        head.Encode(head_raw);
+        WriteFile(head_raw, sizeof(head_raw));
+        WriteFile(job.buf.data(), job.buf.size());
+        m_zbytes += sizeof(head_raw) + job.buf.size();
+        return;
+      }
+      WriteFile(job.zbuf.data(), job.zbuf.size());
+      m_zbytes += job.zbuf.size();
+    } catch (...) {
+      m_write_failed = true;
+      throw;
+    }
+  }
+
+  void FileSerializer::WriteBuffer() {
+    if (m_buf.empty())
+      return;
+    if (!m_writebehind) {
+      WriteFile(m_buf.data(), m_buf.size());
+      m_buf.clear();
+      return;
+    }
+    std::unique_lock<std::mutex> lk(m_mx_buf);
+    WaitWriting(lk, m_max_jobs - 1);
+    m_jobs.emplace_back();
+    Job &job = m_jobs.back();
+    job.start = m_filebytes - m_buf.size();
+    job.taken = false;
+    job.done = false;
+    std::swap(job.buf, m_buf);
+    if (!m_spare.empty()) {
+      std::swap(m_buf, m_spare.back());
+      m_spare.pop_back();
+    }
+    else
+      m_buf.reserve(m_bufsize);
+    m_cv_buf.notify_all();
+  }
+
+  // Waits until at most n_left buffers are still to be written
+  void FileSerializer::WaitWriting(std::unique_lock<std::mutex> &lk, size_t n_left) {
+    m_cv_buf.wait(lk, [this, n_left]{return m_jobs.size() <= n_left;});
+    if (!m_err.empty()) {
+      std::string err;
+      std::swap(err, m_err);
+      EUDAQ_THROW(err);
+    }
+  }
+
+  bool FileSerializer::AsyncWriting() {
+    std::unique_lock<std::mutex> lk(m_mx_buf);
+    while (true) {
+      Job *job = nullptr;
+      for (auto &j : m_jobs) {
+        if (!j.taken) {
+          job = &j;
+          break;
+        }
+      }
+      bool can_write = !m_is_writing && !m_jobs.empty() && m_jobs.front().done;
+      if (can_write) {
+        // only the writing thread removes jobs, so the front one stays
+        m_is_writing = true;
+        Job &front = m_jobs.front();
+        lk.unlock();
+        try {
+          WriteOut(front);
+        } catch (const std::exception &e) {
+          lk.lock();
+          m_err = e.what();
+          lk.unlock();
+        }
+        lk.lock();
+        m_is_writing = false;
+        front.buf.clear();
+        m_spare.push_back(std::move(front.buf));
+        m_jobs.pop_front();
+        m_cv_buf.notify_all();
+      }
+      else if (job) {
+        job->taken = true;
+        lk.unlock();
+        try {
+          Compress(*job);
+        } catch (const std::exception &e) {
+          lk.lock();
+          m_err = e.what();
+          lk.unlock();
+        }
+        lk.lock();
+        job->done = true;
+        m_cv_buf.notify_all();
+      }
+      else if (m_is_stopping)
+        return true;
+      else
+        m_cv_buf.wait(lk);
+    }
+  }
+
+  void FileSerializer::Flush() {
+    WriteBuffer();
+    if (m_writebehind) {
+      std::unique_lock<std::mutex> lk(m_mx_buf);
+      WaitWriting(lk, 0);
+    }
+    fflush(m_file);
+  }
 }
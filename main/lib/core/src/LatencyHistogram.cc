@@ -0,0 +1,57 @@
+#include "eudaq/LatencyHistogram.hh"
+
+namespace eudaq {
+
+  LatencyHistogram::LatencyHistogram(){
+    Reset();
+  }
+
+  void LatencyHistogram::Add(std::chrono::steady_clock::duration d){
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    int i = 0;
+    while(i < N_BUCKETS - 1 && (int64_t(1) << i) <= us)
+      i++;
+    m_buckets[i].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void LatencyHistogram::Reset(){
+    for(auto &b: m_buckets)
+      b.store(0, std::memory_order_relaxed);
+  }
+
+  uint64_t LatencyHistogram::GetCount() const{
+    uint64_t n = 0;
+    for(auto &b: m_buckets)
+      n += b.load(std::memory_order_relaxed);
+    return n;
+  }
+
+  uint64_t LatencyHistogram::GetQuantile(double q) const{
+    uint64_t counts[N_BUCKETS];
+    uint64_t n = 0;
+    for(int i = 0; i < N_BUCKETS; i++){
+      counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+      n += counts[i];
+    }
+    if(!n)
+      return 0;
+    uint64_t rank = uint64_t(q * n);
+    if(rank >= n)
+      rank = n - 1;
+    uint64_t sum = 0;
+    for(int i = 0; i < N_BUCKETS; i++){
+      sum += counts[i];
+      if(sum > rank)
+	return uint64_t(1) << i;
+    }
+    return uint64_t(1) << (N_BUCKETS - 1);
+  }
+
+  std::string LatencyHistogram::ToString() const{
+    return "n=" + std::to_string(GetCount()) +
+      " p50<" + std::to_string(GetQuantile(0.5)) + "us" +
+      " p90<" + std::to_string(GetQuantile(0.9)) + "us" +
+      " p99<" + std::to_string(GetQuantile(0.99)) + "us" +
+      " max<" + std::to_string(GetQuantile(1.0)) + "us";
+  }
+}
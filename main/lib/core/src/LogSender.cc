@@ -4,11 +4,46 @@
 #include "eudaq/Exception.hh"
 #include "eudaq/BufferSerializer.hh"
 
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
 namespace eudaq {
 
+  namespace {
+    static const size_t LOG_QUEUE_SIZE = 10000;
+    // repeated or rate limited messages are summarised at most once per interval
+    static const std::chrono::seconds REPEAT_INTERVAL(1);
+
+    static bool is_rate_limited(int level) {
+      return level == Status::LVL_DEBUG || level == Status::LVL_EXTRA ||
+	level == Status::LVL_INFO;
+    }
+  }
+
   LogSender::LogSender()
-      : m_logclient(0), m_errlevel(Status::LVL_DEBUG),
-        m_shownotconnected(false) {}
+      : m_logclient(0), m_level(Status::LVL_INFO), m_errlevel(Status::LVL_DEBUG),
+        m_netlevel(Status::LVL_INFO), m_minlevel(Status::LVL_INFO),
+        m_shownotconnected(false), m_last_level(Status::LVL_DEBUG),
+        m_last_repeat(0), m_rate(0), m_burst(0), m_tokens(0),
+        m_rate_dropped(0), m_tp_tokens(std::chrono::steady_clock::now()),
+        m_tp_rate_report(m_tp_tokens),
+        m_stop_send(false), m_send_failed(false), m_qu_dropped(0) {}
+
+  void LogSender::UpdateMinLevel() {
+    std::lock_guard<std::recursive_mutex> lk(m_mutex);
+    int lvl = m_level;
+    if (m_logclient && m_netlevel < lvl)
+      lvl = m_netlevel;
+    m_minlevel = lvl;
+  }
+
+  void LogSender::SetRateLimit(uint32_t per_sec, uint32_t burst) {
+    std::lock_guard<std::recursive_mutex> lk(m_mutex);
+    m_rate = per_sec;
+    m_burst = burst;
+    m_tokens = burst;
+  }
 
   void LogSender::Connect(const std::string &type, const std::string &name,
                           const std::string &server) {
@@ -18,12 +53,15 @@ namespace eudaq {
     }
     isConnected = true;
     m_shownotconnected = true;
+    StopSending();
     delete m_logclient;
+    m_logclient = 0;
+    UpdateMinLevel();
     m_name = type + " " + name;
-    m_logclient = TransportClient::CreateClient(server);
+    std::unique_ptr<TransportClient> client(TransportClient::CreateClient(server));
 
     std::string packet;
-    if (!m_logclient->ReceivePacket(&packet, 1000000))
+    if (!client->ReceivePacket(&packet, 1000000))
       EUDAQ_THROW("No response from LogCollector server");
     size_t i0 = 0, i1 = packet.find(' ');
     if (i1 == std::string::npos)
@@ -51,19 +89,78 @@ namespace eudaq {
     if (part != "LogCollector")
       EUDAQ_THROW("Invalid response from LogCollector server, part=" + part);
 
-    m_logclient->SendPacket("OK EUDAQ LOG " + m_name);
+    client->SendPacket("OK EUDAQ LOG " + m_name);
     packet = "";
-    if (!m_logclient->ReceivePacket(&packet, 1000000))
+    if (!client->ReceivePacket(&packet, 1000000))
       EUDAQ_THROW("No response from LogCollector server");
     i1 = packet.find(' ');
     if (std::string(packet, 0, i1) != "OK")
       EUDAQ_THROW("Connection refused by LogCollector server: " + packet);
+
+    m_logclient = client.release();
+    std::unique_lock<std::mutex> lk_qu(m_mx_qu);
+    m_stop_send = false;
+    m_send_failed = false;
+    lk_qu.unlock();
+    m_th_send = std::thread(&LogSender::AsyncSending, this);
+    UpdateMinLevel();
   }
 
   void LogSender::Disconnect() {
     std::lock_guard<std::recursive_mutex> lk(m_mutex);
+    FlushPending(std::cout, std::cerr);
+    StopSending();
     delete m_logclient;
+    m_logclient = 0;
     isConnected = false;
+    UpdateMinLevel();
+  }
+
+  void LogSender::StopSending() {
+    std::unique_lock<std::mutex> lk(m_mx_qu);
+    m_stop_send = true;
+    m_cv_qu.notify_all();
+    lk.unlock();
+    if (m_th_send.joinable())
+      m_th_send.join();
+  }
+
+  void LogSender::AsyncSending() {
+    while (true) {
+      std::unique_lock<std::mutex> lk(m_mx_qu);
+      if (!m_cv_qu.wait_for(lk, REPEAT_INTERVAL,
+			    [this]{return m_stop_send || !m_qu.empty();})) {
+	// idle: report repetitions and rate limited messages nobody followed
+	lk.unlock();
+	std::unique_lock<std::recursive_mutex> lk_log(m_mutex, std::try_to_lock);
+	if (lk_log && std::chrono::steady_clock::now() - m_tp_last >= REPEAT_INTERVAL)
+	  FlushPending(std::cout, std::cerr);
+	continue;
+      }
+      if (m_qu.empty())
+	return;
+      LogMessage msg = std::move(m_qu.front());
+      m_qu.pop_front();
+      lk.unlock();
+      BufferSerializer ser;
+      msg.Serialize(ser);
+      try {
+        m_logclient->SendPacket(ser);
+	continue;
+      } catch (const eudaq::Exception &e) {
+        std::cerr << "Caught exception trying to log message '" << msg
+		  << "': " << e.what() << std::endl;
+      } catch (...) {
+        std::cerr << "Caught exception trying to log message '" << msg << "'! "
+		  << std::endl;
+      }
+      // stop forwarding, the client is deleted at the next (Dis)Connect
+      std::cerr << " -> will stop sending to the LogCollector" << std::endl;
+      lk.lock();
+      m_send_failed = true;
+      m_qu.clear();
+      return;
+    }
   }
 
   void LogSender::SendLogMessage(const LogMessage &msg) {
@@ -73,8 +170,79 @@ namespace eudaq {
 
   void LogSender::SendLogMessage(const LogMessage &msg, std::ostream &out,
                                  std::ostream &error_out) {
+    if (!IsLogged(msg.GetLevel()))
+      return;
     std::lock_guard<std::recursive_mutex> lk(m_mutex);
-    if (msg.GetLevel() >= m_level) {
+    if (Admit(msg, out, error_out))
+      Emit(msg, out, error_out);
+  }
+
+  // Collapses immediate repetitions and applies the rate limit. Returns
+  // false if the message is suppressed.
+  bool LogSender::Admit(const LogMessage &msg, std::ostream &out,
+			std::ostream &error_out) {
+    auto now = std::chrono::steady_clock::now();
+    std::string key = std::to_string(msg.GetLevel()) + msg.GetMessage();
+    if (key == m_last_key) {
+      m_last_repeat++;
+      if (now - m_tp_last >= REPEAT_INTERVAL)
+	FlushRepeat(out, error_out);
+      return false;
+    }
+    if (m_last_repeat)
+      FlushRepeat(out, error_out);
+    m_last_key = key;
+    m_last_level = msg.GetLevel();
+    m_tp_last = now;
+
+    if (m_rate && is_rate_limited(msg.GetLevel())) {
+      double dt = std::chrono::duration<double>(now - m_tp_tokens).count();
+      m_tp_tokens = now;
+      m_tokens = std::min<double>(m_burst, m_tokens + dt * m_rate);
+      if (m_tokens < 1) {
+	m_rate_dropped++;
+	return false;
+      }
+      m_tokens -= 1;
+    }
+    if (m_rate_dropped && now - m_tp_rate_report >= REPEAT_INTERVAL) {
+      Emit(LogMessage(std::to_string(m_rate_dropped) +
+		      " log messages suppressed by the rate limit",
+		      Status::LVL_WARN), out, error_out);
+      m_rate_dropped = 0;
+      m_tp_rate_report = now;
+    }
+    return true;
+  }
+
+  void LogSender::Flush() {
+    std::lock_guard<std::recursive_mutex> lk(m_mutex);
+    FlushPending(std::cout, std::cerr);
+  }
+
+  void LogSender::FlushPending(std::ostream &out, std::ostream &error_out) {
+    if (m_last_repeat)
+      FlushRepeat(out, error_out);
+    if (m_rate_dropped) {
+      Emit(LogMessage(std::to_string(m_rate_dropped) +
+		      " log messages suppressed by the rate limit",
+		      Status::LVL_WARN), out, error_out);
+      m_rate_dropped = 0;
+      m_tp_rate_report = std::chrono::steady_clock::now();
+    }
+  }
+
+  void LogSender::FlushRepeat(std::ostream &out, std::ostream &error_out) {
+    Emit(LogMessage("Last message repeated " + std::to_string(m_last_repeat) +
+		    " times", static_cast<Status::Level>(m_last_level)),
+	 out, error_out);
+    m_last_repeat = 0;
+    m_tp_last = std::chrono::steady_clock::now();
+  }
+
+  void LogSender::Emit(const LogMessage &msg, std::ostream &out,
+		       std::ostream &error_out) {
+    if (Rank(msg.GetLevel()) >= m_level) {
       if (msg.GetLevel() >= m_errlevel) {
         if (m_name != "")
           error_out << "[" << m_name << "] ";
@@ -89,26 +257,28 @@ namespace eudaq {
     if (!m_logclient) {
       if (m_shownotconnected)
         error_out << "### Log message triggered but Logger not connected ###\n";
-    } else {
-      BufferSerializer ser;
-      msg.Serialize(ser);
-      try {
-        m_logclient->SendPacket(ser);
-      } catch (const eudaq::Exception &e) {
-        error_out << "Caught exception trying to log message '" << msg
-                  << "': " << e.what() << std::endl;
-        error_out << " -> will delete LogClient" << std::endl;
-        delete m_logclient;
-        m_logclient = 0;
-      } catch (...) {
-        error_out << "Caught exception trying to log message '" << msg << "'! "
-                  << std::endl;
-        error_out << " -> will delete LogClient" << std::endl;
-        delete m_logclient;
-        m_logclient = 0;
+    } else if (Rank(msg.GetLevel()) >= m_netlevel) {
+      std::unique_lock<std::mutex> lk(m_mx_qu);
+      if (m_send_failed)
+	return;
+      if (m_qu.size() >= LOG_QUEUE_SIZE) {
+	m_qu_dropped++;
+	return;
       }
+      if (m_qu_dropped) {
+	m_qu.emplace_back(std::to_string(m_qu_dropped) +
+			  " log messages dropped, the LogCollector is too slow",
+			  Status::LVL_WARN);
+	m_qu_dropped = 0;
+      }
+      m_qu.push_back(msg);
+      m_cv_qu.notify_one();
     }
   }
 
-  LogSender::~LogSender() { delete m_logclient; }
+  LogSender::~LogSender() {
+    Flush();
+    StopSending();
+    delete m_logclient;
+  }
 }
@@ -0,0 +1,131 @@
+#include "eudaq/MmapFileDeserializer.hh"
+#include "eudaq/Serializer.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Utils.hh"
+
+#if !(EUDAQ_PLATFORM_IS(WIN32) || EUDAQ_PLATFORM_IS(MINGW))
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+namespace eudaq {
+
+  // Maps the len bytes of the file from start, which is page aligned
+  struct MmapFileDeserializer::Mapping {
+    Mapping(int fd, uint64_t from, size_t len) : addr(nullptr), start(from), size(len) {
+      void *p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(from));
+      if (p == MAP_FAILED)
+        EUDAQ_THROWX(FileReadException, std::string("mmap failed: ") + strerror(errno));
+      madvise(p, len, MADV_SEQUENTIAL);
+      addr = static_cast<const uint8_t *>(p);
+    }
+    ~Mapping() { munmap(const_cast<uint8_t *>(addr), size); }
+    const uint8_t *addr;
+    uint64_t start;
+    size_t size;
+  };
+
+  MmapFileDeserializer::MmapFileDeserializer(const std::string &fname, bool faileof)
+    : m_filename(fname), m_fd(-1), m_faileof(faileof), m_offset(0) {
+    m_fd = open(m_filename.c_str(), O_RDONLY);
+    if (m_fd < 0)
+      EUDAQ_THROWX(FileNotFoundException, "Unable to open file: " + fname);
+    Remap();
+  }
+
+  MmapFileDeserializer::~MmapFileDeserializer() {
+    // views handed out by ReadShared keep their mapping alive on their own
+    m_map.reset();
+    if (m_fd >= 0)
+      close(m_fd);
+  }
+
+  // Maps the file from the page of the current position to its end. The
+  // previous mapping stays valid as long as events refer to it, but only
+  // overlaps with the new one from the current position on, so following a
+  // growing file maps each part of it about once.
+  bool MmapFileDeserializer::Remap() {
+    struct stat st;
+    if (fstat(m_fd, &st) != 0)
+      EUDAQ_THROWX(FileReadException, "Unable to stat file: " + m_filename);
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t start = m_offset - m_offset % page;
+    if (size <= start)
+      return false;
+    if (m_map && start >= m_map->start && size <= m_map->start + m_map->size)
+      return false;
+    m_map = std::make_shared<const Mapping>(m_fd, start, static_cast<size_t>(size - start));
+    return true;
+  }
+
+  bool MmapFileDeserializer::Covers(uint64_t offset, size_t len) const {
+    return m_map && offset >= m_map->start && offset + len <= m_map->start + m_map->size;
+  }
+
+  const uint8_t *MmapFileDeserializer::Address(uint64_t offset) const {
+    return m_map->addr + (offset - m_map->start);
+  }
+
+  bool MmapFileDeserializer::HasData() {
+    if (Covers(m_offset, 1))
+      return true;
+    Remap();
+    return Covers(m_offset, 1);
+  }
+
+  void MmapFileDeserializer::Require(size_t len) {
+    int n_tries = 0;
+    const int max_tries = 1000;
+    while (!Covers(m_offset, len)) {
+      if (Remap())
+        continue;
+      if (m_faileof)
+        throw FileReadException("End of file '" + m_filename + "' encountered");
+      if (m_interrupting) {
+        m_interrupting = false;
+        throw InterruptedException();
+      }
+      if (++n_tries >= max_tries) {
+        EUDAQ_THROWX(FileReadException,
+                     "Error reading from file '" + m_filename +
+                     "': too many failed attempts (reading 0 bytes)");
+      }
+      mSleep(10);
+    }
+  }
+
+  void MmapFileDeserializer::Seek(uint64_t offset) {
+    m_offset = offset;
+  }
+
+  void MmapFileDeserializer::Deserialize(uint8_t *data, size_t len) {
+    if (!len)
+      return;
+    Require(len);
+    memcpy(data, Address(m_offset), len);
+    m_offset += len;
+  }
+
+  void MmapFileDeserializer::PreDeserialize(uint8_t *data, size_t len) {
+    if (!len)
+      return;
+    Require(len);
+    memcpy(data, Address(m_offset), len);
+  }
+
+  const uint8_t *MmapFileDeserializer::DeserializeShared(size_t len,
+							 std::shared_ptr<const void> &owner) {
+    Require(len);
+    const uint8_t *view = Address(m_offset);
+    m_offset += len;
+    owner = m_map;
+    return view;
+  }
+}
+
+#endif
@@ -68,6 +68,8 @@ namespace eudaq {
     auto conf = GetConfiguration();
     try {
       SetStatus(Status::STATE_UNCONF, "Configuring");
+      SetQueue(conf->Get("EUDAQ_DATA_QUEUE_SIZE", 50000),
+	       conf->Get("EUDAQ_DATA_QUEUE_POLICY", "drop-oldest"));
       DoConfigure();
       CommandReceiver::OnConfigure();
     }catch (const Exception &e) {
@@ -128,12 +130,15 @@ namespace eudaq {
     
   void Monitor::OnStatus(){
     SetStatusTag("EventN", std::to_string(m_evt_c));
+    SetStatusTag("QueueDroppedN", std::to_string(GetQueueDropped()));
+    SetStatusTag("QueueHighWater", std::to_string(GetQueueHighWater()));
     DoStatus();
     CommandReceiver::OnStatus();
   }
 
   void Monitor::OnReceive(ConnectionSPC id, EventSP ev){
     m_evt_c ++;
+    m_run_blocks.Process(ev);
     DoReceive(ev);
   }
   
@@ -1,13 +1,24 @@
 #include "eudaq/FileDeserializer.hh"
 #include "eudaq/FileReader.hh"
+#include "eudaq/FileIndex.hh"
+#include "eudaq/RunBlockCache.hh"
+#include "eudaq/Logger.hh"
 
 class NativeFileReader : public eudaq::FileReader {
 public:
   NativeFileReader(const std::string& filename);
   eudaq::EventSPC GetNextEvent()override;
+  bool SeekEvent(uint32_t ev_n) override;
+  bool SeekTrigger(uint32_t tg_n) override;
+  bool SeekTimestamp(uint64_t ts) override;
 private:
+  void Open();
+  bool SeekIndex(size_t i);
   std::unique_ptr<eudaq::FileDeserializer> m_des;
+  std::unique_ptr<eudaq::FileIndex> m_idx;
   std::string m_filename;
+  eudaq::RunBlockCache m_run_blocks;
+  bool m_bores_read = false;
 };
 
 namespace{
@@ -15,18 +26,27 @@ namespace{
     Register<NativeFileReader, std::string&>(eudaq::cstr2hash("native"));
   auto dummy1 = eudaq::Factory<eudaq::FileReader>::
     Register<NativeFileReader, std::string&&>(eudaq::cstr2hash("native"));
+  // compressed files are recognised and decompressed by FileDeserializer
+  auto dummy2 = eudaq::Factory<eudaq::FileReader>::
+    Register<NativeFileReader, std::string&>(eudaq::cstr2hash("nativez"));
+  auto dummy3 = eudaq::Factory<eudaq::FileReader>::
+    Register<NativeFileReader, std::string&&>(eudaq::cstr2hash("nativez"));
 }
 
 NativeFileReader::NativeFileReader(const std::string& filename)
   :m_filename(filename){    
 }
 
-eudaq::EventSPC NativeFileReader::GetNextEvent(){
+void NativeFileReader::Open(){
   if(!m_des){
     m_des.reset(new eudaq::FileDeserializer(m_filename));
     if(!m_des)
       EUDAQ_THROW("unable to open file: " + m_filename);
   }
+}
+
+eudaq::EventSPC NativeFileReader::GetNextEvent(){
+  Open();
   eudaq::EventUP ev;
   uint32_t id;
   
@@ -34,7 +54,65 @@ eudaq::EventSPC NativeFileReader::GetNextEvent(){
     m_des->PreRead(id);
     ev = eudaq::Factory<eudaq::Event>::
       Create<eudaq::Deserializer&>(id, *m_des);
-    return std::move(ev);
+    eudaq::EventSP evsp = std::move(ev);
+    m_run_blocks.Process(evsp);
+    return evsp;
   }  else  return nullptr;
   
 }
+
+bool NativeFileReader::SeekIndex(size_t i){
+  if(!m_idx){
+    m_idx.reset(new eudaq::FileIndex);
+    if(!m_idx->Load(eudaq::FileIndex::IndexPath(m_filename))){
+      EUDAQ_INFO("NativeFileReader: no index file for " + m_filename);
+    }
+  }
+  if(!m_idx->Size())
+    return false;
+  // the index of a file still being written may lag behind the data, so
+  // continue from its last entry if the target is not indexed (yet)
+  if(i >= m_idx->Size())
+    i = m_idx->Size() - 1;
+  Open();
+  // a seek skips the BOREs, read the run-constant blocks from every BORE
+  // in the index once, a slow stream's BORE may follow other streams' data
+  if(!m_bores_read){
+    m_bores_read = true;
+    if(m_idx->HasFlags()){
+      for(size_t j = m_idx->NextBore(0); j < m_idx->Size(); j = m_idx->NextBore(j + 1)){
+	m_des->Seek(m_idx->At(j).offset);
+	GetNextEvent();
+      }
+    }
+    else if(m_des->Tell() == 0){
+      EUDAQ_WARN("NativeFileReader: the index of " + m_filename + " has no BORE marks,"
+		 " only the leading BOREs are read, rebuild it with euCliReader -x");
+      while(m_des->HasData()){
+	auto ev = GetNextEvent();
+	if(!ev->HasBORE())
+	  break;
+      }
+    }
+  }
+  m_des->Seek(m_idx->At(i).offset);
+  return true;
+}
+
+bool NativeFileReader::SeekEvent(uint32_t ev_n){
+  if(!m_idx && !SeekIndex(0))
+    return false;
+  return SeekIndex(m_idx->FindEvent(ev_n));
+}
+
+bool NativeFileReader::SeekTrigger(uint32_t tg_n){
+  if(!m_idx && !SeekIndex(0))
+    return false;
+  return SeekIndex(m_idx->FindTrigger(tg_n));
+}
+
+bool NativeFileReader::SeekTimestamp(uint64_t ts){
+  if(!m_idx && !SeekIndex(0))
+    return false;
+  return SeekIndex(m_idx->FindTimestamp(ts));
+}
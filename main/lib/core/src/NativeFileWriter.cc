@@ -1,16 +1,37 @@
 #include "eudaq/FileNamer.hh"
 #include "eudaq/FileWriter.hh"
 #include "eudaq/FileSerializer.hh"
+#include "eudaq/FileIndex.hh"
+
+#include <chrono>
 
 class NativeFileWriter : public eudaq::FileWriter {
 public:
-  NativeFileWriter(const std::string &patt);
+  NativeFileWriter(const std::string &patt, bool compress = false);
   void WriteEvent(eudaq::EventSPC ev) override;
+  void Flush() override;
+  void FlushIfDue() override;
   uint64_t FileBytes() const override;
 private:
+  void OpenFile(uint32_t run_n);
+  bool IsFlushDue() const;
   std::unique_ptr<eudaq::FileSerializer> m_ser;
+  std::unique_ptr<eudaq::FileSerializer> m_idx;
   std::string m_filepattern;
   uint32_t m_run_n;
+  uint64_t m_flush_bytes;
+  uint32_t m_flush_events;
+  uint32_t m_flush_ms;
+  uint64_t m_bytes_flushed;
+  uint32_t m_events_unflushed;
+  std::chrono::steady_clock::time_point m_tp_flushed;
+  bool m_compress;
+};
+
+// Chunked variant compressed by a pool of writing threads, read by NativeFileReader
+class NativeZFileWriter : public NativeFileWriter {
+public:
+  NativeZFileWriter(const std::string &patt) :NativeFileWriter(patt, true){}
 };
 
 namespace{
@@ -18,33 +39,112 @@ namespace{
     Register<NativeFileWriter, std::string&>(eudaq::cstr2hash("native"));
   auto dummy1 = eudaq::Factory<eudaq::FileWriter>::
     Register<NativeFileWriter, std::string&&>(eudaq::cstr2hash("native"));
+  auto dummy2 = eudaq::Factory<eudaq::FileWriter>::
+    Register<NativeZFileWriter, std::string&>(eudaq::cstr2hash("nativez"));
+  auto dummy3 = eudaq::Factory<eudaq::FileWriter>::
+    Register<NativeZFileWriter, std::string&&>(eudaq::cstr2hash("nativez"));
 }
 
-NativeFileWriter::NativeFileWriter(const std::string &patt){
+NativeFileWriter::NativeFileWriter(const std::string &patt, bool compress)
+  :m_run_n(0), m_flush_bytes(0), m_flush_events(0), m_flush_ms(0),
+   m_bytes_flushed(0), m_events_unflushed(0), m_compress(compress){
   m_filepattern = patt;
 }
-  
+
+void NativeFileWriter::OpenFile(uint32_t run_n){
+  std::time_t time_now = std::time(nullptr);
+  char time_buff[13];
+  time_buff[12] = 0;
+  std::strftime(time_buff, sizeof(time_buff),
+		"%y%m%d%H%M%S", std::localtime(&time_now));
+  std::string time_str(time_buff);
+
+  // without any EUDAQ_FW_FLUSH_* limit every event is flushed to the file
+  // the buffer is the chunk of a compressed file
+  uint64_t buf_bytes = m_compress ? 4194304 : 1048576;
+  bool write_behind = false;
+  int level = m_compress ? 1 : 0;
+  uint32_t threads = 0;
+  auto conf = GetConfiguration();
+  if(conf){
+    buf_bytes = conf->Get("EUDAQ_FW_BUFFER_BYTES", buf_bytes);
+    write_behind = conf->Get("EUDAQ_FW_WRITE_BEHIND", 0);
+    m_flush_bytes = conf->Get("EUDAQ_FW_FLUSH_BYTES", m_flush_bytes);
+    m_flush_events = conf->Get("EUDAQ_FW_FLUSH_EVENTS", m_flush_events);
+    m_flush_ms = conf->Get("EUDAQ_FW_FLUSH_MS", m_flush_ms);
+    if(m_compress){
+      level = conf->Get("EUDAQ_FW_COMPRESSION_LEVEL", level);
+      threads = conf->Get("EUDAQ_FW_COMPRESSION_THREADS", threads);
+    }
+  }
+  // every flush closes a chunk, a chunk per event would hardly be compressed
+  if(m_compress && !m_flush_bytes && !m_flush_events && !m_flush_ms)
+    m_flush_ms = 1000;
+  bool with_index = conf ? conf->Get("EUDAQ_FW_INDEX", 1) : true;
+  std::string filename = eudaq::FileNamer(m_filepattern).
+    Set('X', m_compress ? ".rawz" : ".raw").
+    Set('R', run_n).
+    Set('D', time_str);
+  m_idx.reset();
+  m_ser.reset();
+  m_ser.reset(new eudaq::FileSerializer(filename, false, buf_bytes, write_behind,
+					 level, threads));
+  if(with_index){
+    m_idx.reset(new eudaq::FileSerializer(eudaq::FileIndex::IndexPath(filename),
+					  false, 65536));
+    eudaq::FileIndex::WriteHeader(*m_idx);
+  }
+  m_run_n = run_n;
+  m_bytes_flushed = 0;
+  m_events_unflushed = 0;
+  m_tp_flushed = std::chrono::steady_clock::now();
+}
+
+bool NativeFileWriter::IsFlushDue() const {
+  if(!m_flush_bytes && !m_flush_events && !m_flush_ms)
+    return true;
+  if(m_flush_bytes && m_ser->StreamBytes() - m_bytes_flushed >= m_flush_bytes)
+    return true;
+  if(m_flush_events && m_events_unflushed >= m_flush_events)
+    return true;
+  if(m_flush_ms && std::chrono::steady_clock::now() - m_tp_flushed >=
+     std::chrono::milliseconds(m_flush_ms))
+    return true;
+  return false;
+}
+
 void NativeFileWriter::WriteEvent(eudaq::EventSPC ev) {
   uint32_t run_n = ev->GetRunN();
   if(!m_ser || m_run_n != run_n){
-    std::time_t time_now = std::time(nullptr);
-    char time_buff[13];
-    time_buff[12] = 0;
-    std::strftime(time_buff, sizeof(time_buff),
-		  "%y%m%d%H%M%S", std::localtime(&time_now));
-    std::string time_str(time_buff);
-    m_ser.reset(new eudaq::FileSerializer((eudaq::FileNamer(m_filepattern).
-					   Set('X', ".raw").
-					   Set('R', run_n).
-					   Set('D', time_str))));
-    m_run_n = run_n;
+    OpenFile(run_n);
   }
   if(!m_ser)
     EUDAQ_THROW("NativeFileWriter: Attempt to write unopened file");
-  m_ser->write(*(ev.get())); //TODO: Serializer accepts EventSPC
+  if(m_idx)
+    eudaq::FileIndex::WriteEntry(*m_idx, eudaq::FileIndex::MakeEntry(m_ser->StreamBytes(), *ev));
+  auto buf = ev->GetSerialized();
+  m_ser->append(reinterpret_cast<const uint8_t*>(buf->data()), buf->size());
+  m_events_unflushed ++;
+  if(ev->IsEORE() || IsFlushDue())
+    Flush();
+}
+
+void NativeFileWriter::Flush() {
+  if(!m_ser)
+    return;
   m_ser->Flush();
+  if(m_idx)
+    m_idx->Flush();
+  m_bytes_flushed = m_ser->StreamBytes();
+  m_events_unflushed = 0;
+  m_tp_flushed = std::chrono::steady_clock::now();
+}
+
+void NativeFileWriter::FlushIfDue() {
+  if(m_ser && m_events_unflushed && IsFlushDue())
+    Flush();
 }
-  
+
 uint64_t NativeFileWriter::FileBytes() const {
   return m_ser ?m_ser->FileBytes() :0;
 }
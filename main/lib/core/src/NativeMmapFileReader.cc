@@ -0,0 +1,110 @@
+#include "eudaq/MmapFileDeserializer.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/FileIndex.hh"
+#include "eudaq/RunBlockCache.hh"
+#include "eudaq/Logger.hh"
+
+#if !(EUDAQ_PLATFORM_IS(WIN32) || EUDAQ_PLATFORM_IS(MINGW))
+
+// Native format reader on top of a memory-mapped file. Event data blocks are
+// views into the mapping, the file may still be written while being read.
+class NativeMmapFileReader : public eudaq::FileReader {
+public:
+  NativeMmapFileReader(const std::string& filename);
+  eudaq::EventSPC GetNextEvent()override;
+  bool SeekEvent(uint32_t ev_n) override;
+  bool SeekTrigger(uint32_t tg_n) override;
+  bool SeekTimestamp(uint64_t ts) override;
+private:
+  void Open();
+  bool SeekIndex(size_t i);
+  std::unique_ptr<eudaq::MmapFileDeserializer> m_des;
+  std::unique_ptr<eudaq::FileIndex> m_idx;
+  std::string m_filename;
+  eudaq::RunBlockCache m_run_blocks;
+  bool m_bores_read = false;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::FileReader>::
+    Register<NativeMmapFileReader, std::string&>(eudaq::cstr2hash("native-mmap"));
+  auto dummy1 = eudaq::Factory<eudaq::FileReader>::
+    Register<NativeMmapFileReader, std::string&&>(eudaq::cstr2hash("native-mmap"));
+}
+
+NativeMmapFileReader::NativeMmapFileReader(const std::string& filename)
+  :m_filename(filename){
+}
+
+void NativeMmapFileReader::Open(){
+  if(!m_des)
+    m_des.reset(new eudaq::MmapFileDeserializer(m_filename));
+}
+
+eudaq::EventSPC NativeMmapFileReader::GetNextEvent(){
+  Open();
+  if(!m_des->HasData())
+    return nullptr;
+  uint32_t id;
+  m_des->PreRead(id);
+  eudaq::EventSP ev = eudaq::Factory<eudaq::Event>::
+    Create<eudaq::Deserializer&>(id, *m_des);
+  m_run_blocks.Process(ev);
+  return ev;
+}
+
+bool NativeMmapFileReader::SeekIndex(size_t i){
+  if(!m_idx){
+    m_idx.reset(new eudaq::FileIndex);
+    if(!m_idx->Load(eudaq::FileIndex::IndexPath(m_filename))){
+      EUDAQ_INFO("NativeMmapFileReader: no index file for " + m_filename);
+    }
+  }
+  if(!m_idx->Size())
+    return false;
+  if(i >= m_idx->Size())
+    i = m_idx->Size() - 1;
+  Open();
+  // a seek skips the BOREs, read the run-constant blocks from every BORE
+  // in the index once, a slow stream's BORE may follow other streams' data
+  if(!m_bores_read){
+    m_bores_read = true;
+    if(m_idx->HasFlags()){
+      for(size_t j = m_idx->NextBore(0); j < m_idx->Size(); j = m_idx->NextBore(j + 1)){
+	m_des->Seek(m_idx->At(j).offset);
+	GetNextEvent();
+      }
+    }
+    else if(m_des->Tell() == 0){
+      EUDAQ_WARN("NativeMmapFileReader: the index of " + m_filename + " has no BORE marks,"
+		 " only the leading BOREs are read, rebuild it with euCliReader -x");
+      while(m_des->HasData()){
+	auto ev = GetNextEvent();
+	if(!ev->HasBORE())
+	  break;
+      }
+    }
+  }
+  m_des->Seek(m_idx->At(i).offset);
+  return true;
+}
+
+bool NativeMmapFileReader::SeekEvent(uint32_t ev_n){
+  if(!m_idx && !SeekIndex(0))
+    return false;
+  return SeekIndex(m_idx->FindEvent(ev_n));
+}
+
+bool NativeMmapFileReader::SeekTrigger(uint32_t tg_n){
+  if(!m_idx && !SeekIndex(0))
+    return false;
+  return SeekIndex(m_idx->FindTrigger(tg_n));
+}
+
+bool NativeMmapFileReader::SeekTimestamp(uint64_t ts){
+  if(!m_idx && !SeekIndex(0))
+    return false;
+  return SeekIndex(m_idx->FindTimestamp(ts));
+}
+
+#endif
@@ -9,7 +9,8 @@ namespace eudaq {
   Factory<Producer>::Instance<const std::string&, const std::string&>();  
   
   Producer::Producer(const std::string &name, const std::string &runcontrol)
-    : CommandReceiver("Producer", name, runcontrol){
+    : CommandReceiver("Producer", name, runcontrol),
+      m_send_bytes_last(0){
     m_evt_c = 0;
     m_pdc_n = str2hash(GetFullName());
   }
@@ -43,6 +44,7 @@ namespace eudaq {
       if(!conf)
 	EUDAQ_THROW("No Configuration Section for OnConfigure");
       m_pdc_n = conf->Get("EUDAQ_ID", m_pdc_n);
+      m_run_blocks.clear();
       DoConfigure();
       CommandReceiver::OnConfigure();
     }catch (const std::exception &e) {
@@ -61,6 +63,8 @@ namespace eudaq {
 	EUDAQ_THROW("OnStartRun can not be called unless in STATE_CONF");
       std::map<std::string, std::shared_ptr<DataSender>> senders;
       std::string dc_str = GetConfiguration()->Get("EUDAQ_DC", "");
+      size_t qu_size = GetConfiguration()->Get("EUDAQ_DATA_SEND_QUEUE_SIZE", 10000);
+      std::string qu_policy = GetConfiguration()->Get("EUDAQ_DATA_SEND_QUEUE_POLICY", "block");
       std::vector<std::string> col_dc_name = split(dc_str, ";,", true);
       std::string cur_backup = GetConfiguration()->GetCurrentSectionName();
       GetConfiguration()->SetSection("");
@@ -69,12 +73,15 @@ namespace eudaq {
 	if(!dc_addr.empty()){
 	  senders[dc_addr]
 	    = std::unique_ptr<DataSender>(new DataSender("Producer", GetName()));
+	  senders[dc_addr]->SetQueue(qu_size, qu_policy);
 	  senders[dc_addr]->Connect(dc_addr);
 	}
       }
       GetConfiguration()->SetSection(cur_backup);
       std::unique_lock<std::mutex> lk(m_mtx_sender);
       m_senders = senders;
+      m_send_bytes_last = 0;
+      m_tp_send_last = std::chrono::steady_clock::now();
       lk.unlock();
       m_evt_c = 0;
       SetStatusTag("EventN", "0");
@@ -97,7 +104,10 @@ namespace eudaq {
       DoStopRun();      
       CommandReceiver::OnStopRun();
       std::unique_lock<std::mutex> lk(m_mtx_sender);
+      auto senders = std::move(m_senders);
       m_senders.clear();
+      lk.unlock();
+      senders.clear(); // waits until the queued events are sent
     } catch (const std::exception &e) {
       printf("Caught exception: %s\n", e.what());
       SetStatus(Status::STATE_ERROR, "Stop Error");
@@ -110,6 +120,7 @@ namespace eudaq {
   void Producer::OnReset(){
     EUDAQ_INFO(GetFullName() + " is to be reset...");
     try{
+      m_run_blocks.clear();
       DoReset();
       CommandReceiver::OnReset();
       std::unique_lock<std::mutex> lk(m_mtx_sender);
@@ -140,6 +151,26 @@ namespace eudaq {
   void Producer::OnStatus(){
     try{
       SetStatusTag("EventN", std::to_string(m_evt_c));
+      size_t qu_n = 0;
+      uint64_t dropped = 0;
+      uint64_t bytes = 0;
+      std::unique_lock<std::mutex> lk(m_mtx_sender);
+      for(auto &e: m_senders){
+	qu_n += e.second->GetQueueDepth();
+	dropped += e.second->GetQueueDropped();
+	bytes += e.second->GetBytesSent();
+      }
+      auto tp_now = std::chrono::steady_clock::now();
+      double dt = std::chrono::duration<double>(tp_now - m_tp_send_last).count();
+      uint64_t bps = 0;
+      if(dt > 0 && bytes >= m_send_bytes_last)
+	bps = static_cast<uint64_t>((bytes - m_send_bytes_last) / dt);
+      m_send_bytes_last = bytes;
+      m_tp_send_last = tp_now;
+      lk.unlock();
+      SetStatusTag("SendQueueN", std::to_string(qu_n));
+      SetStatusTag("SendDroppedN", std::to_string(dropped));
+      SetStatusTag("SendBytesPerSec", std::to_string(bps));
       DoStatus();
     }catch (const std::exception &e) {
       printf("Caught exception: %s\n", e.what());
@@ -151,16 +182,53 @@ namespace eudaq {
   }
   
   void Producer::SendEvent(EventSP ev){
+    StampEvent(ev);
+    DispatchEvent(ev);
+  }
+
+  void Producer::SendEvents(const std::vector<EventSP> &evs){
+    if(evs.size() < 2){
+      for(auto &ev: evs)
+	SendEvent(ev);
+      return;
+    }
+    auto batch = Event::MakeShared("EventBatch");
+    batch->SetFlagPacket();
+    batch->SetRunN(GetRunNumber());
+    batch->SetDeviceN(m_pdc_n);
+    for(auto &ev: evs){
+      StampEvent(ev);
+      batch->AddSubEvent(ev);
+    }
+    DispatchEvent(batch);
+  }
+
+  void Producer::SetRunBlock(uint32_t id, const std::vector<uint8_t> &data){
+    m_run_blocks[id] = data;
+  }
+
+  void Producer::StampEvent(EventSP ev){
     if(ev->IsBORE()){
       if(GetConfiguration())
 	ev->SetTag("EUDAQ_CONFIG", to_string(*GetConfiguration()));
       if(GetInitConfiguration())
 	ev->SetTag("EUDAQ_CONFIG_INIT", to_string(*GetInitConfiguration()));
+      if(!m_run_blocks.empty()){
+	std::string ids;
+	for(auto &e: m_run_blocks){
+	  ev->AddBlock(e.first, e.second);
+	  ids += (ids.empty() ? "" : ",") + std::to_string(e.first);
+	}
+	ev->SetTag("EUDAQ_RUN_BLOCKS", ids);
+      }
     }
     ev->SetRunN(GetRunNumber());
     ev->SetEventN(m_evt_c);
     m_evt_c ++;
     ev->SetDeviceN(m_pdc_n);
+  }
+
+  void Producer::DispatchEvent(EventSP ev){
     std::unique_lock<std::mutex> lk(m_mtx_sender);
     auto senders = m_senders; //hold on the ptrs
     lk.unlock();
@@ -0,0 +1,31 @@
+#include "eudaq/RunBlockCache.hh"
+
+namespace eudaq {
+
+  void RunBlockCache::Process(EventSP ev){
+    auto key = std::make_pair(ev->GetStreamN(), ev->GetExtendWord());
+    if(ev->IsBORE()){
+      auto ids = ev->GetRunBlockNumList();
+      if(ids.empty())
+	m_blocks.erase(key);
+      else{
+	std::shared_ptr<std::map<uint32_t, EventBlock>> blocks(new std::map<uint32_t, EventBlock>);
+	for(auto id: ids)
+	  (*blocks)[id] = ev->GetBlockView(id);
+	m_blocks[key] = blocks;
+      }
+    }
+    else{
+      auto it = m_blocks.find(key);
+      if(it != m_blocks.end())
+	ev->SetRunBlocks(it->second);
+    }
+    // the sub-events were made along with ev and are not shared either
+    for(auto &subev: ev->GetSubEvents())
+      Process(std::const_pointer_cast<Event>(subev));
+  }
+
+  void RunBlockCache::Clear(){
+    m_blocks.clear();
+  }
+}
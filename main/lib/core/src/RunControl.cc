@@ -22,6 +22,19 @@ namespace eudaq {
       Register<RunControl, const std::string&>(RunControl::m_id_factory);
     auto dummy1 = Factory<RunControl>::
       Register<RunControl, const std::string&>(eudaq::cstr2hash("RunControl"));
+
+    // a server announces itself as "scheme://port", add the host its
+    // connection to the RunControl came from
+    std::string CompleteServerAddress(const std::string &server_addr,
+				      const std::string &conn_addr){
+      if((server_addr.find("tcp://") != 0 && server_addr.find("epoll://") != 0)
+	 || conn_addr.find("tcp://") != 0)
+	return server_addr;
+      return server_addr.substr(0, server_addr.find("://"))
+	+ conn_addr.substr(3, conn_addr.find_last_not_of("0123456789") - 3)
+	+ ":"
+	+ server_addr.substr(server_addr.find_last_not_of("0123456789")+1);
+    }
   }
   
   RunControl::RunControl(const std::string &listenaddress)
@@ -51,21 +64,31 @@ namespace eudaq {
 	return;
       }
       else if(st == Status::STATE_UNINIT){
-        if(conn->GetType() == "LogCollector") {
-          conn_to_init.insert(conn_to_init.begin(),conn);
-        }
-        else {
-          conn_to_init.push_back(conn);
-        }
+	conn_to_init.push_back(conn);
       }
     }
     lk.unlock();
 
     for(auto &conn: conn_to_init){
-    InitialiseSingleConnection(conn);
+      std::string conn_type = conn->GetType();
+      std::string conn_name = conn->GetName();
+      if(conn_type == "LogCollector" && conn_name == "log"){
+	lk.lock();
+	std::string server_addr = m_conn_status[conn]->GetTag("_SERVER");
+	lk.unlock();
+	server_addr = CompleteServerAddress(server_addr, conn->GetRemote());
+	if(!server_addr.empty()){
+	  m_conf_init->SetSection("");
+	  m_conf_init->SetString("EUDAQ_LOG_ADDR", server_addr);
+	  SendCommand("LOG", server_addr);
+	}
+      }
     }
+    m_conf_init->SetSection("RunControl"); //TODO: RunControl section must exist
+    SendCommandInGroups("INIT", to_string(*m_conf_init), conn_to_init,
+			[](int st){return st == Status::STATE_UNCONF;}, *m_conf_init);
+  }
 
-}
     void RunControl::InitialiseSingleConnection(ConnectionSPC id) {
     EUDAQ_INFO(std::string("Processing Initialise command for ")+id->GetName());
     std::unique_lock<std::mutex> lk(m_mtx_conn);
@@ -84,11 +107,7 @@ namespace eudaq {
 	lk.lock();
 	std::string server_addr = m_conn_status[id]->GetTag("_SERVER");
 	lk.unlock();
-	if(server_addr.find("tcp://") == 0 && conn_addr.find("tcp://") == 0){
-	  server_addr = conn_addr.substr(0, conn_addr.find_last_not_of("0123456789"))
-	    + ":"
-	    + server_addr.substr(server_addr.find_last_not_of("0123456789")+1);
-	}
+	server_addr = CompleteServerAddress(server_addr, conn_addr);
 	std::string server_name = conn_type+"."+conn_name;
 	if(server_name=="LogCollector.log" && !server_addr.empty()){
 	  m_conf_init->SetSection("");
@@ -126,11 +145,7 @@ namespace eudaq {
 	lk.lock();
 	std::string server_addr = m_conn_status[conn]->GetTag("_SERVER");
 	lk.unlock();
-	if(server_addr.find("tcp://") == 0 && conn_addr.find("tcp://") == 0){
-	  server_addr = conn_addr.substr(0, conn_addr.find_last_not_of("0123456789"))
-	    + ":"
-	    + server_addr.substr(server_addr.find_last_not_of("0123456789")+1);
-	}
+	server_addr = CompleteServerAddress(server_addr, conn_addr);
 	std::string server_name = conn_type+"."+conn_name;
 	m_conf->SetString(server_name, server_addr);
       }
@@ -138,8 +153,8 @@ namespace eudaq {
     if(!m_conf->HasSection("RunControl"))
            EUDAQ_THROW("No global RunControl section given in config file");
     m_conf->SetSection("RunControl");
-    for(auto &conn: conn_to_conf)
-      SendCommand("CONFIG", to_string(*m_conf), conn);
+    SendCommandInGroups("CONFIG", to_string(*m_conf), conn_to_conf,
+			[](int st){return st == Status::STATE_CONF;}, *m_conf);
   }
   
   void RunControl::ConfigureSingleConnection(ConnectionSPC id) {  
@@ -161,11 +176,7 @@ namespace eudaq {
 	lk.lock();
 	std::string server_addr = m_conn_status[id]->GetTag("_SERVER");
 	lk.unlock();
-	if(server_addr.find("tcp://") == 0 && conn_addr.find("tcp://") == 0){
-	  server_addr = conn_addr.substr(0, conn_addr.find_last_not_of("0123456789"))
-	    + ":"
-	    + server_addr.substr(server_addr.find_last_not_of("0123456789")+1);
-	}
+	server_addr = CompleteServerAddress(server_addr, conn_addr);
 	std::string server_name = conn_type+"."+conn_name;
 	m_conf->SetString(server_name, server_addr);
     }
@@ -213,80 +224,31 @@ namespace eudaq {
       }
     }
     lk.unlock();
-    
-    for(auto &conn :conn_to_run){
-      if(conn->GetType() != "Producer" && conn->GetType() != "DataCollector"){
-	SendCommand("START", to_string(m_run_n), conn);
-	while(1){
-	  int n = 0;
-	  n++;
-	  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	  auto st = GetConnectionStatus(conn);
-	  if(st && st->GetState() == Status::STATE_RUNNING)
-	    break;
-	  if(n>30)
-	    EUDAQ_ERROR("Timesout waiting running status");
-	}
-      }
-    }
 
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    for(auto &conn :conn_to_run){
-      if(conn->GetType() == "DataCollector"){
-	SendCommand("START", to_string(m_run_n), conn);
-	while(1){
-	  int n = 0;
-	  n++;
-	  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	  auto st = GetConnectionStatus(conn);
-	  if(st && st->GetState() == Status::STATE_RUNNING)
-	    break;
-	  if(n>30)
-	    EUDAQ_ERROR("Timesout waiting running status");
-	}
-      }
-    }
-
-
-    //TODO: make sure datacollector is started before producer. waiting
-    std::this_thread::sleep_for(std::chrono::seconds(1));
     std::string producer_last_start;
     m_conf->SetSection("RunControl");
     producer_last_start = m_conf->Get("EUDAQ_CTRL_PRODUCER_LAST_START", producer_last_start);
+    std::chrono::seconds timeout(m_conf->Get("EUDAQ_CTRL_TIMEOUT_S", 60));
+    std::vector<ConnectionSPC> conn_other, conn_dc, conn_pd, conn_pd_last;
     for(auto &conn :conn_to_run){
-      if(conn->GetType() == "Producer" &&
-	 conn->GetName() != producer_last_start){
-	SendCommand("START", to_string(m_run_n), conn);
-      }
+      if(conn->GetType() == "DataCollector")
+	conn_dc.push_back(conn);
+      else if(conn->GetType() == "Producer" && conn->GetName() == producer_last_start)
+	conn_pd_last.push_back(conn);
+      else if(conn->GetType() == "Producer")
+	conn_pd.push_back(conn);
+      else
+	conn_other.push_back(conn);
     }
 
-    auto tp_timeout = std::chrono::steady_clock::now()
-      + std::chrono::seconds(60);
-    for(auto &conn :conn_to_run){
-      if(conn->GetName() == producer_last_start){
-	continue;
-      }
-      while(1){
-	auto st = GetConnectionStatus(conn)->GetState();
-	if(st == Status::STATE_CONF){
-	  if(std::chrono::steady_clock::now()>tp_timeout){
-	    EUDAQ_ERROR("Timesout waiting running status from "+ conn->GetName());
-	  }
-	  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	  continue;
-	}else{
-	  break;
-	}
-      }
-    }
-    
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    for(auto &conn :conn_to_run){
-      if(conn->GetType() == "Producer" &&
-	 conn->GetName() == producer_last_start){
-	SendCommand("START", to_string(m_run_n), conn);
-      }
-    }
+    // the DataCollectors are listening once they are running, so a phase
+    // starts as soon as the previous one is running
+    auto running = [](int st){return st == Status::STATE_RUNNING;};
+    std::string run_n = to_string(m_run_n);
+    SendCommandAndWait("START", run_n, conn_other, running, timeout);
+    SendCommandAndWait("START", run_n, conn_dc, running, timeout);
+    SendCommandAndWait("START", run_n, conn_pd, running, timeout);
+    SendCommandAndWait("START", run_n, conn_pd_last, running, timeout);
   }
   
   void RunControl::StartSingleConnection(ConnectionSPC id) {  
@@ -324,59 +286,25 @@ namespace eudaq {
     std::string producer_first_stop="";
     m_conf->SetSection("RunControl");
     producer_first_stop = m_conf->Get("EUDAQ_CTRL_PRODUCER_FIRST_STOP", producer_first_stop);
-
-    auto tp_timeout = std::chrono::steady_clock::now()
-      + std::chrono::seconds(60);
-
-    for(auto &conn : conn_to_stop){
-      if (conn->GetType() == "Producer" &&
-	  conn->GetName() == producer_first_stop){
-	SendCommand("STOP", "", conn);
-
-	while(1){
-	  std::this_thread::sleep_for(std::chrono::milliseconds(100));
-	  auto st =  GetConnectionStatus(conn)->GetState();
-	  if (st == Status::STATE_RUNNING) {
-	    if(std::chrono::steady_clock::now() > tp_timeout){
-	      EUDAQ_ERROR("Timesout waiting stopping status from "+ conn->GetName());
-	    }
-	    continue;
-	  }else break;
-	}// make sure the first producer has stopped
-      }// find the first stop producer!
-    }// loop to find the key producer.
-
-    
+    std::chrono::seconds timeout(m_conf->Get("EUDAQ_CTRL_TIMEOUT_S", 60));
+    std::vector<ConnectionSPC> conn_pd_first, conn_pd, conn_dc, conn_other;
     for(auto &conn :conn_to_stop){
-      if(conn->GetType() == "Producer" &&
-	 conn->GetName() != producer_first_stop){
-    	SendCommand("STOP", "", conn);
-      }
+      if(conn->GetType() == "Producer" && conn->GetName() == producer_first_stop)
+	conn_pd_first.push_back(conn);
+      else if(conn->GetType() == "Producer")
+	conn_pd.push_back(conn);
+      else if(conn->GetType() == "DataCollector")
+	conn_dc.push_back(conn);
+      else
+	conn_other.push_back(conn);
     }
 
-    for(auto &conn :conn_to_stop)
-      if(conn->GetType() == "Producer" &&
-	 conn->GetName() != producer_first_stop){
-        while(1){
-          auto st =  GetConnectionStatus(conn)->GetState();
-          if (st != Status::STATE_RUNNING) break;
-          if(std::chrono::steady_clock::now() > tp_timeout) 
-            EUDAQ_ERROR("Timesout waiting stopping status from "+ conn->GetName());
-          std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-      }
-
-    for(auto &conn :conn_to_stop)
-      if(conn->GetType() == "DataCollector")
-	SendCommand("STOP", "", conn);
-
-    //TODO: make sure datacollector is stoped after producer. waiting. check status
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    for(auto &conn :conn_to_stop){
-      if(conn->GetType() != "Producer" && conn->GetType() != "DataCollector"){
-	SendCommand("STOP", "", conn);
-      }
-    }
+    // the DataCollectors are stopped once all the producers have stopped
+    auto stopped = [](int st){return st != Status::STATE_RUNNING;};
+    SendCommandAndWait("STOP", "", conn_pd_first, stopped, timeout);
+    SendCommandAndWait("STOP", "", conn_pd, stopped, timeout);
+    SendCommandAndWait("STOP", "", conn_dc, stopped, timeout);
+    SendCommandAndWait("STOP", "", conn_other, stopped, timeout);
   }
   
   void RunControl::StopSingleConnection(ConnectionSPC id) {  
@@ -408,6 +336,15 @@ namespace eudaq {
   void RunControl::SendCommand(const std::string &cmd, const std::string &param,
                                ConnectionSPC id){
     std::unique_lock<std::mutex> lk(m_mtx_sendcmd);    
+    // counted as the CommandReceiver does, see SendCommandAndWait()
+    if(cmd != "STATUS"){
+      std::unique_lock<std::mutex> lk_conn(m_mtx_conn);
+      if(id)
+	m_n_sent[id][cmd] ++;
+      else
+	for(auto &conn_st: m_conn_status)
+	  m_n_sent[conn_st.first][cmd] ++;
+    }
     std::string packet(cmd);
     if(param.length() > 0) {
       packet += '\0' + param;
@@ -418,6 +355,140 @@ namespace eudaq {
       m_cmdserver->SendPacket(packet, ConnectionInfo::ALL);
   }
 
+  // Sends cmd to all of conns at once and waits until each of them has
+  // answered with a state for which reached() is true, is in error or is
+  // gone, and logs how long each one took. Returns the ones which failed.
+  // A status answers the command once its _CMD_<cmd> tag, the number of
+  // such commands the component has processed, counts it. Only without
+  // the tag, from components of older versions, any status received after
+  // sending is taken.
+  std::vector<std::string> RunControl::SendCommandAndWait(const std::string &cmd, const std::string &param,
+				      const std::vector<ConnectionSPC> &conns,
+				      const std::function<bool(int)> &reached,
+				      std::chrono::steady_clock::duration timeout){
+    if(conns.empty())
+      return std::vector<std::string>();
+    // only a status received after the command tells its outcome
+    std::map<ConnectionSPC, StatusSPC> st_sent;
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
+    for(auto &conn: conns){
+      auto it = m_conn_status.find(conn);
+      if(it != m_conn_status.end())
+	st_sent[conn] = it->second;
+    }
+    lk.unlock();
+    auto tp_sent = std::chrono::steady_clock::now();
+    for(auto &conn: conns)
+      SendCommand(cmd, param, conn);
+    std::map<ConnectionSPC, uint32_t> n_expected;
+    lk.lock();
+    for(auto &conn: conns)
+      n_expected[conn] = m_n_sent[conn][cmd];
+    lk.unlock();
+    auto is_reply = [&](const ConnectionSPC &conn, const StatusSPC &st){
+      std::string n = st->GetTag("_CMD_" + cmd);
+      if(n.empty())
+	return st != st_sent[conn];
+      return from_string(n, uint32_t(0)) >= n_expected[conn];
+    };
+
+    std::map<ConnectionSPC, std::string> done;
+    std::vector<std::string> failed;
+    bool is_timeout = false;
+    lk.lock();
+    while(true){
+      for(auto &conn: conns){
+	if(done.count(conn))
+	  continue;
+	auto it = m_conn_status.find(conn);
+	std::string ms = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>
+					(std::chrono::steady_clock::now() - tp_sent).count());
+	std::string name = conn->GetType() + "." + conn->GetName();
+	if(it == m_conn_status.end()){
+	  done[conn] = "disconnected after " + ms + " ms";
+	  failed.push_back(name + " (disconnected)");
+	}
+	else if(is_reply(conn, it->second) && it->second->GetState() == Status::STATE_ERROR){
+	  done[conn] = "error after " + ms + " ms";
+	  failed.push_back(name + " (" + it->second->GetMessage() + ")");
+	}
+	else if(is_reply(conn, it->second) && reached(it->second->GetState()))
+	  done[conn] = ms + " ms";
+      }
+      if(done.size() == conns.size() || is_timeout || m_exit)
+	break;
+      is_timeout = m_cv_status.wait_until(lk, tp_sent + timeout) == std::cv_status::timeout;
+    }
+    lk.unlock();
+
+    std::string msg = cmd + ":";
+    std::string msg_timeout;
+    for(auto &conn: conns){
+      std::string name = conn->GetType() + "." + conn->GetName();
+      if(done.count(conn))
+	msg += " " + name + " " + done[conn] + ",";
+      else{
+	msg_timeout += " " + name;
+	failed.push_back(name + " (timeout)");
+      }
+    }
+    msg.pop_back();
+    EUDAQ_INFO(msg);
+    if(!msg_timeout.empty())
+      EUDAQ_ERROR("Timeout waiting for " + cmd + " of" + msg_timeout);
+    return failed;
+  }
+
+  // Sends cmd group by group, in ascending order of the EUDAQ_CTRL_GROUP
+  // given in the section of each component, and all components of a group
+  // at once. A group is only started when the previous ones succeeded.
+  std::vector<std::string> RunControl::SendCommandInGroups(const std::string &cmd, const std::string &param,
+							   const std::vector<ConnectionSPC> &conns,
+							   const std::function<bool(int)> &reached,
+							   const Configuration &conf){
+    std::string section_backup = conf.GetCurrentSectionName();
+    conf.SetSection("RunControl");
+    std::chrono::seconds timeout(conf.Get("EUDAQ_CTRL_TIMEOUT_S", 60));
+    std::map<int, std::vector<ConnectionSPC>> groups;
+    for(auto &conn: conns){
+      std::string section = conn->GetType();
+      if(!conn->GetName().empty())
+	section += "." + conn->GetName();
+      // the LogCollectors are ready before the others start to log
+      int group = conn->GetType() == "LogCollector" ? -1 : 0;
+      if(conf.SetSection(section))
+	group = conf.Get("EUDAQ_CTRL_GROUP", group);
+      groups[group].push_back(conn);
+    }
+    conf.SetSection(section_backup);
+
+    std::vector<std::string> failed;
+    for(auto &group: groups){
+      if(!failed.empty()){
+	for(auto &conn: group.second)
+	  failed.push_back(conn->GetType() + "." + conn->GetName() + " (not sent)");
+	continue;
+      }
+      auto failed_group = SendCommandAndWait(cmd, param, group.second, reached, timeout);
+      failed.insert(failed.end(), failed_group.begin(), failed_group.end());
+    }
+    if(failed.empty()){
+      EUDAQ_INFO(cmd + ": all of " + std::to_string(conns.size()) + " components succeeded");
+    }
+    else{
+      std::string msg;
+      for(auto &e: failed)
+	msg += "\n  " + e;
+      EUDAQ_ERROR(cmd + ": " + std::to_string(failed.size()) + " of " +
+		  std::to_string(conns.size()) + " components failed:" + msg);
+    }
+    return failed;
+  }
+
+  std::string RunControl::GetListenAddress() const {
+    return m_cmdserver ? m_cmdserver->ConnectionString() : "";
+  }
+
   void RunControl::CommandThread() {
     while (!m_exit) {
       m_cmdserver->Process(100000);
@@ -452,6 +523,8 @@ namespace eudaq {
     case (TransportEvent::DISCONNECT):
       DoDisconnect(con);
       m_conn_status.erase(con);
+      m_n_sent.erase(con);
+      m_cv_status.notify_all();
       break;
     case (TransportEvent::RECEIVE):
       if (con->GetState() == 0) { // waiting for identification
@@ -495,6 +568,7 @@ namespace eudaq {
         auto status = std::make_shared<Status>(ser);
 	m_conn_status.at(con) = status;
 	DoStatus(con, status);
+	m_cv_status.notify_all();
       }
       break;
     default:
@@ -537,7 +611,10 @@ namespace eudaq {
   }
 
   void RunControl::CloseRunControl(){
+    std::unique_lock<std::mutex> lk(m_mtx_conn);
     m_exit = true;
+    m_cv_status.notify_all();
+    lk.unlock();
     if(m_thd_status.joinable())
       m_thd_status.join();
     if(m_thd_server.joinable())
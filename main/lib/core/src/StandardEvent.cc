@@ -49,7 +49,10 @@ namespace eudaq {
 
   size_t StandardEvent::NumPlanes() const { return m_planes.size(); }
 
-  StandardPlane &StandardEvent::GetPlane(size_t i) { return m_planes[i]; }
+  StandardPlane &StandardEvent::GetPlane(size_t i) {
+    ClearSerialized();
+    return m_planes[i];
+  }
 
   const StandardPlane &StandardEvent::GetPlane(size_t i) const {
     return m_planes[i];
@@ -64,6 +67,7 @@ namespace eudaq {
   }
 
   StandardPlane &StandardEvent::AddPlane(const StandardPlane &plane) {
+    ClearSerialized();
     m_planes.push_back(plane);
     return m_planes.back();
   }
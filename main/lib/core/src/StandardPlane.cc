@@ -1,18 +1,96 @@
 #include "eudaq/StandardPlane.hh"
 
+#include <stdexcept>
+
 namespace eudaq{
+  namespace {
+    // First word of the serialized plane since format version 1; older
+    // planes start with the length of the type string.
+    const uint32_t FORMAT_MARKER = 0xffffffff;
+    const uint32_t FORMAT_VERSION = 1;
+
+    // Element i of an optional channel which is empty while all values are 0
+    template <typename T>
+    T OptionalAt(const std::vector<T> &v, size_t i, size_t n) {
+      if (i >= n)
+	throw std::out_of_range("StandardPlane: pixel index " + to_string(i) +
+				" out of range " + to_string(n));
+      return v.empty() ? T() : v[i];
+    }
+
+    std::vector<uint32_t> ToCoords(const std::vector<double> &v) {
+      return std::vector<uint32_t>(v.begin(), v.end());
+    }
+
+    // The CDS loops run over plain arrays without branches so that they are
+    // vectorised (see the compile flags of this file in CMakeLists.txt).
+    void CDS2Kernel(const double *f0, const double *f1, double *out, size_t n) {
+      for (size_t i = 0; i < n; ++i)
+	out[i] = f1[i] - f0[i];
+    }
+
+    // On input m is 1 from the pivot pixel on and 0 before it, on output
+    // it holds the CDS values
+    void CDS3Kernel(const double *f0, const double *f1, const double *f2,
+		    double *m, size_t n) {
+      for (size_t i = 0; i < n; ++i)
+	m[i] = f0[i] * (m[i] - 1) + f1[i] * (2 * m[i] - 1) + f2[i] * m[i];
+    }
+
+    void CheckFrameSize(const std::vector<double> &f, size_t n) {
+      if (f.size() < n)
+	throw std::out_of_range("StandardPlane: CDS frames differ in size");
+    }
+
+    // Two raw frames: second minus first
+    void CDS2(const std::vector<double> &f0, const std::vector<double> &f1,
+	      std::vector<double> &out) {
+      CheckFrameSize(f1, f0.size());
+      out.resize(f0.size());
+      CDS2Kernel(f0.data(), f1.data(), out.data(), out.size());
+    }
+
+    // Three raw frames: -(f0 + f1) before the pivot pixel, f1 + f2 from it on
+    void CDS3(const std::vector<double> &f0, const std::vector<double> &f1,
+	      const std::vector<double> &f2, const std::vector<bool> &pivot,
+	      std::vector<double> &out) {
+      const size_t n = f0.size();
+      CheckFrameSize(f1, n);
+      CheckFrameSize(f2, n);
+      if (pivot.size() < n)
+	throw std::out_of_range("StandardPlane: CDS pivot bits missing");
+      // the bit vector does not vectorise, unpack it once
+      out.resize(n);
+      auto bit = pivot.begin();
+      for (size_t i = 0; i < n; ++i, ++bit)
+	out[i] = *bit;
+      CDS3Kernel(f0.data(), f1.data(), f2.data(), out.data(), n);
+    }
+  }
+
   StandardPlane::StandardPlane()
     : m_id(0), m_xsize(0), m_ysize(0), m_flags(0),
-      m_pivotpixel(0), m_result_pix(0), m_result_x(0), m_result_y(0) {}
+      m_pivotpixel(0) {}
 
   StandardPlane::StandardPlane(uint32_t id, const std::string &type,
 			       const std::string &sensor)
     : m_type(type), m_sensor(sensor), m_id(id), m_xsize(0),
-      m_ysize(0), m_flags(0), m_pivotpixel(0), m_result_pix(0), m_result_x(0),
-      m_result_y(0) {}
-
-  StandardPlane::StandardPlane(Deserializer &ds)
-    : m_result_pix(0), m_result_x(0), m_result_y(0) {
+      m_ysize(0), m_flags(0), m_pivotpixel(0) {}
+
+  StandardPlane::StandardPlane(Deserializer &ds) {
+    uint32_t marker = 0;
+    ds.read(marker);
+    if (marker != FORMAT_MARKER) {
+      m_type = std::string(marker, ' ');
+      if (marker)
+	ds.read(reinterpret_cast<unsigned char *>(&m_type[0]), marker);
+      ReadLegacy(ds);
+      return;
+    }
+    uint32_t version = 0;
+    ds.read(version);
+    if (version != FORMAT_VERSION)
+      EUDAQ_THROW("StandardPlane: unknown serialization format version " + to_string(version));
     ds.read(m_type);
     ds.read(m_sensor);
     ds.read(m_id);
@@ -21,17 +99,82 @@ namespace eudaq{
     ds.read(m_flags);
     ds.read(m_pivotpixel);
     ds.read(m_pix);
-    ds.read(m_waveform);
-    ds.read(m_waveform_x0);
-    ds.read(m_waveform_dx);
     ds.read(m_x);
     ds.read(m_y);
+    ds.read(m_time);
+    ds.read(m_pivot);
+    ds.read(m_mat);
+    ds.read(m_waveform_pool);
+    uint32_t nset = 0;
+    ds.read(nset);
+    m_waveform.resize(nset);
+    for (auto &wfs : m_waveform) {
+      uint32_t n = 0;
+      ds.read(n);
+      wfs.resize(n);
+      for (auto &wf : wfs) {
+	ds.read(wf.offset);
+	ds.read(wf.size);
+	ds.read(wf.x0);
+	ds.read(wf.dx);
+	if (uint64_t(wf.offset) + wf.size > m_waveform_pool.size())
+	  EUDAQ_THROW("StandardPlane: waveform outside of the sample pool");
+      }
+    }
+  }
+
+  // Format before version 1: every channel as double, one waveform vector per hit
+  void StandardPlane::ReadLegacy(Deserializer &ds) {
+    std::vector<std::vector<std::vector<double>>> waveform;
+    std::vector<std::vector<double>> waveform_x0, waveform_dx, x, y;
+    ds.read(m_sensor);
+    ds.read(m_id);
+    ds.read(m_xsize);
+    ds.read(m_ysize);
+    ds.read(m_flags);
+    ds.read(m_pivotpixel);
+    ds.read(m_pix);
+    ds.read(waveform);
+    ds.read(waveform_x0);
+    ds.read(waveform_dx);
+    ds.read(x);
+    ds.read(y);
     ds.read(m_pivot);
     ds.read(m_mat);
     ds.read(m_time);
+    for (auto &v : x)
+      m_x.push_back(ToCoords(v));
+    for (auto &v : y)
+      m_y.push_back(ToCoords(v));
+    m_time.resize(m_x.size());
+    for (auto &t : m_time) {
+      bool any = false;
+      for (auto ts : t)
+	any = any || ts;
+      if (!any)
+	t.clear();
+    }
+    m_waveform.resize(m_x.size());
+    for (size_t f = 0; f < m_waveform.size() && f < waveform.size(); ++f) {
+      for (size_t i = 0; i < waveform[f].size(); ++i) {
+	if (waveform[f][i].empty())
+	  continue;
+	if (m_waveform[f].empty())
+	  m_waveform[f].resize(m_x[f].size(), Waveform());
+	Waveform &wf = m_waveform[f].at(i);
+	wf.offset = m_waveform_pool.size();
+	wf.size = waveform[f][i].size();
+	wf.x0 = waveform_x0.at(f).at(i);
+	wf.dx = waveform_dx.at(f).at(i);
+	m_waveform_pool.insert(m_waveform_pool.end(), waveform[f][i].begin(),
+			       waveform[f][i].end());
+      }
+    }
   }
 
   void StandardPlane::Serialize(Serializer &ser) const {
+    ser.write(FORMAT_MARKER);
+    ser.write(FORMAT_VERSION);
     ser.write(m_type);
     ser.write(m_sensor);
     ser.write(m_id);
@@ -40,14 +183,22 @@ namespace eudaq{
     ser.write(m_flags);
     ser.write(m_pivotpixel);
     ser.write(m_pix);
-    ser.write(m_waveform);
-    ser.write(m_waveform_x0);
-    ser.write(m_waveform_dx);
     ser.write(m_x);
     ser.write(m_y);
+    ser.write(m_time);
     ser.write(m_pivot);
     ser.write(m_mat);
-    ser.write(m_time);
+    ser.write(m_waveform_pool);
+    ser.write((uint32_t)m_waveform.size());
+    for (auto &wfs : m_waveform) {
+      ser.write((uint32_t)wfs.size());
+      for (auto &wf : wfs) {
+	ser.write(wf.offset);
+	ser.write(wf.size);
+	ser.write(wf.x0);
+	ser.write(wf.dx);
+      }
+    }
   }
 
 
@@ -59,7 +210,7 @@ namespace eudaq{
     os << std::string(offset, ' ') << m_id << ", " << m_type << ":" << m_sensor << ", "
        << m_xsize << "x" << m_ysize << "x" << m_pix.size()
        << " (" << (m_pix.size() ? m_pix[0].size() : 0) << "), pivot=" << m_pivotpixel
-       << " timestamps:" << m_time[0].size()<< std::endl; }
+       << " timestamps:" << (m_time.size() ? m_time[0].size() : 0) << std::endl; }
   void StandardPlane::SetSizeRaw(uint32_t w, uint32_t h, uint32_t frames,
 				 int flags) {
 
@@ -70,15 +221,14 @@ namespace eudaq{
 
   void StandardPlane::SetSizeZS(uint32_t w, uint32_t h, uint32_t npix,
 				uint32_t frames, int flags) {
+    Invalidate();
     m_flags = flags | FLAG_ZS;
     // std::cout << "DBG flags " << hexdec(m_flags) << std::endl;
     m_xsize = w;
     m_ysize = h;
     m_pix.resize(frames);
-    m_waveform.resize(frames);
-    m_waveform_x0.resize(frames);
-    m_waveform_dx.resize(frames);
     m_time.resize(GetFlags(FLAG_DIFFCOORDS) ? frames : 1);
+    m_waveform.resize(GetFlags(FLAG_DIFFCOORDS) ? frames : 1);
     m_x.resize(GetFlags(FLAG_DIFFCOORDS) ? frames : 1);
     m_y.resize(GetFlags(FLAG_DIFFCOORDS) ? frames : 1);
     m_pivot.resize(GetFlags(FLAG_WITHPIVOT)
@@ -90,10 +240,11 @@ namespace eudaq{
     for (size_t i = 0; i < m_x.size(); ++i) {
       m_x[i].resize(npix);
       m_y[i].resize(npix);
-      m_waveform[i].resize(npix);
-      m_waveform_x0[i].resize(npix);
-      m_waveform_dx[i].resize(npix);
-      m_time[i].resize(npix);
+      // optional channels keep their size only once they are in use
+      if (!m_time[i].empty())
+	m_time[i].resize(npix);
+      if (!m_waveform[i].empty())
+	m_waveform[i].resize(npix, Waveform());
       if (m_pivot.size()) {
         m_pivot[i].resize(npix);
       }
@@ -102,15 +253,21 @@ namespace eudaq{
 
   void StandardPlane::PushPixelHelper(uint32_t x, uint32_t y, double p, uint64_t time_ps,
 				      bool pivot, uint32_t frame) {
-    if (frame > m_x.size())
+    if (frame >= m_x.size() || frame >= m_pix.size())
       EUDAQ_THROW("Bad frame number " + to_string(frame) + " in PushPixel");
+    Invalidate();
     m_x[frame].push_back(x);
     m_y[frame].push_back(y);
     m_pix[frame].push_back(p);
-    m_waveform[frame].push_back(std::vector<double>());
-    m_waveform_x0[frame].push_back(0);
-    m_waveform_dx[frame].push_back(0);
-    m_time[frame].push_back(time_ps);
+    std::vector<uint64_t> &t = m_time[frame];
+    if (time_ps) {
+      t.resize(m_x[frame].size() - 1);
+      t.push_back(time_ps);
+    } else if (!t.empty()) {
+      t.push_back(0);
+    }
+    if (!m_waveform[frame].empty())
+      m_waveform[frame].push_back(Waveform());
     if (m_pivot.size())
       m_pivot[frame].push_back(pivot);
     // std::cout << "DBG: " << frame << ", " << x << ", " << y << ", " << p <<
@@ -118,23 +275,31 @@ namespace eudaq{
   }
 
   void StandardPlane::SetWaveform(uint32_t index, std::vector<double> waveform, double x0, double dx, uint32_t frame) {
-    if (frame > m_x.size()) {
+    frame = CoordFrame(frame);
+    if (frame >= m_x.size()) {
       EUDAQ_THROW("Bad frame number " + to_string(frame) + " in SetWaveform");
     }
 
-    if(index >= m_waveform.at(frame).size()) {
+    if(index >= m_x[frame].size()) {
       EUDAQ_THROW("Bad pixel index " + to_string(frame) + " in SetWaveform");
     }
+    Invalidate();
 
-    m_waveform.at(frame).at(index) = std::move(waveform);
-    m_waveform_x0.at(frame).at(index) = x0;
-    m_waveform_dx.at(frame).at(index) = dx;
+    if (m_waveform[frame].empty())
+      m_waveform[frame].resize(m_x[frame].size(), Waveform());
+    Waveform &wf = m_waveform[frame][index];
+    wf.offset = m_waveform_pool.size();
+    wf.size = waveform.size();
+    wf.x0 = x0;
+    wf.dx = dx;
+    m_waveform_pool.insert(m_waveform_pool.end(), waveform.begin(), waveform.end());
   }
 
   void StandardPlane::SetPixelHelper(uint32_t index, uint32_t x, uint32_t y,
 				     double pix, uint64_t time_ps, bool pivot, uint32_t frame) {
     if (frame >= m_pix.size())
       EUDAQ_THROW("Bad frame number " + to_string(frame) + " in SetPixel");
+    Invalidate();
     if (frame < m_x.size()) {
       m_x.at(frame).at(index) = x;
     }
@@ -147,116 +312,111 @@ namespace eudaq{
     if (frame < m_pix.size()) {
       m_pix.at(frame).at(index) = pix;
     }
-    if (frame < m_waveform.size()) {
-      m_waveform.at(frame).at(index) = std::vector<double>();
-    }
-    if (frame < m_waveform_x0.size()) {
-      m_waveform_x0.at(frame).at(index) = 0.;
-    }
-    if (frame < m_waveform_dx.size()) {
-      m_waveform_dx.at(frame).at(index) = 0.;
+    if (frame < m_waveform.size() && !m_waveform[frame].empty()) {
+      m_waveform[frame].at(index) = Waveform();
     }
     if (frame < m_time.size()) {
-      m_time.at(frame).at(index) = time_ps;
+      if (time_ps && m_time[frame].empty())
+	m_time[frame].resize(m_x[frame].size());
+      if (!m_time[frame].empty())
+	m_time[frame].at(index) = time_ps;
     }
   }
 
-  void StandardPlane::SetFlags(StandardPlane::FLAGS flags) { m_flags |= flags; }
+  void StandardPlane::SetFlags(StandardPlane::FLAGS flags) {
+    Invalidate();
+    m_flags |= flags;
+  }
 
   bool StandardPlane::HasWaveform(uint32_t index, uint32_t frame) const {
-    return !m_waveform.at(frame).at(index).empty();
+    frame = CoordFrame(frame);
+    return OptionalAt(m_waveform.at(frame), index, m_x.at(frame).size()).size != 0;
   }
 
   std::vector<double> StandardPlane::GetWaveform(uint32_t index, uint32_t frame) const {
-    return m_waveform.at(frame).at(index);
+    frame = CoordFrame(frame);
+    Waveform wf = OptionalAt(m_waveform.at(frame), index, m_x.at(frame).size());
+    auto begin = m_waveform_pool.begin() + wf.offset;
+    return std::vector<double>(begin, begin + wf.size);
   }
   double StandardPlane::GetWaveformX0(uint32_t index, uint32_t frame) const {
-    return m_waveform_x0.at(frame).at(index);
+    frame = CoordFrame(frame);
+    return OptionalAt(m_waveform.at(frame), index, m_x.at(frame).size()).x0;
   }
   double StandardPlane::GetWaveformDX(uint32_t index, uint32_t frame) const {
-    return m_waveform_dx.at(frame).at(index);
+    frame = CoordFrame(frame);
+    return OptionalAt(m_waveform.at(frame), index, m_x.at(frame).size()).dx;
   }
 
   bool StandardPlane::HasWaveform(uint32_t index) const {
-    SetupResult();
-    return !m_result_waveform->at(index).empty();
+    return ResultWaveform(SetupResult(), index).size != 0;
   }
 
   std::vector<double> StandardPlane::GetWaveform(uint32_t index) const {
-    SetupResult();
-    return m_result_waveform->at(index);
+    Waveform wf = ResultWaveform(SetupResult(), index);
+    auto begin = m_waveform_pool.begin() + wf.offset;
+    return std::vector<double>(begin, begin + wf.size);
   }
   double StandardPlane::GetWaveformX0(uint32_t index) const {
-    SetupResult();
-    return m_result_waveform_x0->at(index);
+    return ResultWaveform(SetupResult(), index).x0;
   }
   double StandardPlane::GetWaveformDX(uint32_t index) const {
-    SetupResult();
-    return m_result_waveform_dx->at(index);
+    return ResultWaveform(SetupResult(), index).dx;
   }
 
   double StandardPlane::GetPixel(uint32_t index, uint32_t frame) const {
     return m_pix.at(frame).at(index);
   }
   double StandardPlane::GetPixel(uint32_t index) const {
-    SetupResult();
-    return m_result_pix->at(index);
+    return ResultPix(SetupResult()).at(index);
   }
   uint64_t StandardPlane::GetTimestamp(uint32_t index, uint32_t frame) const {
-      if (!GetFlags(FLAG_DIFFCOORDS))
-        frame = 0;
-      return m_time.at(frame).at(index);
+    frame = CoordFrame(frame);
+    return OptionalAt(m_time.at(frame), index, m_x.at(frame).size());
   }
   uint64_t StandardPlane::GetTimestamp(uint32_t index) const {
-    SetupResult();
-    return m_result_time->at(index);
+    const Result &r = SetupResult();
+    if (!r.own_hits)
+      return OptionalAt(m_time.at(0), index, m_x.at(0).size());
+    return OptionalAt(r.time, index, r.x.size());
   }
   double StandardPlane::GetX(uint32_t index, uint32_t frame) const {
-    if (!GetFlags(FLAG_DIFFCOORDS))
-      frame = 0;
-    return m_x.at(frame).at(index);
+    return m_x.at(CoordFrame(frame)).at(index);
   }
   double StandardPlane::GetX(uint32_t index) const {
-    SetupResult();
-    return m_result_x->at(index);
+    return ResultX(SetupResult()).at(index);
   }
   double StandardPlane::GetY(uint32_t index, uint32_t frame) const {
-    if (!GetFlags(FLAG_DIFFCOORDS))
-      frame = 0;
-    return m_y.at(frame).at(index);
+    return m_y.at(CoordFrame(frame)).at(index);
   }
   double StandardPlane::GetY(uint32_t index) const {
-    SetupResult();
-    return m_result_y->at(index);
+    return ResultY(SetupResult()).at(index);
   }
   bool StandardPlane::GetPivot(uint32_t index, uint32_t frame) const {
-    if (!GetFlags(FLAG_DIFFCOORDS))
-      frame = 0;
-    return m_pivot.at(frame).at(index);
+    return m_pivot.at(CoordFrame(frame)).at(index);
   }
 
   void StandardPlane::SetPivot(uint32_t index, uint32_t frame, bool PivotFlag) {
+    Invalidate();
     m_pivot.at(frame).at(index) = PivotFlag;
   }
 
   const std::vector<StandardPlane::coord_t> &
   StandardPlane::XVector(uint32_t frame) const {
-    return GetFrame(m_x, frame);
+    return m_coords.Get([this] { return BuildCoords(); }).x.at(frame);
   }
 
   const std::vector<StandardPlane::coord_t> &StandardPlane::XVector() const {
-    SetupResult();
-    return *m_result_x;
+    return m_coords.Get([this] { return BuildCoords(); }).result_x;
   }
 
   const std::vector<StandardPlane::coord_t> &
   StandardPlane::YVector(uint32_t frame) const {
-    return GetFrame(m_y, frame);
+    return m_coords.Get([this] { return BuildCoords(); }).y.at(frame);
   }
 
   const std::vector<StandardPlane::coord_t> &StandardPlane::YVector() const {
-    SetupResult();
-    return *m_result_y;
+    return m_coords.Get([this] { return BuildCoords(); }).result_y;
   }
 
   const std::vector<StandardPlane::pixel_t> &
@@ -265,8 +425,7 @@ namespace eudaq{
   }
 
   const std::vector<StandardPlane::pixel_t> &StandardPlane::PixVector() const {
-    SetupResult();
-    return *m_result_pix;
+    return ResultPix(SetupResult());
   }
 
   void StandardPlane::SetXSize(uint32_t x) { m_xsize = x; }
@@ -294,8 +453,7 @@ namespace eudaq{
   }
 
   uint32_t StandardPlane::HitPixels() const {
-    SetupResult();
-    return m_result_pix->size();
+    return ResultPix(SetupResult()).size();
   }
 
   uint32_t StandardPlane::PivotPixel() const { return m_pivotpixel; }
@@ -314,116 +472,133 @@ namespace eudaq{
     return v.at(f);
   }
 
-  void StandardPlane::SetupResult() const {
-    if (m_result_pix)
-      return;
-    m_result_x = &m_x[0];
-    m_result_y = &m_y[0];
-    m_result_time = &m_time[0];
-    m_result_waveform = &m_waveform[0];
-    m_result_waveform_x0 = &m_waveform_x0[0];
-    m_result_waveform_dx = &m_waveform_dx[0];
+  uint32_t StandardPlane::CoordFrame(uint32_t frame) const {
+    return GetFlags(FLAG_DIFFCOORDS) ? frame : 0;
+  }
+
+  void StandardPlane::Invalidate() {
+    m_result.Reset();
+    m_coords.Reset();
+  }
+
+  const StandardPlane::Result &StandardPlane::SetupResult() const {
+    return m_result.Get([this] { return BuildResult(); });
+  }
+
+  const std::vector<StandardPlane::pixel_t> &
+  StandardPlane::ResultPix(const Result &r) const {
+    return r.own_pix ? r.pix : m_pix.at(0);
+  }
+
+  const std::vector<uint32_t> &StandardPlane::ResultX(const Result &r) const {
+    return r.own_hits ? r.x : m_x.at(0);
+  }
+
+  const std::vector<uint32_t> &StandardPlane::ResultY(const Result &r) const {
+    return r.own_hits ? r.y : m_y.at(0);
+  }
 
+  StandardPlane::Waveform StandardPlane::ResultWaveform(const Result &r,
+							uint32_t index) const {
+    if (r.own_hits)
+      return OptionalAt(r.waveform, index, r.x.size());
+    return OptionalAt(m_waveform.at(0), index, m_x.at(0).size());
+  }
+
+  StandardPlane::Result StandardPlane::BuildResult() const {
+    Result r;
     if (GetFlags(FLAG_ACCUMULATE)) {
-      m_temp_pix.resize(0);
-      m_temp_x.resize(0);
-      m_temp_y.resize(0);
-      m_temp_time.resize(0);
-      m_temp_waveform.resize(0);
-      m_temp_waveform_x0.resize(0);
-      m_temp_waveform_dx.resize(0);
+      r.own_pix = r.own_hits = true;
+      bool with_time = false, with_waveform = false;
+      for (size_t f = 0; f < m_pix.size(); ++f) {
+	const uint32_t cf = CoordFrame(f);
+	if (m_pix[f].size() > m_x.at(cf).size())
+	  throw std::out_of_range("StandardPlane: frame " + to_string(f) +
+				  " has more pixels than coordinates");
+	with_time = with_time || !m_time[cf].empty();
+	with_waveform = with_waveform || !m_waveform[cf].empty();
+      }
       for (size_t f = 0; f < m_pix.size(); ++f) {
-        for (size_t p = 0; p < m_pix[f].size(); ++p) {
-          m_temp_x.push_back(GetX(p, f));
-          m_temp_y.push_back(GetY(p, f));
-          m_temp_pix.push_back(GetPixel(p, f));
-          m_temp_time.push_back(GetTimestamp(p,f));
-          m_temp_waveform.push_back(GetWaveform(p, f));
-          m_temp_waveform_x0.push_back(GetWaveformX0(p, f));
-          m_temp_waveform_dx.push_back(GetWaveformDX(p,f));
-        }
+	const uint32_t cf = CoordFrame(f);
+	const size_t n = m_pix[f].size();
+	r.pix.insert(r.pix.end(), m_pix[f].begin(), m_pix[f].end());
+	r.x.insert(r.x.end(), m_x[cf].begin(), m_x[cf].begin() + n);
+	r.y.insert(r.y.end(), m_y[cf].begin(), m_y[cf].begin() + n);
+	if (with_time) {
+	  if (m_time[cf].empty())
+	    r.time.resize(r.time.size() + n);
+	  else
+	    r.time.insert(r.time.end(), m_time[cf].begin(), m_time[cf].begin() + n);
+	}
+	if (with_waveform) {
+	  if (m_waveform[cf].empty())
+	    r.waveform.resize(r.waveform.size() + n, Waveform());
+	  else
+	    r.waveform.insert(r.waveform.end(), m_waveform[cf].begin(),
+			      m_waveform[cf].begin() + n);
+	}
       }
-      m_result_x = &m_temp_x;
-      m_result_y = &m_temp_y;
-      m_result_pix = &m_temp_pix;
-      m_result_time = & m_temp_time;
-      m_result_waveform = &m_temp_waveform;
-      m_result_waveform_x0 = &m_temp_waveform_x0;
-      m_result_waveform_dx = &m_temp_waveform_dx;
     } else if (m_pix.size() == 1 && !GetFlags(FLAG_NEEDCDS)) {
-      m_result_pix = &m_pix[0];
+      // frame 0 is the result
     } else if (m_pix.size() == 2) {
+      r.own_pix = true;
       if (GetFlags(FLAG_NEEDCDS)) {
-        m_temp_pix.resize(m_pix[0].size());
-        for (size_t i = 0; i < m_temp_pix.size(); ++i) {
-          m_temp_pix[i] = m_pix[1][i] - m_pix[0][i];
-        }
-        m_result_pix = &m_temp_pix;
+	CDS2(m_pix[0], m_pix[1], r.pix);
+      } else if (m_x.size() == 1) {
+	const std::vector<bool> &pivot = m_pivot.at(0);
+	r.pix.resize(m_pix[0].size());
+	for (size_t i = 0; i < r.pix.size(); ++i) {
+	  r.pix[i] = m_pix[1 - pivot[i]][i];
+	}
       } else {
-        if (m_x.size() == 1) {
-          m_temp_pix.resize(m_pix[0].size());
-          for (size_t i = 0; i < m_temp_pix.size(); ++i) {
-            m_temp_pix[i] = m_pix[1 - m_pivot[0][i]][i];
-          }
-          m_temp_waveform = m_waveform[0];
-          m_temp_waveform_x0 = m_waveform_x0[0];
-          m_temp_waveform_dx = m_waveform_dx[0];
-        } else {
-          m_temp_x.resize(0);
-          m_temp_y.resize(0);
-          m_temp_pix.resize(0);
-          m_temp_time.resize(0);
-          m_temp_waveform.resize(0);
-          m_temp_waveform_x0.resize(0);
-          m_temp_waveform_dx.resize(0);
-          const bool inverse = false;
-          size_t i;
-          for (i = 0; i < m_pix[1 - inverse].size(); ++i) {
-            if (m_pivot[1][i])
-            break;
-            m_temp_x.push_back(m_x[1 - inverse][i]);
-            m_temp_y.push_back(m_y[1 - inverse][i]);
-            m_temp_pix.push_back(m_pix[1 - inverse][i]);
-            m_temp_time.push_back(m_time[1-inverse][i]);
-            m_temp_waveform.push_back(GetWaveform(i, 1-inverse));
-            m_temp_waveform_x0.push_back(GetWaveformX0(i, 1-inverse));
-            m_temp_waveform_dx.push_back(GetWaveformDX(i, 1-inverse));
-          }
-          for (i = 0; i < m_pix[0 + inverse].size(); ++i) {
-            if (m_pivot[0 + inverse][i])
-            break;
-          }
-          for (/**/; i < m_pix[0 + inverse].size(); ++i) {
-            m_temp_x.push_back(m_x[0 + inverse][i]);
-            m_temp_y.push_back(m_y[0 + inverse][i]);
-            m_temp_pix.push_back(m_pix[0 + inverse][i]);
-            m_temp_time.push_back(m_time[0 + inverse][i]);
-            m_temp_waveform.push_back(GetWaveform(i, 0 + inverse));
-            m_temp_waveform_x0.push_back(GetWaveformX0(i, 0 + inverse));
-            m_temp_waveform_dx.push_back(GetWaveformDX(i, 0 + inverse));
-          }
-          m_result_x = &m_temp_x;
-          m_result_y = &m_temp_y;
-          m_result_time = &m_temp_time;
-        }
-        m_result_pix = &m_temp_pix;
-        m_result_waveform = &m_temp_waveform;
-        m_result_waveform_x0 = &m_temp_waveform_x0;
-        m_result_waveform_dx = &m_temp_waveform_dx;
+	r.own_hits = true;
+	const bool with_time = !m_time[0].empty() || !m_time[1].empty();
+	const bool with_waveform = !m_waveform[0].empty() || !m_waveform[1].empty();
+	auto push = [&](size_t f, size_t i) {
+	  r.x.push_back(m_x[f][i]);
+	  r.y.push_back(m_y[f][i]);
+	  r.pix.push_back(m_pix[f][i]);
+	  if (with_time)
+	    r.time.push_back(OptionalAt(m_time[f], i, m_x[f].size()));
+	  if (with_waveform)
+	    r.waveform.push_back(OptionalAt(m_waveform[f], i, m_x[f].size()));
+	};
+	// hits of frame 1 before the pivot, then hits of frame 0 from the pivot on
+	size_t i;
+	for (i = 0; i < m_pix[1].size(); ++i) {
+	  if (m_pivot[1][i])
+	    break;
+	  push(1, i);
+	}
+	for (i = 0; i < m_pix[0].size(); ++i) {
+	  if (m_pivot[0][i])
+	    break;
+	}
+	for (/**/; i < m_pix[0].size(); ++i) {
+	  push(0, i);
+	}
       }
     } else if (m_pix.size() == 3 && GetFlags(FLAG_NEEDCDS)) {
-      m_temp_pix.resize(m_pix[0].size());
-      for (size_t i = 0; i < m_temp_pix.size(); ++i) {
-        m_temp_pix[i] = m_pix[0][i] * (m_pivot[0][i] - 1) +
-        m_pix[1][i] * (2 * m_pivot[0][i] - 1) +
-        m_pix[2][i] * (m_pivot[0][i]);
-      }
-      m_result_pix = &m_temp_pix;
+      r.own_pix = true;
+      CDS3(m_pix[0], m_pix[1], m_pix[2], m_pivot.at(0), r.pix);
     } else {
       EUDAQ_THROW("Unrecognised pixel format (" + to_string(m_pix.size()) +
-      " frames, CDS=" +
-      (GetFlags(FLAG_NEEDCDS) ? "Needed" : "Done") + ")");
+		  " frames, CDS=" +
+		  (GetFlags(FLAG_NEEDCDS) ? "Needed" : "Done") + ")");
+    }
+    return r;
+  }
+
+  StandardPlane::Coords StandardPlane::BuildCoords() const {
+    Coords c;
+    for (size_t f = 0; f < m_x.size(); ++f) {
+      c.x.emplace_back(m_x[f].begin(), m_x[f].end());
+      c.y.emplace_back(m_y[f].begin(), m_y[f].end());
     }
+    const Result &r = SetupResult();
+    c.result_x.assign(ResultX(r).begin(), ResultX(r).end());
+    c.result_y.assign(ResultY(r).begin(), ResultY(r).end());
+    return c;
   }
 
   template std::vector<short> StandardPlane::GetPixels<>() const;
@@ -5,6 +5,11 @@ namespace eudaq{
   template DLLEXPORT
   std::map<uint32_t, typename Factory<StdEventConverter>::UP(*)()>&
   Factory<StdEventConverter>::Instance<>();
+
+  StdEventConverter* StdEventConverter::GetConverter(uint32_t id, uint32_t run_n, ConfigurationSPC conf){
+    static thread_local ConverterCache<StdEventConverter> cache;
+    return cache.Get(id, run_n, conf);
+  }
   
   bool StdEventConverter::Convert(EventSPC d1, StdEventSP d2, ConfigurationSPC conf){
 
@@ -42,7 +47,7 @@ namespace eudaq{
       d2->SetDescription(d1->GetDescription());
     }
     uint32_t id = d1->GetType();
-    auto cvt = Factory<StdEventConverter>::MakeUnique(id);
+    auto cvt = GetConverter(id, d1->GetRunN(), conf);
     if(cvt){
       return cvt->Converting(d1, d2, conf);
     }
@@ -0,0 +1,359 @@
+#include "eudaq/TimestampEventBuilder.hh"
+#include "eudaq/Exception.hh"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace eudaq {
+
+  namespace {
+    template <typename T>
+    bool HeadLater(const T &a, const T &b){
+      return a.ts_begin > b.ts_begin;
+    }
+
+    // restores the min-heap after the top entry was raised
+    template <typename T>
+    void SiftDown(std::vector<T> &heap){
+      size_t i = 0, n = heap.size();
+      T v = heap[0];
+      while(true){
+	size_t c = 2 * i + 1;
+	if(c >= n)
+	  break;
+	if(c + 1 < n && heap[c + 1] < heap[c])
+	  c++;
+	if(!(heap[c] < v))
+	  break;
+	heap[i] = heap[c];
+	i = c;
+      }
+      heap[i] = v;
+    }
+  }
+
+  TimestampEventBuilder::TimestampEventBuilder()
+    :m_n_idle(0), m_min_end(0), m_min_end_ok(false),
+     m_width(0), m_share(true), m_timeout(Clock::duration::zero()),
+     m_flush(false), m_last_end(0), m_n_queued(0), m_n_dropped(0){
+  }
+
+  void TimestampEventBuilder::SetWindow(uint64_t width){
+    m_width = width;
+  }
+
+  void TimestampEventBuilder::SetShareSpanning(bool share){
+    m_share = share;
+  }
+
+  void TimestampEventBuilder::SetTimeout(Clock::duration timeout){
+    m_timeout = timeout;
+    // the arrival times are not kept without a timeout
+    Clock::time_point now = Now();
+    for(auto &s: m_streams)
+      s.last_arrival = now;
+  }
+
+  TimestampEventBuilder::Clock::time_point TimestampEventBuilder::Now() const{
+    return m_timeout != Clock::duration::zero() ? Clock::now() : Clock::time_point();
+  }
+
+  uint32_t TimestampEventBuilder::AddStream(){
+    uint32_t id = m_streams.size();
+    m_streams.emplace_back();
+    Stream &s = m_streams.back();
+    s.open = true;
+    s.in_watermark = true;
+    s.last_arrival = Now();
+    m_watermark.push_back(MarkEntry(0, id));
+    std::push_heap(m_watermark.begin(), m_watermark.end(), std::greater<MarkEntry>());
+    m_n_idle++;
+    return id;
+  }
+
+  void TimestampEventBuilder::CloseStream(uint32_t id){
+    if(!IsOpen(id))
+      return;
+    Stream &s = m_streams[id];
+    s.open = false;
+    if(!s.in_heads)
+      m_n_idle--;
+  }
+
+  bool TimestampEventBuilder::IsOpen(uint32_t id) const{
+    return id < m_streams.size() && m_streams[id].open;
+  }
+
+  void TimestampEventBuilder::Reset(){
+    m_streams.clear();
+    m_heads.clear();
+    m_n_idle = 0;
+    m_min_end_ok = false;
+    m_watermark.clear();
+    m_shared.clear();
+    m_flush = false;
+    m_last_end = 0;
+    m_n_queued = 0;
+    m_n_dropped = 0;
+  }
+
+  void TimestampEventBuilder::Flush(){
+    m_flush = true;
+  }
+
+  bool TimestampEventBuilder::IsStalled(const Stream &s, Clock::time_point now) const{
+    return m_timeout != Clock::duration::zero() && now - s.last_arrival > m_timeout;
+  }
+
+  uint32_t TimestampEventBuilder::GetNumStalled() const{
+    return GetNumStalled(Now());
+  }
+
+  uint32_t TimestampEventBuilder::GetNumStalled(Clock::time_point now) const{
+    uint32_t n = 0;
+    for(auto &s: m_streams)
+      if(s.open && IsStalled(s, now))
+	n++;
+    return n;
+  }
+
+  void TimestampEventBuilder::Push(uint32_t id, EventSPC ev){
+    Push(id, std::move(ev), Now());
+  }
+
+  void TimestampEventBuilder::Push(uint32_t id, EventSPC ev, Clock::time_point now){
+    if(!IsOpen(id))
+      EUDAQ_THROW("TimestampEventBuilder: event for unknown or closed stream " + std::to_string(id));
+    uint64_t beg = ev->GetTimestampBegin();
+    uint64_t end = ev->GetTimestampEnd();
+    Stream &s = m_streams[id];
+    if(end < beg)
+      EUDAQ_THROW("TimestampEventBuilder: event ends before it begins in stream " + std::to_string(id));
+    if(beg < s.last_begin)
+      EUDAQ_THROW("TimestampEventBuilder: events out of order in stream " + std::to_string(id));
+    s.last_arrival = now;
+    s.last_begin = beg;
+    s.last_end = std::max(s.last_end, end);
+    if(!s.in_watermark){
+      m_watermark.push_back(MarkEntry(s.last_end, id));
+      std::push_heap(m_watermark.begin(), m_watermark.end(), std::greater<MarkEntry>());
+      s.in_watermark = true;
+    }
+    m_flush = false;
+
+    // too late for any window still to be built
+    if(end < m_last_end || (end == m_last_end && beg < end)){
+      m_n_dropped++;
+      return;
+    }
+    s.que.push_back(Queued{beg, end, std::move(ev)});
+    m_n_queued++;
+    if(!s.in_heads)
+      PushHead(id, s.que.back());
+  }
+
+  void TimestampEventBuilder::PushHead(uint32_t id, const Queued &q){
+    m_heads.push_back(HeadEntry{q.ts_begin, q.ts_end, id});
+    std::push_heap(m_heads.begin(), m_heads.end(), HeadLater<HeadEntry>);
+    Stream &s = m_streams[id];
+    s.in_heads = true;
+    if(s.open)
+      m_n_idle--;
+    if(m_min_end_ok)
+      m_min_end = std::min(m_min_end, q.ts_end);
+  }
+
+  // A subtree of the heap begins no earlier than its root, so only the
+  // entries beginning before the earliest end found so far are visited
+  uint64_t TimestampEventBuilder::MinHeadEnd(){
+    if(m_min_end_ok)
+      return m_min_end;
+    uint64_t end = std::numeric_limits<uint64_t>::max();
+    if(m_heads.size() <= 16){
+      for(auto &h: m_heads)
+	end = std::min(end, h.ts_end);
+    }
+    else{
+      m_walk.assign(1, 0);
+      while(!m_walk.empty()){
+	size_t i = m_walk.back();
+	m_walk.pop_back();
+	if(i >= m_heads.size() || m_heads[i].ts_begin >= end)
+	  continue;
+	end = std::min(end, m_heads[i].ts_end);
+	m_walk.push_back(2 * i + 1);
+	m_walk.push_back(2 * i + 2);
+      }
+    }
+    m_min_end = end;
+    m_min_end_ok = true;
+    return end;
+  }
+
+  uint64_t TimestampEventBuilder::Watermark(Clock::time_point now){
+    while(!m_watermark.empty()){
+      MarkEntry &top = m_watermark.front();
+      Stream &s = m_streams[top.second];
+      if(!s.open || IsStalled(s, now)){
+	// a stalled stream is taken back in by its next event
+	s.in_watermark = false;
+	std::pop_heap(m_watermark.begin(), m_watermark.end(), std::greater<MarkEntry>());
+	m_watermark.pop_back();
+	continue;
+      }
+      if(top.first != s.last_end){
+	// the entry is only updated once it gets on top
+	top.first = s.last_end;
+	SiftDown(m_watermark);
+	continue;
+      }
+      return top.first;
+    }
+    return std::numeric_limits<uint64_t>::max();
+  }
+
+  void TimestampEventBuilder::Requeue(uint32_t id){
+    Stream &s = m_streams[id];
+    size_t first = s.front_shared ? 1 : 0;
+    if(s.front_shared)
+      m_shared.push_back(id);
+    if(!s.in_heads && s.que.size() > first)
+      PushHead(id, s.que[first]);
+  }
+
+  // The first event not built yet begins inside the window if the stream
+  // was taken from the heads. It hides a shared event from the last window.
+  void TimestampEventBuilder::AttachOne(uint32_t id, uint64_t beg, uint64_t end, Built &out){
+    Stream &s = m_streams[id];
+    auto &que = s.que;
+    size_t first = s.front_shared ? 1 : 0;
+    bool head = !s.in_heads && que.size() > first && que[first].ts_begin < end;
+    if(s.front_shared){
+      const Queued &q = que.front();
+      if(!head && q.ts_end > beg)
+	out.events.push_back(q.ev);
+      if(q.ts_end <= end){
+	que.pop_front();
+	m_n_queued--;
+	s.front_shared = false;
+      }
+    }
+    // a stream whose events overlap keeps its head for the next window
+    if(head && !s.front_shared){
+      Queued &q = que.front();
+      if(q.ts_end > end && m_share){
+	out.events.push_back(q.ev);
+	s.front_shared = true;
+      }
+      else{
+	out.events.push_back(std::move(q.ev));
+	que.pop_front();
+	m_n_queued--;
+      }
+    }
+    Requeue(id);
+  }
+
+  void TimestampEventBuilder::Attach(uint32_t id, uint64_t beg, uint64_t end, Built &out){
+    Stream &s = m_streams[id];
+    auto &que = s.que;
+    if(s.front_shared){
+      // built before, only attached again while it overlaps
+      const Queued &q = que.front();
+      if(q.ts_end > beg)
+	out.events.push_back(q.ev);
+      if(q.ts_end <= end){
+	que.pop_front();
+	m_n_queued--;
+	s.front_shared = false;
+      }
+    }
+    while(!s.front_shared && !que.empty()){
+      const Queued &q = que.front();
+      if(q.ts_begin >= end)
+	break;
+      if(q.ts_end > beg || q.ts_begin >= beg)
+	out.events.push_back(q.ev);
+      else
+	m_n_dropped++;
+      if(q.ts_end > end && m_share){
+	s.front_shared = true;
+	break;
+      }
+      que.pop_front();
+      m_n_queued--;
+    }
+    Requeue(id);
+  }
+
+  bool TimestampEventBuilder::Pop(Built &out){
+    return Pop(out, Now());
+  }
+
+  bool TimestampEventBuilder::Pop(Built &out, Clock::time_point now){
+    out.events.clear();
+    while(!m_heads.empty()){
+      uint64_t beg = std::max(m_heads.front().ts_begin, m_last_end);
+      // no window can be built before every stream got past its begin; an
+      // event-defined window ends before the events waiting to be built
+      uint64_t wm = std::numeric_limits<uint64_t>::max();
+      if(!m_flush && (m_width || m_n_idle))
+	wm = Watermark(now);
+      if(wm <= beg)
+	return false;
+      uint64_t end;
+      if(m_width){
+	beg -= beg % m_width;
+	end = beg + m_width;
+      }
+      else
+	end = std::max(MinHeadEnd(), beg + 1);
+      if(wm < end)
+	return false;
+
+      m_members.swap(m_shared);
+      m_shared.clear();
+      for(auto id: m_members)
+	m_streams[id].member = true;
+      while(!m_heads.empty() && m_heads.front().ts_begin < end){
+	std::pop_heap(m_heads.begin(), m_heads.end(), HeadLater<HeadEntry>);
+	uint32_t id = m_heads.back().id;
+	m_heads.pop_back();
+	Stream &s = m_streams[id];
+	s.in_heads = false;
+	if(s.open)
+	  m_n_idle++;
+	if(!s.member){
+	  s.member = true;
+	  m_members.push_back(id);
+	}
+      }
+      m_min_end_ok = false;
+      // the events are added in stream order
+      if(m_members.size() * 4 < m_streams.size())
+	std::sort(m_members.begin(), m_members.end());
+      else{
+	m_members.clear();
+	for(uint32_t id = 0; id < m_streams.size(); id++)
+	  if(m_streams[id].member)
+	    m_members.push_back(id);
+      }
+      for(auto id: m_members){
+	m_streams[id].member = false;
+	if(m_width)
+	  Attach(id, beg, end, out);
+	else
+	  AttachOne(id, beg, end, out);
+      }
+      m_members.clear();
+      m_last_end = end;
+      if(!out.events.empty()){
+	out.ts_begin = beg;
+	out.ts_end = end;
+	return true;
+      }
+    }
+    return false;
+  }
+}
@@ -54,6 +54,10 @@ at some places we have constructions like:
 #include "TransportTCP_POSIX.hh"
 #endif
 
+#if EUDAQ_PLATFORM_IS(LINUX)
+#include <sys/epoll.h>
+#endif
+
 // print debug messages that are optimized out if DEBUG_TRANSPORT is not set:
 // source and details:
 // http://stackoverflow.com/questions/1644868/c-define-macro-for-debug-printing
@@ -77,10 +81,29 @@ namespace eudaq {
     auto d1=Factory<TransportClient>::Register<TCPClient, const std::string&>
       (str2hash(TCPClient::name));
   }
+
+#if EUDAQ_PLATFORM_IS(LINUX)
+  const std::string EpollTCPServer::name = "epoll";
+  const std::string EpollTCPClient::name = "epoll";
+
+  namespace{
+    auto d2=Factory<TransportServer>::Register<EpollTCPServer, const std::string&>
+      (str2hash(EpollTCPServer::name));
+    auto d3=Factory<TransportClient>::Register<EpollTCPClient, const std::string&>
+      (str2hash(EpollTCPClient::name));
+  }
+#endif
   
   namespace {
     static const int MAXPENDING = 16;
     static const int MAX_BUFFER_SIZE = 10000;
+    // receive buffer of the epoll transport, doubled whenever a full read
+    // did not complete a packet, i.e. it follows the size of the packets
+    static const size_t MIN_RECV_BUFFER_SIZE = 16 * 1024;
+    static const size_t MAX_RECV_BUFFER_SIZE = 64 * 1024;
+    // full-buffer reads of one socket per wakeup before serving the others
+    static const int MAX_READS_PER_EVENT = 8;
+    static const int MAX_EPOLL_EVENTS = 64;
     static int to_int(char c) { return static_cast<unsigned char>(c); }
 #ifdef MSG_NOSIGNAL
     // On Linux (and cygwin?) send(...) can be told to
@@ -164,20 +187,31 @@ namespace eudaq {
     os << std::string(offset, ' ') << "</ConnectionTCP>\n";
   }
 
+  // Consumed packets only advance m_pos. The consumed bytes are dropped when
+  // the buffer runs empty or they make up more than half of it, so every
+  // byte is moved at most once on average.
   void ConnectionInfoTCP::append(size_t length, const char *data) {
-    m_buf += std::string(data, length);
+    if (m_pos == m_buf.length()) {
+      m_buf.clear();
+      m_pos = 0;
+    }
+    else if (m_pos > m_buf.length() / 2) {
+      m_buf.erase(0, m_pos);
+      m_pos = 0;
+    }
+    m_buf.append(data, length);
     update_length();
   }
 
   bool ConnectionInfoTCP::havepacket() const {
-    return m_buf.length() >= m_len + 4;
+    return m_buf.length() - m_pos >= m_len + 4;
   }
 
   std::string ConnectionInfoTCP::getpacket() {
     if (!havepacket())
       EUDAQ_THROW_NOLOG("TransprotTCP:: No packet available");
-    std::string packet(m_buf, 4, m_len);
-    m_buf.erase(0, m_len + 4);
+    std::string packet(m_buf, m_pos + 4, m_len);
+    m_pos += m_len + 4;
     update_length(true);
     return packet;
   }
@@ -185,9 +219,9 @@ namespace eudaq {
   void ConnectionInfoTCP::update_length(bool force) {
     if (force || m_len == 0) {
       m_len = 0;
-      if (m_buf.length() >= 4) {
+      if (m_buf.length() - m_pos >= 4) {
         for (int i = 0; i < 4; ++i) {
-          m_len |= to_int(m_buf[i]) << (8 * i);
+          m_len |= to_int(m_buf[m_pos + i]) << (8 * i);
         }
       }
     }
@@ -237,6 +271,26 @@ namespace eudaq {
     closesocket(m_srvsock);
   }
 
+  std::shared_ptr<ConnectionInfoTCP> TCPServer::AddConnection(SOCKET peersock,
+								const sockaddr_in &addr) {
+    setup_socket(peersock);
+    std::string host = inet_ntoa(addr.sin_addr);
+    host = "tcp://"+host+":" + to_string(ntohs(addr.sin_port));
+    auto conn_new = std::make_shared<ConnectionInfoTCP>(peersock, host);
+    bool inserted = false;
+    for(auto &conn: m_conn) {
+      if(!conn) {
+	conn = conn_new;
+	inserted = true;
+	break;
+      }
+    }
+    if (!inserted)
+      m_conn.push_back(conn_new);
+    m_events.push(TransportEvent(TransportEvent::CONNECT, conn_new));
+    return conn_new;
+  }
+
   std::shared_ptr<ConnectionInfoTCP> TCPServer::GetInfo(SOCKET fd) const {
     const ConnectionInfoTCP tofind(fd);
     for(auto &conn: m_conn){
@@ -308,21 +362,7 @@ namespace eudaq {
 	  else {
             FD_SET(peersock, &m_fdset);
             m_maxfd = (m_maxfd < peersock) ? peersock : m_maxfd;
-            setup_socket(peersock);
-            std::string host = inet_ntoa(addr.sin_addr);
-            host = "tcp://"+host+":" + to_string(ntohs(addr.sin_port));
-            auto conn_new = std::make_shared<ConnectionInfoTCP>(peersock, host);
-            bool inserted = false;
-            for(auto &conn: m_conn) {
-              if(!conn) {
-                conn = conn_new;
-                inserted = true;
-		break;
-              }
-            }
-            if (!inserted)
-              m_conn.push_back(conn_new);
-            m_events.push(TransportEvent(TransportEvent::CONNECT, conn_new));
+            AddConnection(peersock, addr);
             FD_CLR(m_srvsock, &tempset);
           }
         }
@@ -495,3 +535,181 @@ namespace eudaq {
 
   TCPClient::~TCPClient() { closesocket(m_sock); }
 }
+
+#if EUDAQ_PLATFORM_IS(LINUX)
+namespace eudaq {
+  namespace {
+    // milliseconds left for epoll_wait(), rounded up; a negative timeout blocks
+    static int epoll_timeout(int timeout, const Time &t_remain) {
+      if (timeout < 0)
+	return -1;
+      const timeval tv = t_remain;
+      if (tv.tv_sec < 0)
+	return 0;
+      return static_cast<int>(tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000);
+    }
+
+    static void epoll_add(int epfd, SOCKET fd) {
+      epoll_event ev;
+      std::memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN;
+      ev.data.fd = fd;
+      if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev))
+	EUDAQ_THROW_NOLOG(LastSockErrorString("Error in epoll_ctl()"));
+    }
+  }
+
+  EpollTCPServer::EpollTCPServer(const std::string &param)
+    : TCPServer(param), m_epfd(epoll_create1(EPOLL_CLOEXEC)),
+      m_rbuf(MIN_RECV_BUFFER_SIZE) {
+    if (m_epfd < 0)
+      EUDAQ_THROW_NOLOG(LastSockErrorString("EpollTCPServer:: Failed to create epoll instance"));
+    epoll_add(m_epfd, m_srvsock);
+  }
+
+  EpollTCPServer::~EpollTCPServer() {
+    close(m_epfd);
+  }
+
+  std::string EpollTCPServer::ConnectionString() const {
+    return name + "://" + to_string(m_port);
+  }
+
+  void EpollTCPServer::Close(const ConnectionInfo &id) {
+    for(auto &conn: m_conn){
+      if(conn && id.Matches(*conn)){
+	SOCKET fd = conn->GetFd();
+	epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, nullptr);
+	m_fdconn.erase(fd);
+	closesocket(fd);
+	conn.reset();
+      }
+    }
+  }
+
+  bool EpollTCPServer::Receive(const std::shared_ptr<ConnectionInfoTCP> &conn) {
+    bool received = false;
+    for (int n = 0; n < MAX_READS_PER_EVENT; n++) {
+      ssize_t result = recv(conn->GetFd(), &m_rbuf[0], m_rbuf.size(), 0);
+      if (result > 0) {
+	conn->append(result, &m_rbuf[0]);
+	bool complete = false;
+	while (conn->havepacket()) {
+	  complete = true;
+	  m_events.push(TransportEvent(TransportEvent::RECEIVE, conn, conn->getpacket()));
+	}
+	received = received || complete;
+	if (static_cast<size_t>(result) < m_rbuf.size())
+	  break; // socket drained
+	if (!complete && m_rbuf.size() < MAX_RECV_BUFFER_SIZE)
+	  m_rbuf.resize(m_rbuf.size() * 2);
+      }
+      else if (result < 0 && LastSockError() == EUDAQ_ERROR_Interrupted_function_call) {
+	continue;
+      }
+      else if (result < 0 && LastSockError() == EUDAQ_ERROR_Resource_temp_unavailable) {
+	break;
+      }
+      else {
+	// orderly shutdown by the peer or a hard error (e.g. connection reset)
+	debug_transport("Server #%d, return=%zd, Error:%d (%s) Disconnected.\n",
+			conn->GetFd(), result, errno, strerror(errno));
+	m_events.push(TransportEvent(TransportEvent::DISCONNECT, conn));
+	Close(*conn);
+	break;
+      }
+    }
+    return received;
+  }
+
+  void EpollTCPServer::ProcessEvents(int timeout) {
+    Time t_start = Time::Current();
+    Time t_remain = Time(0, timeout);
+    bool done = false;
+    epoll_event evs[MAX_EPOLL_EVENTS];
+    do {
+      int result = epoll_wait(m_epfd, evs, MAX_EPOLL_EVENTS, epoll_timeout(timeout, t_remain));
+      if (result < 0 && LastSockError() != EUDAQ_ERROR_Interrupted_function_call)
+	EUDAQ_THROW_NOLOG(LastSockErrorString("Error in epoll_wait()"));
+      for (int i = 0; i < result; i++) {
+	SOCKET fd = evs[i].data.fd;
+	if (fd == m_srvsock) {
+	  while (true) {
+	    sockaddr_in addr;
+	    socklen_t len = sizeof(addr);
+	    SOCKET peersock = accept(m_srvsock, (sockaddr *)&addr, &len);
+	    if (peersock == INVALID_SOCKET) {
+	      if (LastSockError() == EUDAQ_ERROR_Resource_temp_unavailable ||
+		  LastSockError() == EUDAQ_ERROR_Interrupted_function_call)
+		break;
+	      EUDAQ_THROW_NOLOG(LastSockErrorString("Error in accept()"));
+	    }
+	    m_fdconn[peersock] = AddConnection(peersock, addr);
+	    epoll_add(m_epfd, peersock);
+	  }
+	  continue;
+	}
+	auto it = m_fdconn.find(fd);
+	if (it == m_fdconn.end())
+	  continue; // closed while handling an earlier event of this batch
+	auto conn = it->second;
+	if (Receive(conn))
+	  done = true;
+      }
+      t_remain = Time(0, timeout) + t_start - Time::Current();
+    } while (!done && t_remain > Time(0));
+  }
+
+  EpollTCPClient::EpollTCPClient(const std::string &param)
+    : TCPClient(param), m_epfd(epoll_create1(EPOLL_CLOEXEC)),
+      m_rbuf(MIN_RECV_BUFFER_SIZE) {
+    if (m_epfd < 0)
+      EUDAQ_THROW_NOLOG(LastSockErrorString("EpollTCPClient:: Failed to create epoll instance"));
+    epoll_add(m_epfd, m_sock);
+  }
+
+  EpollTCPClient::~EpollTCPClient() {
+    close(m_epfd);
+  }
+
+  void EpollTCPClient::ProcessEvents(int timeout) {
+    Time t_start = Time::Current();
+    Time t_remain = Time(0, timeout);
+    bool done = false;
+    do {
+      epoll_event ev;
+      int result = epoll_wait(m_epfd, &ev, 1, epoll_timeout(timeout, t_remain));
+      if (result < 0 && LastSockError() != EUDAQ_ERROR_Interrupted_function_call)
+	EUDAQ_THROW_NOLOG(LastSockErrorString("Error in epoll_wait()"));
+      for (int n = 0; result > 0 && n < MAX_READS_PER_EVENT; n++) {
+	ssize_t len = recv(m_sock, &m_rbuf[0], m_rbuf.size(), 0);
+	if (len > 0) {
+	  m_buf->append(len, &m_rbuf[0]);
+	  bool complete = false;
+	  while (m_buf->havepacket()) {
+	    m_events.push(TransportEvent(TransportEvent::RECEIVE, m_buf,
+					 m_buf->getpacket()));
+	    complete = true;
+	  }
+	  done = done || complete;
+	  if (static_cast<size_t>(len) < m_rbuf.size())
+	    break;
+	  if (!complete && m_rbuf.size() < MAX_RECV_BUFFER_SIZE)
+	    m_rbuf.resize(m_rbuf.size() * 2);
+	}
+	else if (len < 0 && LastSockError() == EUDAQ_ERROR_Interrupted_function_call) {
+	  continue;
+	}
+	else if (len < 0 && LastSockError() == EUDAQ_ERROR_Resource_temp_unavailable) {
+	  break;
+	}
+	else {
+	  EUDAQ_THROW_NOLOG(LastSockErrorString(
+	      "SocketClient Error (" + to_string(LastSockError()) + ")"));
+	}
+      }
+      t_remain = Time(0, timeout) + t_start - Time::Current();
+    } while (!done && t_remain > Time(0));
+  }
+}
+#endif
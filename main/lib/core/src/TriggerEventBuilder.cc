@@ -0,0 +1,258 @@
+#include "eudaq/TriggerEventBuilder.hh"
+#include "eudaq/Exception.hh"
+
+#include <algorithm>
+
+namespace eudaq {
+
+  namespace{
+    // how far beyond the ring a trigger number may be to extend it rather
+    // than to get a hash map entry
+    const uint32_t RING_GAP = 256;
+  }
+
+  TriggerEventBuilder::TriggerEventBuilder()
+    :m_n_open(0), m_ring_mask(0), m_ring_base(0), m_ring_n(0), m_n_pending(0),
+     m_past_valid(false), m_past_n(0), m_n_past(0),
+     m_window(0), m_timeout(Clock::duration::zero()), m_flush(false), m_has_built(false), m_last_built(0){
+  }
+
+  void TriggerEventBuilder::SetReorderWindow(uint32_t n){
+    m_window = n;
+    m_past_valid = false;
+  }
+
+  void TriggerEventBuilder::SetTimeout(Clock::duration timeout){
+    m_timeout = timeout;
+    // the arrival times are not kept without a timeout
+    Clock::time_point now = Now();
+    for(auto &p: m_ring)
+      p.first_arrival = now;
+    for(auto &p: m_pending)
+      p.second.first_arrival = now;
+  }
+
+  TriggerEventBuilder::Clock::time_point TriggerEventBuilder::Now() const{
+    return m_timeout != Clock::duration::zero() ? Clock::now() : Clock::time_point();
+  }
+
+  uint32_t TriggerEventBuilder::AddStream(){
+    uint32_t id = m_streams.size();
+    m_streams.emplace_back();
+    m_streams.back().open = true;
+    m_n_open++;
+    m_past_valid = false;
+    return id;
+  }
+
+  void TriggerEventBuilder::CloseStream(uint32_t id){
+    if(!IsOpen(id))
+      return;
+    m_streams[id].open = false;
+    m_n_open--;
+    m_past_valid = false;
+    for(auto &p: m_ring)
+      if(p.used && id < p.events.size() && p.events[id])
+	p.n_open--;
+    for(auto &p: m_pending)
+      if(id < p.second.events.size() && p.second.events[id])
+	p.second.n_open--;
+  }
+
+  void TriggerEventBuilder::Reset(){
+    m_streams.clear();
+    m_n_open = 0;
+    m_ring.clear();
+    m_ring_mask = 0;
+    m_ring_base = 0;
+    m_ring_n = 0;
+    m_pending.clear();
+    m_order = MinHeap();
+    m_n_pending = 0;
+    m_past_valid = false;
+    m_flush = false;
+    m_has_built = false;
+    m_last_built = 0;
+  }
+
+  void TriggerEventBuilder::Flush(){
+    m_flush = true;
+  }
+
+  uint64_t TriggerEventBuilder::GetNumMissing(uint32_t id) const{
+    return id < m_streams.size() ? m_streams[id].n_missing : 0;
+  }
+
+  uint64_t TriggerEventBuilder::GetNumDuplicated(uint32_t id) const{
+    return id < m_streams.size() ? m_streams[id].n_duplicated : 0;
+  }
+
+  uint64_t TriggerEventBuilder::GetNumLate(uint32_t id) const{
+    return id < m_streams.size() ? m_streams[id].n_late : 0;
+  }
+
+  void TriggerEventBuilder::Push(uint32_t id, EventSPC ev){
+    uint32_t n = ev->GetTriggerN();
+    Push(id, n, std::move(ev), Now());
+  }
+
+  void TriggerEventBuilder::Push(uint32_t id, uint32_t n, EventSPC ev){
+    Push(id, n, std::move(ev), Now());
+  }
+
+  void TriggerEventBuilder::Push(uint32_t id, uint32_t n, EventSPC ev, Clock::time_point now){
+    if(!IsOpen(id))
+      EUDAQ_THROW("TriggerEventBuilder: event for unknown or closed stream " + std::to_string(id));
+    Stream &s = m_streams[id];
+    bool repeated = s.delivered && s.last_n == n;
+    bool was_past = m_past_valid && IsPast(s, m_past_n);
+    s.last_n = n;
+    if(!s.delivered || n > s.max_n)
+      s.max_n = n;
+    s.delivered = true;
+    if(m_past_valid && !was_past && IsPast(s, m_past_n))
+      m_n_past++;
+    m_flush = false;
+
+    if(m_has_built && n <= m_last_built){
+      if(repeated)
+	s.n_duplicated++;
+      else
+	s.n_late++;
+      return;
+    }
+    Pending &p = GetPending(n, now);
+    if(id >= p.events.size())
+      p.events.resize(m_streams.size());
+    if(p.events[id]){
+      s.n_duplicated++;
+      return;
+    }
+    p.events[id] = std::move(ev);
+    p.n_open++;
+  }
+
+  TriggerEventBuilder::Pending &TriggerEventBuilder::GetPending(uint32_t n, Clock::time_point now){
+    Pending *p;
+    uint64_t ring_end = uint64_t(m_ring_base) + m_ring_n;
+    std::unordered_map<uint32_t, Pending>::iterator it;
+    if(m_ring_n && n >= m_ring_base && n < ring_end)
+      p = &m_ring[n & m_ring_mask];
+    else if(!m_pending.empty() && (it = m_pending.find(n)) != m_pending.end())
+      return it->second;
+    else if(!m_ring_n){
+      if(m_ring.empty())
+	GrowRing(1);
+      m_ring_base = n;
+      m_ring_n = 1;
+      p = &m_ring[n & m_ring_mask];
+    }
+    else if(n >= ring_end && n - ring_end < RING_GAP){
+      GrowRing(n - m_ring_base + 1);
+      // the hash map entries now in the ring move over
+      for(uint64_t k = ring_end; !m_pending.empty() && k <= n; k++){
+	if((it = m_pending.find(k)) != m_pending.end()){
+	  m_ring[k & m_ring_mask] = std::move(it->second);
+	  m_pending.erase(it);
+	}
+      }
+      m_ring_n = n - m_ring_base + 1;
+      p = &m_ring[n & m_ring_mask];
+    }
+    else{
+      p = &m_pending[n];
+      m_order.push(n);
+    }
+    if(!p->used){
+      p->used = true;
+      if(p->events.size() < m_streams.size())
+	p->events.resize(m_streams.size());
+      p->n_open = 0;
+      p->first_arrival = now;
+      m_n_pending++;
+    }
+    return *p;
+  }
+
+  void TriggerEventBuilder::GrowRing(uint64_t n_slot){
+    if(n_slot <= m_ring.size())
+      return;
+    size_t size = std::max<size_t>(m_ring.size() * 2, 16);
+    while(size < n_slot)
+      size *= 2;
+    std::vector<Pending> ring(size);
+    for(uint64_t k = m_ring_base; k < uint64_t(m_ring_base) + m_ring_n; k++)
+      ring[k & (size - 1)] = std::move(m_ring[k & m_ring_mask]);
+    m_ring.swap(ring);
+    m_ring_mask = size - 1;
+  }
+
+  bool TriggerEventBuilder::IsPast(const Stream &s, uint32_t n) const{
+    return s.delivered && uint64_t(s.max_n) > uint64_t(n) + m_window;
+  }
+
+  bool TriggerEventBuilder::IsReady(uint32_t n, const Pending &p, Clock::time_point now){
+    if(p.n_open >= m_n_open || m_flush)
+      return true;
+    if(!m_past_valid || m_past_n != n){
+      m_n_past = 0;
+      for(auto &s: m_streams)
+	if(s.open && IsPast(s, n))
+	  m_n_past++;
+      m_past_n = n;
+      m_past_valid = true;
+    }
+    // every open stream went past n by more than the reorder window
+    if(m_n_past >= m_n_open)
+      return true;
+    return m_timeout != Clock::duration::zero() && now - p.first_arrival > m_timeout;
+  }
+
+  bool TriggerEventBuilder::Pop(Built &out){
+    return Pop(out, Now());
+  }
+
+  bool TriggerEventBuilder::Pop(Built &out, Clock::time_point now){
+    // trigger numbers nobody delivered
+    while(m_ring_n && !m_ring[m_ring_base & m_ring_mask].used){
+      m_ring_base++;
+      m_ring_n--;
+    }
+    while(!m_order.empty() && !m_pending.count(m_order.top()))
+      m_order.pop();
+    bool in_ring = m_ring_n && (m_order.empty() || m_ring_base < m_order.top());
+    if(!in_ring && m_order.empty())
+      return false;
+    uint32_t n = in_ring ? m_ring_base : m_order.top();
+    auto it = in_ring ? m_pending.end() : m_pending.find(n);
+    Pending &p = in_ring ? m_ring[n & m_ring_mask] : it->second;
+    if(!IsReady(n, p, now))
+      return false;
+
+    // the events are moved out, the slot keeps its vector of null pointers
+    out.trigger_n = n;
+    out.events.clear();
+    out.streams.clear();
+    for(uint32_t id = 0; id < m_streams.size(); id++){
+      if(id < p.events.size() && p.events[id]){
+	out.events.push_back(std::move(p.events[id]));
+	out.streams.push_back(id);
+      }
+      else if(m_streams[id].open)
+	m_streams[id].n_missing++;
+    }
+    p.used = false;
+    if(in_ring){
+      m_ring_base++;
+      m_ring_n--;
+    }
+    else{
+      m_pending.erase(it);
+      m_order.pop();
+    }
+    m_n_pending--;
+    m_has_built = true;
+    m_last_built = n;
+    return true;
+  }
+}
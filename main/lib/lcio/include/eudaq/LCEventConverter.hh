@@ -30,6 +30,8 @@ namespace eudaq{
     LCEventConverter& operator = (const LCEventConverter&) = delete;
     bool Converting(EventSPC d1, LCEventSP d2, ConfigurationSPC conf) const override = 0;
     static bool Convert(EventSPC d1, LCEventSP d2, ConfigurationSPC conf);
+    /// The calling thread's cached converter for a factory ID, nullptr if unknown
+    static LCEventConverter* GetConverter(uint32_t id, uint32_t run_n, ConfigurationSPC conf);
     // static LCEventSP MakeSharedLCEvent(uint32_t run, uint32_t stm);
   };
 
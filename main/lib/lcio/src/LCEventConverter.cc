@@ -5,6 +5,11 @@ namespace eudaq{
   template DLLEXPORT
   std::map<uint32_t, typename Factory<LCEventConverter>::UP(*)()>&
   Factory<LCEventConverter>::Instance<>();
+
+  LCEventConverter* LCEventConverter::GetConverter(uint32_t id, uint32_t run_n, ConfigurationSPC conf){
+    static thread_local ConverterCache<LCEventConverter> cache;
+    return cache.Get(id, run_n, conf);
+  }
   
   bool LCEventConverter::Convert(EventSPC d1, LCEventSP d2, ConfigurationSPC conf){
     if(d1->IsFlagFake()){
@@ -57,7 +62,7 @@ namespace eudaq{
     }
     
     uint32_t id = d1->GetType();
-    auto cvt = Factory<LCEventConverter>::MakeUnique(id);
+    auto cvt = GetConverter(id, d1->GetRunN(), conf);
     if(cvt){
       return cvt->Converting(d1, d2, conf);
     }
@@ -27,6 +27,8 @@ namespace eudaq {
   public:
     LCFileWriter(const std::string &patt);
     void WriteEvent(EventSPC ev) override;
+    std::shared_ptr<void> PrepareEvent(EventSPC ev) const override;
+    void WriteEvent(EventSPC ev, std::shared_ptr<void> prepared) override;
   private:
     std::unique_ptr<lcio::LCWriter> m_lcwriter;
     std::string m_filepattern;
@@ -38,6 +40,16 @@ namespace eudaq {
   }
 
   void LCFileWriter::WriteEvent(EventSPC ev) {
+    WriteEvent(ev, PrepareEvent(ev));
+  }
+
+  std::shared_ptr<void> LCFileWriter::PrepareEvent(EventSPC ev) const {
+    LCEventSP lcevent(new lcio::LCEventImpl);
+    LCEventConverter::Convert(ev, lcevent, GetConfiguration());
+    return lcevent;
+  }
+
+  void LCFileWriter::WriteEvent(EventSPC ev, std::shared_ptr<void> prepared) {
     uint32_t run_n = ev->GetRunN();
     if(!m_lcwriter || m_run_n != run_n){
       try {
@@ -56,8 +68,9 @@ namespace eudaq {
     }
     if(!m_lcwriter)
       EUDAQ_THROW("LCFileWriter: Attempt to write unopened file");
-    LCEventSP lcevent(new lcio::LCEventImpl);
-    LCEventConverter::Convert(ev, lcevent, GetConfiguration());
+    LCEventSP lcevent = std::static_pointer_cast<lcio::LCEventImpl>(prepared);
+    if(!lcevent)
+      lcevent = std::static_pointer_cast<lcio::LCEventImpl>(PrepareEvent(ev));
     m_lcwriter->writeEvent(lcevent.get());
   }
 }
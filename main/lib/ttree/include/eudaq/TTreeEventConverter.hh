@@ -28,6 +28,8 @@ namespace eudaq{
     TTreeEventConverter& operator = (const TTreeEventConverter&) = delete;
     bool Converting(EventSPC d1, TTreeEventSP d2, ConfigurationSPC conf) const override = 0;
     static bool Convert(EventSPC d1, TTreeEventSP d2, ConfigurationSPC conf);
+    /// The calling thread's cached converter for a factory ID, nullptr if unknown
+    static TTreeEventConverter* GetConverter(uint32_t id, uint32_t run_n, ConfigurationSPC conf);
   private:
     /*	TTree *m_ttree; // book the tree (to store the needed event info)
 	// Book variables for the Event_to_TTree conversion
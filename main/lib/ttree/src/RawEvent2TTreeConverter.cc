@@ -22,7 +22,7 @@ namespace eudaq{
     }
     uint32_t id = ev->GetExtendWord();
     //    std::cout << " Sub Type " << ev->GetDescription() << std::endl;
-    auto cvt = Factory<TTreeEventConverter>::MakeUnique(id);
+    auto cvt = GetConverter(id, d1->GetRunN(), conf);
      if(cvt){
       cvt->Converting(d1, d2, conf);
       return true;
@@ -5,6 +5,11 @@ namespace eudaq{
   template DLLEXPORT
   std::map<uint32_t, typename Factory<TTreeEventConverter>::UP(*)()>&
   Factory<TTreeEventConverter>::Instance<>();
+
+  TTreeEventConverter* TTreeEventConverter::GetConverter(uint32_t id, uint32_t run_n, ConfigurationSPC conf){
+    static thread_local ConverterCache<TTreeEventConverter> cache;
+    return cache.Get(id, run_n, conf);
+  }
   
   bool TTreeEventConverter::Convert(EventSPC d1, TTreeEventSP d2, ConfigurationSPC conf){
 
@@ -67,7 +72,7 @@ namespace eudaq{
     d2->Fill();      
 
     uint32_t id = d1->GetType();
-    auto cvt = Factory<TTreeEventConverter>::MakeUnique(id);
+    auto cvt = GetConverter(id, d1->GetRunN(), conf);
     if(cvt){
       return cvt->Converting(d1, d2, conf);
     }
@@ -373,13 +373,33 @@ uint64_t OfflineReading(eudaq::Monitor *mon, eudaq::FileReaderSP reader, uint32_
   // DoConfigure(); //TODO setup the configure and init file.
   mon->DoStartRun();
   uint32_t ev_c = 0;
+  // the seek skips the BORE, which is still needed to set up the monitor
+  eudaq::EventSP ev_first;
+  bool seeked = false;
+  if(ev_n_l){
+    ev_first = std::const_pointer_cast<eudaq::Event>(reader->GetNextEvent());
+    seeked = reader->SeekEvent(ev_n_l);
+    if(ev_first && seeked){
+      bool is_bore = ev_first->IsBORE();
+      for(auto &subev: ev_first->GetSubEvents())
+	is_bore = is_bore || subev->IsBORE();
+      if(is_bore && ev_first->GetEventN() < ev_n_l)
+	mon->DoReceive(ev_first);
+      ev_first.reset();
+    }
+  }
   while(1){
-    auto ev = std::const_pointer_cast<eudaq::Event>(reader->GetNextEvent());
+    auto ev = ev_first ? ev_first : std::const_pointer_cast<eudaq::Event>(reader->GetNextEvent());
+    ev_first.reset();
     if(!ev){
       std::cout<<"end of data file with "<< ev_c << " events" <<std::endl;
       break;
     }
     uint32_t ev_n = ev->GetEventN();
+    if(seeked && ev_n > ev_n_h){
+      std::cout<<"reach to event id "<< ev_n_h <<std::endl;
+      break;
+    }
     if(ev_n>=ev_n_l & ev_n<=ev_n_h){
       mon->DoReceive(ev);
       ev_c ++;
@@ -7,7 +7,7 @@ class ALPIDERawEvent2StdEventConverter:public eudaq::StdEventConverter{
 public:
   bool Converting(eudaq::EventSPC rawev,eudaq::StdEventSP stdev,eudaq::ConfigSPC conf_) const override;
 private:
-  void Dump(const std::vector<uint8_t> &data,size_t i) const;
+  void Dump(const eudaq::EventBlock &data,size_t i) const;
   struct Config {
     int device_n;
   };
@@ -66,7 +66,7 @@ bool ALPIDERawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdE
   Config &conf=LoadConf(conf_);
   if(conf.device_n==-2) return false; // Corry event loader is looking for another plane
   auto rawev=std::dynamic_pointer_cast<const eudaq::RawEvent>(in);
-  std::vector<uint8_t> data=rawev->GetBlock(0); // FIXME: copy?
+  const eudaq::EventBlock &data=rawev->GetBlockView(0);
   if(conf.device_n>=0 && conf.device_n!=rawev->GetDeviceN()) return false;
   eudaq::StandardPlane plane(rawev->GetDeviceN(),"ITS3DAQ","ALPIDE");
   plane.SetSizeZS(1024,512,0,1); // 0 hits so far + 1 frame
@@ -152,7 +152,7 @@ bool ALPIDERawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdE
   return true;
 }
 
-void ALPIDERawEvent2StdEventConverter::Dump(const std::vector<uint8_t> &data,size_t i) const {
+void ALPIDERawEvent2StdEventConverter::Dump(const eudaq::EventBlock &data,size_t i) const {
   char buf[100];
   EUDAQ_WARN("Raw event dump:");
   for (size_t j=0;j<data.size();++j) {
@@ -14,7 +14,9 @@ class CE65RawEvent2StdEventConverter:public eudaq::StdEventConverter{
   static const int X_MX_SIZE = 64;
   static const int Y_MX_SIZE = 32;
 public:
+  ~CE65RawEvent2StdEventConverter() override;
   bool Converting(eudaq::EventSPC rawev,eudaq::StdEventSP stdev,eudaq::ConfigSPC conf) const override;
+  void Reset() override;
 private:
   // Configuration from conf file
   struct Config{
@@ -35,9 +37,10 @@ class CE65RawEvent2StdEventConverter:public eudaq::StdEventConverter{
     int  baselineFrame;
     std::string signalMethod;
   };
-  static Config confLocal;
+  // per instance, instances are cached per thread by StdEventConverter
+  mutable Config confLocal = {false};
 
-  void Dump(const std::vector<uint8_t> &data,size_t i) const;
+  void Dump(const eudaq::EventBlock &data,size_t i) const;
   bool LoadCalibration(const std::string& path) const;
   void InitConfiguration() const;
   bool LoadConfiguration(eudaq::ConfigSPC conf) const;
@@ -49,13 +52,27 @@ class CE65RawEvent2StdEventConverter:public eudaq::StdEventConverter{
 // Definitions for static members
 const int CE65RawEvent2StdEventConverter::X_MX_SIZE;
 const int CE65RawEvent2StdEventConverter::Y_MX_SIZE;
-CE65RawEvent2StdEventConverter::Config CE65RawEvent2StdEventConverter::confLocal = {false};
 
 #define REGISTER_CONVERTER(name) namespace{auto dummy##name=eudaq::Factory<eudaq::StdEventConverter>::Register<CE65RawEvent2StdEventConverter>(eudaq::cstr2hash(#name));}
 REGISTER_CONVERTER(CE65)
 REGISTER_CONVERTER(CE65Raw)
 REGISTER_CONVERTER(ce65_producer)
 
+CE65RawEvent2StdEventConverter::~CE65RawEvent2StdEventConverter(){
+  Reset();
+}
+
+/**
+ * @brief Drop the configuration, it is loaded again with the next event
+ */
+void CE65RawEvent2StdEventConverter::Reset(){
+  delete[] confLocal.subEdge;
+  delete[] confLocal.subThr;
+  delete confLocal.hPedestal;
+  delete confLocal.hNoise;
+  confLocal = Config{false};
+}
+
 /**
  * @brief 
  * 
@@ -76,7 +93,7 @@ short CE65RawEvent2StdEventConverter::DecodeFrameData(eudaq::EventSPC rawev, int
     PrintConfiguration();
   }
   for(int i = 0; i < rawev->GetNumBlock(); i++){
-    std::vector<uint8_t> data = rawev->GetBlock(i);
+    const eudaq::EventBlock &data = rawev->GetBlockView(i);
     uint8_t byteB = data[pixelID * sizeof(short) + 1];
     uint8_t byteA = data[pixelID * sizeof(short)];
     frdata[i] = short((byteB<<8)+byteA);
@@ -260,13 +277,13 @@ bool CE65RawEvent2StdEventConverter::LoadConfiguration(eudaq::ConfigSPC conf) co
 
     confLocal.N_SUBMATRIX = conf->Get("submatrix_n", confLocal.N_SUBMATRIX);
     if(confLocal.subEdge){
-      delete confLocal.subEdge;
+      delete[] confLocal.subEdge;
       confLocal.subEdge = nullptr;
     }
     confLocal.subEdge = new int[confLocal.N_SUBMATRIX];
 
     if(confLocal.subThr){
-      delete confLocal.subThr;
+      delete[] confLocal.subThr;
       confLocal.subThr = nullptr;
     }
     confLocal.subThr = new int[confLocal.N_SUBMATRIX];
@@ -361,7 +378,7 @@ bool CE65RawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdEve
   return true;
 }
 
-void CE65RawEvent2StdEventConverter::Dump(const std::vector<uint8_t> &data,size_t i) const {
+void CE65RawEvent2StdEventConverter::Dump(const eudaq::EventBlock &data,size_t i) const {
   printf("[+] DEBUG : Dump event\n");
   for(int iy=0; iy < Y_MX_SIZE; iy++){
     printf("Y%2d\t",iy);
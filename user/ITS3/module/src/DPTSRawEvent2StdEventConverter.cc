@@ -31,7 +31,7 @@ class DPTSRawEvent2StdEventConverter:public eudaq::StdEventConverter{
   };
   Config& LoadConf(eudaq::ConfigSPC config_) const;
   const XY PulseTrain2XY(int ich,int slope,const PulseTrain& train,eudaq::ConfigSPC conf_) const;
-  std::vector<float> GetEdges(const std::vector<uint8_t> &d,int ich,eudaq::ConfigSPC conf_) const;
+  std::vector<float> GetEdges(const eudaq::EventBlock &d,int ich,eudaq::ConfigSPC conf_) const;
   static std::map<eudaq::ConfigSPC,Config> confs;
 };
 
@@ -168,7 +168,7 @@ bool DPTSRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdEve
   Config &conf=LoadConf(conf_);
   if(conf.ch==-2) return false;
   auto rawev=std::dynamic_pointer_cast<const eudaq::RawEvent>(in);
-  std::vector<uint8_t> data=rawev->GetBlock(0); // FIXME: copy?
+  const eudaq::EventBlock &data=rawev->GetBlockView(0);
   size_t n=data.size();
   char name[100];
   for (int ich=0;ich<2;++ich) {
@@ -232,7 +232,7 @@ bool DPTSRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdEve
   return true;
 }
 
-std::vector<float> DPTSRawEvent2StdEventConverter::GetEdges(const std::vector<uint8_t> &d,int ich,eudaq::ConfigSPC conf_) const {
+std::vector<float> DPTSRawEvent2StdEventConverter::GetEdges(const eudaq::EventBlock &d,int ich,eudaq::ConfigSPC conf_) const {
   const Config &conf=LoadConf(conf_);
   std::vector<float> edges;
   float a=static_cast<int8_t>(d[ich*d.size()/2]);
@@ -122,7 +122,7 @@ namespace { // Anonymous namespace with utility to simplify MOSS decoding
     uint16_t _row{0};
   };
 
-  [[nodiscard]] bool packet_sanity_check(const std::vector<uint8_t> &packet) {
+  [[nodiscard]] bool packet_sanity_check(const eudaq::EventBlock &packet) {
     if (!(::word_from_byte(packet.front()) == MossWord::frame_header)) {
       EUDAQ_ERROR("INVALID MOSS PACKET. Skipping event.");
       return false;
@@ -141,7 +141,7 @@ namespace { // Anonymous namespace with utility to simplify MOSS decoding
       "VerticalLocation",
       "NOT_FOUND"); // If the tag is not found the second argument is returned
 
-  std::vector<uint8_t> packet = raw_event->GetBlock(0);
+  const eudaq::EventBlock &packet = raw_event->GetBlockView(0);
 
   EUDAQ_DEBUG("MOSS Event Packet size =  " + std::to_string(packet.size()));
 
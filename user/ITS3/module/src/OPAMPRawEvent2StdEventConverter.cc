@@ -386,7 +386,7 @@ bool OPAMPRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,
   if(conf.device_n>=0 && conf.device_n!=rawev->GetDeviceN()) return false;
   if (rawev->GetNumBlock() != 4 && rawev->GetNumBlock() != 6 )
     return false; // TODO: how/can this happen?
-  const std::vector<uint8_t> &block = rawev->GetBlock(0);
+  const eudaq::EventBlock &block = rawev->GetBlockView(0);
   size_t n = block.size();
   if (n < frame_size_in_byte || n % frame_size_in_byte != 0){  //check that block is multiple of 40
     EUDAQ_ERROR("Error: Incomplete Data Block. Block size is "+std::to_string(n)+", but should be multiple of 40");
@@ -463,17 +463,16 @@ bool OPAMPRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,
   // Signal from the scope
   int tot_scope_channels = conf.number_pixels_scope;
   if(conf.check_LGAD_signal) tot_scope_channels = conf.number_pixels_scope + 1;
-  std::vector<std::vector<uint8_t>> raw_block_osch; // vector's vector
+  std::vector<const eudaq::EventBlock*> raw_block_osch; // views into the event, no copy
   for(int i_ch =0; i_ch != tot_scope_channels; i_ch++){
-  std::vector<uint8_t> temp_vec = rawev->GetBlock(i_ch+2); // temp vector inside the for loop
-  raw_block_osch.push_back(temp_vec); 
+  raw_block_osch.push_back(&rawev->GetBlockView(i_ch+2));
   }
 
   //find t0 
   int osc_t0[conf.number_pixels_scope];
   for (int i = 0; i != conf.number_pixels_scope; ++i){
     if (!conf.estimate_noise_scope){
-     osc_t0[i] = find_edge(raw_block_osch[i].data(), conf.threshold_cut_t0_finder_opamp_scope, conf.n_points_t0_finder_opamp_scope); //this is the frame number. The threshold and number of points have been optimized in dedicated study.
+     osc_t0[i] = find_edge(raw_block_osch[i]->data(), conf.threshold_cut_t0_finder_opamp_scope, conf.n_points_t0_finder_opamp_scope); //this is the frame number. The threshold and number of points have been optimized in dedicated study.
     }
     else osc_t0[i]=conf.noise_t0_sample_scope; //set artifically t0 sample in a region in which there's no signal
   }
@@ -482,19 +481,19 @@ bool OPAMPRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,
   float osc_baseline[conf.number_pixels_scope];
   bool hasSignalLGAD = false;
   for (int i = 0; i != conf.number_pixels_scope; ++i){
-    osc_baseline[i] = WaveformAverage<uint8_t, int8_t>(raw_block_osch[i].data(),conf.n_samples_baseline_opamp_scope,osc_t0[i]-conf.baseline_shifting_from_t0_opamp_scope);
+    osc_baseline[i] = WaveformAverage<uint8_t, int8_t>(raw_block_osch[i]->data(),conf.n_samples_baseline_opamp_scope,osc_t0[i]-conf.baseline_shifting_from_t0_opamp_scope);
   }
 
   for (int i = 0; i != conf.number_pixels_scope; ++i){
     if (osc_t0[i] < 0) signal[i] = 0; // without t0 amplitude is meaningless. //use -9999 for noise measurements
-    else signal[i] = WaveformAverage<uint8_t, int8_t>(raw_block_osch[i].data(),conf.n_samples_signal_opamp_scope,osc_t0[i]+conf.underline_delay_from_t0_opamp_scope)-osc_baseline[i];
+    else signal[i] = WaveformAverage<uint8_t, int8_t>(raw_block_osch[i]->data(),conf.n_samples_signal_opamp_scope,osc_t0[i]+conf.underline_delay_from_t0_opamp_scope)-osc_baseline[i];
     signal[i] = (signal[i]*conf.total_electron_from_source)/conf.Mn_Ka[conf.px_idx_scope[i]]; //signal converted in electrons
     plane.SetPixel(conf.px_idx_scope[i],conf.px_x_scope[i],conf.px_y_scope[i], -signal[i] * conf.scope_charge_conversion_factor_opamp_scope,(uint64_t)osc_t0[i]); // pixel readout via scope, 0.625mV is the scope amplitude unit 
     if(conf.estimate_noise_daq && !conf.estimate_noise_scope) plane.SetPixel(conf.px_idx_scope[i],conf.px_x_scope[i],conf.px_y_scope[i], std::numeric_limits<float>::max()); // to prevent to have a 0 peak from the scope pixels
   }
   // LGAD Check
   if(conf.check_LGAD_signal) {
-    auto newWF = GetAveragedWaveform(raw_block_osch[tot_scope_channels-1].data(), raw_block_osch[tot_scope_channels-1].size(), conf.n_points_average_waveform, conf.osc_first_sample);
+    auto newWF = GetAveragedWaveform(raw_block_osch[tot_scope_channels-1]->data(), raw_block_osch[tot_scope_channels-1]->size(), conf.n_points_average_waveform, conf.osc_first_sample);
 
     hasSignalLGAD = HasLGADSignal(newWF.data(), conf.threshold_lgad_signal/conf.scope_charge_conversion_factor_opamp_scope, conf.osc_first_sample);
   }
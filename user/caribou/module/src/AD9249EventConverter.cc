@@ -32,7 +32,7 @@ std::vector<TF1>
   AD9249Event2StdEventConverter::m_calib_functions(16, TF1());
 
 void AD9249Event2StdEventConverter::decodeChannel(
-    const size_t adc, const std::vector<uint8_t> &data, size_t size,
+    const size_t adc, const eudaq::EventBlock &data, size_t size,
     size_t offset, std::vector<std::vector<uint16_t> > &waveforms,
     uint64_t &timestamp) const {
 
@@ -132,7 +132,7 @@ AD9249Event2StdEventConverter::Converting(eudaq::EventSPC d1,
               to_string(trig_));
 
   const size_t header_offset = 8;
-  auto datablock0 = ev->GetBlock(0);
+  const auto &datablock0 = ev->GetBlockView(0);
 
   // Get configured burst length from header:
   uint32_t burst_length =
@@ -89,7 +89,7 @@ bool DSO9254AEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Stan
   }
 
  // all four scope channels and digital channels in one data block
-  auto datablock = ev->GetBlock(0);
+  const auto &datablock = ev->GetBlockView(0);
   // Calulate positions and length of data blocks:
   // FIXME FIXME FIXME by Simon: this is prone to break since you are selecting bits from a 64bit
   //                             word - but there is no guarantee in the endianness here and you
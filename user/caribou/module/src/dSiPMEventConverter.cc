@@ -85,9 +85,9 @@ bool dSiPMEvent2StdEventConverter::Converting(
   // Retrieve data from event
   if (ev->NumBlocks() == 1) {
 
-    // contains all data, split it into timestamps and pixel data, returned as
-    // std::vector<uint8_t>
-    auto datablock = ev->GetBlock(0);
+    // contains all data, split it into timestamps and pixel data (read in
+    // place, no copy)
+    const auto &datablock = ev->GetBlockView(0);
 
     // get number of words in datablock
     auto data_length = datablock.size();
@@ -32,6 +32,8 @@ class NiController {
   bool DataTransportClientSocket_Select();
   unsigned int DataTransportClientSocket_ReadLength();
   std::vector<unsigned char> DataTransportClientSocket_ReadData(int datalength);
+  // reads straight into data, which holds datalength bytes
+  void DataTransportClientSocket_ReadData(unsigned char *data, int datalength);
   void ConfigClientSocket_Open(const std::string& addr, uint16_t port);
   void ConfigClientSocket_Close();
   bool ConfigClientSocket_Select();
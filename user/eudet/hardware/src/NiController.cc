@@ -234,39 +234,24 @@ NiController::DataTransportClientSocket_ReadLength() {
 std::vector<unsigned char>
 NiController::DataTransportClientSocket_ReadData(int datalength) {
   std::vector<unsigned char> mimosa_data(datalength);
-  unsigned int stored_bytes;
-  unsigned int read_bytes_left;
-  unsigned int i;
-  bool dbg = false;
+  DataTransportClientSocket_ReadData(mimosa_data.data(), datalength);
+  return mimosa_data;
+}
 
-  stored_bytes = 0;
-  read_bytes_left = datalength;
-  int numbytes;
-  while (read_bytes_left > 0) {
-    if ((numbytes = recv(m_sock_datatransport, m_buffer_data, read_bytes_left, 0)) == -1) {
+void NiController::DataTransportClientSocket_ReadData(unsigned char *data, int datalength) {
+  int stored_bytes = 0;
+  while (stored_bytes < datalength) {
+    int numbytes = recv(m_sock_datatransport, reinterpret_cast<char *>(data) + stored_bytes,
+                        datalength - stored_bytes, 0);
+    if (numbytes == -1) {
       perror("recv()");
       EUDAQ_THROW("DataTransportSocket: Read data error ");
-    } else {
-      if (dbg)
-        printf("|==DataTransportClientSocket_ReadData==|    numbytes=%u \n",
-               static_cast<uint32_t>(numbytes));
-      read_bytes_left = read_bytes_left - numbytes;
-      for (int k = 0; k < numbytes; k++) {
-        mimosa_data[stored_bytes] = m_buffer_data[k];
-        stored_bytes++;
-      }
-      i = 0;
-      if (dbg) {
-        while ((int)i < numbytes) {
-          printf(" 0x%x%x", 0xFF & m_buffer_data[i], 0xFF & m_buffer_data[i + 1]);
-          i = i + 2;
-        }
-      }
     }
+    if (numbytes == 0) {
+      EUDAQ_THROW("DataTransportSocket: Connection closed while reading data");
+    }
+    stored_bytes += numbytes;
   }
-  if (dbg)
-    printf("\n");
-  return mimosa_data;
 }
 
 void NiController::DatatransportClientSocket_Close() {
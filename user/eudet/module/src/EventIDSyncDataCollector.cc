@@ -1,22 +1,29 @@
 #include "eudaq/DataCollector.hh"
-//#include "eudaq/Event.hh"
+#include "eudaq/TriggerEventBuilder.hh"
+#include "eudaq/Event.hh"
 
-//#include <deque>
-//#include <map>
-//#include <string>
+#include <mutex>
+#include <map>
+#include <string>
 
 namespace eudaq {
   class EventIDSyncDataCollector:public DataCollector{
     public:
       using DataCollector::DataCollector;
+      void DoConfigure() override;
       void DoStartRun() override;
       void DoConnect(ConnectionSPC /*id*/) override;
       void DoDisconnect(ConnectionSPC /*id*/) override;
       void DoReceive(ConnectionSPC id, EventSP ev) override;
+      void DoStatus() override;
+      void DoIdle() override;
       static const uint32_t m_id_factory = eudaq::cstr2hash("EventIDSyncDataCollector");
 
     private:
-      std::map<std::string, std::deque<EventSPC>> m_que_event;
+      void BuildEvents();
+
+      TriggerEventBuilder m_builder;
+      std::map<std::string, uint32_t> m_stream_id;
       std::mutex m_mtx_map;
   };
 
@@ -26,10 +33,18 @@ namespace eudaq {
       (EventIDSyncDataCollector::m_id_factory);
   }
 
+  void EventIDSyncDataCollector::DoConfigure(){
+    auto conf = GetConfiguration();
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    m_builder.SetReorderWindow(conf->Get("TG_REORDER_WINDOW", 0));
+    m_builder.SetTimeout(std::chrono::milliseconds(conf->Get("TG_TIMEOUT_MS", 0)));
+  }
+
   void EventIDSyncDataCollector::DoStartRun(){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    for(auto &que :m_que_event){
-      que.second.clear();
+    m_builder.Reset();
+    for(auto &stream :m_stream_id){
+      stream.second = m_builder.AddStream();
     }
   }
 
@@ -37,43 +52,66 @@ namespace eudaq {
     std::unique_lock<std::mutex> lk(m_mtx_map);
     std::string pdc_name = id->GetName();
     EUDAQ_INFO("Producer."+pdc_name+" is connecting");
-    if(m_que_event.find(pdc_name) != m_que_event.end())
+    if(m_stream_id.find(pdc_name) != m_stream_id.end())
       EUDAQ_THROW("DataCollector::Doconnect, multiple producers are sharing a same name");
-    m_que_event[pdc_name];
+    m_stream_id[pdc_name] = m_builder.AddStream();
   }
 
   void EventIDSyncDataCollector::DoDisconnect(ConnectionSPC id){
     std::unique_lock<std::mutex> lk(m_mtx_map);
     std::string pdc_name = id->GetName();
-    if(m_que_event.find(pdc_name) == m_que_event.end())
+    auto it = m_stream_id.find(pdc_name);
+    if(it == m_stream_id.end())
       EUDAQ_THROW("DataCollector::DisDoconnect, the disconnecting producer was not existing in list");
-    EUDAQ_WARN("Producer."+pdc_name+" is disconnected, the remaining events are erased. ("+std::to_string(m_que_event[pdc_name].size())+ " Events)");
-    m_que_event.erase(pdc_name);
+    uint32_t stream = it->second;
+    if(m_builder.GetNumMissing(stream) || m_builder.GetNumDuplicated(stream) || m_builder.GetNumLate(stream))
+      EUDAQ_WARN("Producer."+pdc_name+" is disconnected, missing "+std::to_string(m_builder.GetNumMissing(stream))+
+		 ", duplicated "+std::to_string(m_builder.GetNumDuplicated(stream))+
+		 ", late "+std::to_string(m_builder.GetNumLate(stream))+" Events");
+    // the waiting events are still built, without waiting for it
+    m_builder.CloseStream(stream);
+    m_stream_id.erase(it);
+    BuildEvents();
   }
 
   void EventIDSyncDataCollector::DoReceive(ConnectionSPC id, EventSP ev){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    std::string pdc_name = id->GetName();
-    m_que_event[pdc_name].push_back(std::move(ev));
-    uint32_t n = 0;
-    for(auto &que :m_que_event){
-      if(!que.second.empty())
-        n++;
+    auto it = m_stream_id.find(id->GetName());
+    if(it == m_stream_id.end())
+      EUDAQ_THROW("Event from the unknown producer " + id->GetName());
+    uint32_t ev_n = ev->GetEventN();
+    m_builder.Push(it->second, ev_n, std::move(ev));
+    BuildEvents();
+  }
+
+  void EventIDSyncDataCollector::DoStatus(){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    // events waiting for a silent producer are built by the timeout
+    BuildEvents();
+    uint64_t n_missing = 0;
+    uint64_t n_dropped = 0;
+    for(auto &stream :m_stream_id){
+      n_missing += m_builder.GetNumMissing(stream.second);
+      n_dropped += m_builder.GetNumDuplicated(stream.second) + m_builder.GetNumLate(stream.second);
     }
-    if(n==m_que_event.size()){
+    SetStatusTag("MissingEventN", std::to_string(n_missing));
+    SetStatusTag("DroppedEventN", std::to_string(n_dropped));
+  }
+
+  void EventIDSyncDataCollector::DoIdle(){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    BuildEvents();
+  }
+
+  void EventIDSyncDataCollector::BuildEvents(){
+    TriggerEventBuilder::Built built;
+    while(m_builder.Pop(built)){
+      if(built.events.size() < m_stream_id.size())
+	EUDAQ_WARN("EventNumbers are Mismatched, event "+std::to_string(built.trigger_n)+" is incomplete");
       auto ev_wrap = Event::MakeUnique("EventIDSyncOnline");
       ev_wrap->SetFlagPacket();
-      uint32_t ev_c = m_que_event.begin()->second.front()->GetEventN();
-      bool match = true;
-      for(auto &que :m_que_event){
-        if(ev_c != que.second.front()->GetEventN())
-          match = false;
-        ev_wrap->AddSubEvent(que.second.front());
-        que.second.pop_front();
-      }
-      if(!match){
-        EUDAQ_WARN("EventNumbers are Mismatched");
-      }
+      for(auto &subev: built.events)
+	ev_wrap->AddSubEvent(subev);
       WriteEvent(std::move(ev_wrap));
     }
   }
@@ -16,12 +16,14 @@ class NiProducer : public eudaq::Producer {
   void DoReset() override;
   void DoTerminate() override;
   void RunLoop() override;
+  void ReadFrame(std::vector<uint8_t> &buf0, std::vector<uint8_t> &buf1);
 
   static const uint32_t m_id_factory = eudaq::cstr2hash("NiProducer");
 private:
   bool m_running;
   std::shared_ptr<NiController> ni_control;
   std::vector<uint8_t> m_conf_parameters;
+  uint32_t m_frames_per_packet;
 };
 
 namespace{
@@ -30,7 +32,7 @@ namespace{
 }
 
 NiProducer::NiProducer(const std::string name, const std::string &runcontrol)
-  : eudaq::Producer(name, runcontrol), m_running(false){
+  : eudaq::Producer(name, runcontrol), m_running(false), m_frames_per_packet(1){
   m_running = false;
 }
 
@@ -38,22 +40,36 @@ NiProducer::~NiProducer(){
   m_running = false;
 }
 
+void NiProducer::ReadFrame(std::vector<uint8_t> &buf0, std::vector<uint8_t> &buf1){
+  uint32_t datalength1 = ni_control->DataTransportClientSocket_ReadLength();
+  buf0.resize(datalength1);
+  ni_control->DataTransportClientSocket_ReadData(buf0.data(), datalength1);
+  uint32_t datalength2 = ni_control->DataTransportClientSocket_ReadLength();
+  buf1.resize(datalength2);
+  ni_control->DataTransportClientSocket_ReadData(buf1.data(), datalength2);
+}
+
 void NiProducer::RunLoop(){
   uint32_t tg_h17 = 0;
   uint16_t last_tg_l15 = 0;
+  bool isbegin = true;
+  // frames are sent NiFramesPerPacket at a time, or earlier when the readout idles
+  std::vector<eudaq::EventSP> batch;
+  batch.reserve(m_frames_per_packet);
   while(m_running){
     if(!ni_control->DataTransportClientSocket_Select()){
+      if(!batch.empty()){
+	SendEvents(batch);
+	batch.clear();
+      }
       continue;
     }
-    auto evup = eudaq::Event::MakeUnique("NiRawDataEvent");
-    uint32_t datalength1 = ni_control->DataTransportClientSocket_ReadLength();
-    std::vector<uint8_t> mimosa_data_0(datalength1);
-    mimosa_data_0 = ni_control->DataTransportClientSocket_ReadData(datalength1);
-    uint32_t datalength2 = ni_control->DataTransportClientSocket_ReadLength();
-    std::vector<uint8_t> mimosa_data_1(datalength2);
-    mimosa_data_1 = ni_control->DataTransportClientSocket_ReadData(datalength2);
-    if(mimosa_data_0.size()>8){
-      uint16_t tg_l15 = 0x7fff & (mimosa_data_0[6] + (mimosa_data_0[7]<<8));
+    auto ev = eudaq::Event::MakeShared("NiRawDataEvent");
+    // the frame is read into the vectors which become the event blocks
+    std::vector<uint8_t> buf0, buf1;
+    ReadFrame(buf0, buf1);
+    if(buf0.size()>8){
+      uint16_t tg_l15 = 0x7fff & (buf0[6] + (buf0[7]<<8));
       if(tg_l15 < last_tg_l15 && last_tg_l15>0x6000 && tg_l15<0x2000){
 	tg_h17++;
 	EUDAQ_INFO("increase high 17bits of trigger number, last_tg_l15("+ 
@@ -61,27 +77,37 @@ void NiProducer::RunLoop(){
 		   std::to_string(tg_l15)+")" );
       }
       uint32_t tg_n = (tg_h17<<15) + tg_l15;
-      evup->SetTriggerN(tg_n);
+      ev->SetTriggerN(tg_n);
       last_tg_l15 = tg_l15;
     }
     
-    evup->AddBlock(0, mimosa_data_0);
-    evup->AddBlock(1, mimosa_data_1);
-    evup->AddBlock(2, m_conf_parameters);
-    SendEvent(std::move(evup));
+    ev->AddBlock(0, std::move(buf0));
+    ev->AddBlock(1, std::move(buf1));
+    // the configuration, block 2, is sent with the BORE only
+    if(isbegin){
+      isbegin = false;
+      ev->SetBORE();
+    }
+    if(m_frames_per_packet <= 1){
+      SendEvent(ev);
+      continue;
+    }
+    batch.push_back(ev);
+    if(batch.size() >= m_frames_per_packet){
+      SendEvents(batch);
+      batch.clear();
+    }
   }
+  if(!batch.empty())
+    SendEvents(batch);
   
   std::chrono::milliseconds ms_dump(1000);
   auto tp_beg = std::chrono::steady_clock::now();
   auto tp_end = tp_beg + ms_dump;
+  std::vector<uint8_t> buf0, buf1;
   while(1){
     if(ni_control->DataTransportClientSocket_Select()){
-      uint32_t datalength1 = ni_control->DataTransportClientSocket_ReadLength();
-      std::vector<uint8_t> mimosa_data_0(datalength1);
-      mimosa_data_0 = ni_control->DataTransportClientSocket_ReadData(datalength1);
-      uint32_t datalength2 = ni_control->DataTransportClientSocket_ReadLength();
-      std::vector<uint8_t> mimosa_data_1(datalength2);
-      mimosa_data_1 = ni_control->DataTransportClientSocket_ReadData(datalength2);
+      ReadFrame(buf0, buf1);
     }
     auto tp_now = std::chrono::steady_clock::now();
     if(tp_now>tp_end){
@@ -111,6 +137,7 @@ void NiProducer::DoConfigure(){
   uint32_t NiVersion = conf->Get("NiVersion", 1);
   uint32_t FPGADownload = conf->Get("FPGADownload", 1);
   uint32_t NumBoards = conf->Get("NumBoards", 6);
+  m_frames_per_packet = conf->Get("NiFramesPerPacket", 1);
   std::vector<uint32_t> MimosaID(6);
   std::vector<uint32_t> MimosaEn(6,0);
   for (size_t i = 0; i < NumBoards; i++){    
@@ -129,6 +156,7 @@ void NiProducer::DoConfigure(){
   m_conf_parameters[7] = MimosaEn[5];
   m_conf_parameters[8] = NumBoards;
   m_conf_parameters[9] = FPGADownload;
+  SetRunBlock(2, m_conf_parameters);
   ni_control->ConfigClientSocket_Send("conf");
   ni_control->ConfigClientSocket_Send(m_conf_parameters);
   uint32_t ConfDataLength = ni_control->ConfigClientSocket_ReadLength();
@@ -1,9 +1,8 @@
 #include "eudaq/DataCollector.hh"
+#include "eudaq/TriggerEventBuilder.hh"
 
-//#include <mutex>
-//#include <deque>
-//#include <map>
-#include <set>
+#include <mutex>
+#include <map>
 
 namespace eudaq {
   class TriggerIDSyncDataCollector:public DataCollector{
@@ -15,12 +14,16 @@ namespace eudaq {
       void DoConfigure() override;
       void DoReset() override;
       void DoReceive(ConnectionSPC id, EventSP ev) override;
+      void DoStatus() override;
+      void DoIdle() override;
       static const uint32_t m_id_factory = cstr2hash("TriggerIDSyncDataCollector");
 
     private:
+      void BuildEvents();
+
       std::mutex m_mtx_map;
-      std::map<ConnectionSPC, std::deque<EventSPC>> m_conn_evque;
-      std::set<ConnectionSPC> m_conn_inactive;
+      TriggerEventBuilder m_builder;
+      std::map<ConnectionSPC, uint32_t> m_stream_id;
       uint32_t m_noprint;
   };
 
@@ -32,22 +35,25 @@ namespace eudaq {
 
   TriggerIDSyncDataCollector::TriggerIDSyncDataCollector(const std::string &name,
       const std::string &rc):
-    DataCollector(name, rc){
+    DataCollector(name, rc), m_noprint(0){
     }
 
   void TriggerIDSyncDataCollector::DoConnect(ConnectionSPC idx){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    m_conn_evque[idx].clear();
-    m_conn_inactive.erase(idx);
+    if(m_stream_id.empty())
+      m_builder.Reset();
+    m_stream_id[idx] = m_builder.AddStream();
   }
 
   void TriggerIDSyncDataCollector::DoDisconnect(ConnectionSPC idx){
     std::unique_lock<std::mutex> lk(m_mtx_map);
-    m_conn_inactive.insert(idx);
-    if(m_conn_inactive.size() == m_conn_evque.size()){
-      m_conn_inactive.clear();
-      m_conn_evque.clear();
-    }
+    auto it = m_stream_id.find(idx);
+    if(it == m_stream_id.end())
+      return;
+    // the waiting events are still built, without waiting for it
+    m_builder.CloseStream(it->second);
+    m_stream_id.erase(it);
+    BuildEvents();
   }
 
   void TriggerIDSyncDataCollector::DoConfigure(){
@@ -56,14 +62,17 @@ namespace eudaq {
     if(conf){
       conf->Print();
       m_noprint = conf->Get("DISABLE_PRINT", 0);
+      std::unique_lock<std::mutex> lk(m_mtx_map);
+      m_builder.SetReorderWindow(conf->Get("TG_REORDER_WINDOW", 0));
+      m_builder.SetTimeout(std::chrono::milliseconds(conf->Get("TG_TIMEOUT_MS", 0)));
     }
   }
 
   void TriggerIDSyncDataCollector::DoReset(){
     std::unique_lock<std::mutex> lk(m_mtx_map);
     m_noprint = 0;
-    m_conn_evque.clear();
-    m_conn_inactive.clear();
+    m_builder.Reset();
+    m_stream_id.clear();
   }
 
   void TriggerIDSyncDataCollector::DoReceive(ConnectionSPC idx, EventSP evsp){
@@ -71,45 +80,45 @@ namespace eudaq {
     if(!evsp->IsFlagTrigger()){
       EUDAQ_THROW("!evsp->IsFlagTrigger()");
     }
-    m_conn_evque[idx].push_back(evsp);
+    auto it = m_stream_id.find(idx);
+    // DoReset() forgets the connections before the receiver has stopped,
+    // their events in flight still come
+    if(it == m_stream_id.end())
+      it = m_stream_id.emplace(idx, m_builder.AddStream()).first;
+    m_builder.Push(it->second, evsp);
+    BuildEvents();
+  }
 
-    uint32_t trigger_n = -1;
-    for(auto &conn_evque: m_conn_evque){
-      if(conn_evque.second.empty())
-        return;
-      else{
-        uint32_t trigger_n_ev = conn_evque.second.front()->GetTriggerN();
-        if(trigger_n_ev< trigger_n)
-          trigger_n = trigger_n_ev;
-      }
+  void TriggerIDSyncDataCollector::DoStatus(){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    // events waiting for a silent producer are built by the timeout
+    BuildEvents();
+    uint64_t n_missing = 0;
+    uint64_t n_dropped = 0;
+    for(auto &stream: m_stream_id){
+      n_missing += m_builder.GetNumMissing(stream.second);
+      n_dropped += m_builder.GetNumDuplicated(stream.second) + m_builder.GetNumLate(stream.second);
     }
+    SetStatusTag("MissingEventN", std::to_string(n_missing));
+    SetStatusTag("DroppedEventN", std::to_string(n_dropped));
+  }
 
-    auto ev_sync = Event::MakeUnique("TriggerIDSyncOnline");
-    ev_sync->SetFlagPacket();
-    ev_sync->SetTriggerN(trigger_n);
-    for(auto &conn_evque: m_conn_evque){
-      auto &ev_front = conn_evque.second.front(); 
-      if(ev_front->GetTriggerN() == trigger_n){
-        ev_sync->AddSubEvent(ev_front);
-        conn_evque.second.pop_front();
-      }
-    }
+  void TriggerIDSyncDataCollector::DoIdle(){
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    BuildEvents();
+  }
 
-    if(!m_conn_inactive.empty()){
-      std::set<ConnectionSPC> conn_inactive_empty;
-      for(auto &conn: m_conn_inactive){
-        if(m_conn_evque.find(conn) != m_conn_evque.end() && 
-            m_conn_evque[conn].empty()){
-          m_conn_evque.erase(conn);
-          conn_inactive_empty.insert(conn);	
-        }
-      }
-      for(auto &conn: conn_inactive_empty){
-        m_conn_inactive.erase(conn);
-      }
+  void TriggerIDSyncDataCollector::BuildEvents(){
+    TriggerEventBuilder::Built built;
+    while(m_builder.Pop(built)){
+      auto ev_sync = Event::MakeUnique("TriggerIDSyncOnline");
+      ev_sync->SetFlagPacket();
+      ev_sync->SetTriggerN(built.trigger_n);
+      for(auto &subev: built.events)
+        ev_sync->AddSubEvent(subev);
+      if(!m_noprint)
+        ev_sync->Print(std::cout);
+      WriteEvent(std::move(ev_sync));
     }
-    if(!m_noprint)
-      ev_sync->Print(std::cout);
-    WriteEvent(std::move(ev_sync));
   }
 }
@@ -1,9 +1,8 @@
 #include "eudaq/DataCollector.hh"
+#include "eudaq/TriggerEventBuilder.hh"
 
 #include <mutex>
-#include <deque>
 #include <map>
-#include <set>
 
 class Ex0TgDataCollector:public eudaq::DataCollector{
 public:
@@ -14,12 +13,16 @@ class Ex0TgDataCollector:public eudaq::DataCollector{
   void DoConfigure() override;
   void DoReset() override;
   void DoReceive(eudaq::ConnectionSPC id, eudaq::EventSP ev) override;
+  void DoStatus() override;
+  void DoIdle() override;
 
   static const uint32_t m_id_factory = eudaq::cstr2hash("Ex0TgDataCollector");
 private:
+  void BuildEvent();
+
   std::mutex m_mtx_map;
-  std::map<eudaq::ConnectionSPC, std::deque<eudaq::EventSPC>> m_conn_evque;
-  std::set<eudaq::ConnectionSPC> m_conn_inactive;
+  eudaq::TriggerEventBuilder m_builder;
+  std::map<eudaq::ConnectionSPC, uint32_t> m_stream_id;
   uint32_t m_noprint;
 };
 
@@ -31,22 +34,24 @@ namespace{
 
 Ex0TgDataCollector::Ex0TgDataCollector(const std::string &name,
 				       const std::string &rc):
-  DataCollector(name, rc){
+  DataCollector(name, rc), m_noprint(0){
 }
 
 void Ex0TgDataCollector::DoConnect(eudaq::ConnectionSPC idx){
   std::unique_lock<std::mutex> lk(m_mtx_map);
-  m_conn_evque[idx].clear();
-  m_conn_inactive.erase(idx);
+  if(m_stream_id.empty())
+    m_builder.Reset();
+  m_stream_id[idx] = m_builder.AddStream();
 }
 
 void Ex0TgDataCollector::DoDisconnect(eudaq::ConnectionSPC idx){
   std::unique_lock<std::mutex> lk(m_mtx_map);
-  m_conn_inactive.insert(idx);
-  if(m_conn_inactive.size() == m_conn_evque.size()){
-    m_conn_inactive.clear();
-    m_conn_evque.clear();
-  }
+  auto it = m_stream_id.find(idx);
+  if(it == m_stream_id.end())
+    return;
+  m_builder.CloseStream(it->second);
+  m_stream_id.erase(it);
+  BuildEvent();
 }
 
 void Ex0TgDataCollector::DoConfigure(){
@@ -55,14 +60,17 @@ void Ex0TgDataCollector::DoConfigure(){
   if(conf){
     conf->Print();
     m_noprint = conf->Get("EX0_DISABLE_PRINT", 0);
+    std::unique_lock<std::mutex> lk(m_mtx_map);
+    m_builder.SetReorderWindow(conf->Get("TG_REORDER_WINDOW", 0));
+    m_builder.SetTimeout(std::chrono::milliseconds(conf->Get("TG_TIMEOUT_MS", 0)));
   }
 }
 
 void Ex0TgDataCollector::DoReset(){
   std::unique_lock<std::mutex> lk(m_mtx_map);
   m_noprint = 0;
-  m_conn_evque.clear();
-  m_conn_inactive.clear();
+  m_builder.Reset();
+  m_stream_id.clear();
 }
 
 void Ex0TgDataCollector::DoReceive(eudaq::ConnectionSPC idx, eudaq::EventSP evsp){
@@ -70,44 +78,39 @@ void Ex0TgDataCollector::DoReceive(eudaq::ConnectionSPC idx, eudaq::EventSP evsp
   if(!evsp->IsFlagTrigger()){
     EUDAQ_THROW("!evsp->IsFlagTrigger()");
   }
-  m_conn_evque[idx].push_back(evsp);
+  auto it = m_stream_id.find(idx);
+  // DoReset() forgets the connections before the receiver has stopped,
+  // their events in flight still come
+  if(it == m_stream_id.end())
+    it = m_stream_id.emplace(idx, m_builder.AddStream()).first;
+  m_builder.Push(it->second, evsp);
+  BuildEvent();
+}
 
-  uint32_t trigger_n = -1;
-  for(auto &conn_evque: m_conn_evque){
-    if(conn_evque.second.empty())
-      return;
-    else{
-      uint32_t trigger_n_ev = conn_evque.second.front()->GetTriggerN();
-      if(trigger_n_ev< trigger_n)
-	trigger_n = trigger_n_ev;
-    }
-  }
+void Ex0TgDataCollector::DoStatus(){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  BuildEvent();
+  uint64_t n_missing = 0;
+  for(auto &stream: m_stream_id)
+    n_missing += m_builder.GetNumMissing(stream.second);
+  SetStatusTag("MissingEventN", std::to_string(n_missing));
+}
 
-  auto ev_sync = eudaq::Event::MakeUnique("Ex0Tg");
-  ev_sync->SetFlagPacket();
-  ev_sync->SetTriggerN(trigger_n);
-  for(auto &conn_evque: m_conn_evque){
-    auto &ev_front = conn_evque.second.front(); 
-    if(ev_front->GetTriggerN() == trigger_n){
-      ev_sync->AddSubEvent(ev_front);
-      conn_evque.second.pop_front();
-    }
-  }
-  
-  if(!m_conn_inactive.empty()){
-    std::set<eudaq::ConnectionSPC> conn_inactive_empty;
-    for(auto &conn: m_conn_inactive){
-      if(m_conn_evque.find(conn) != m_conn_evque.end() && 
-	 m_conn_evque[conn].empty()){
-	m_conn_evque.erase(conn);
-	conn_inactive_empty.insert(conn);	
-      }
-    }
-    for(auto &conn: conn_inactive_empty){
-      m_conn_inactive.erase(conn);
-    }
+void Ex0TgDataCollector::DoIdle(){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  BuildEvent();
+}
+
+void Ex0TgDataCollector::BuildEvent(){
+  eudaq::TriggerEventBuilder::Built built;
+  while(m_builder.Pop(built)){
+    auto ev_sync = eudaq::Event::MakeUnique("Ex0Tg");
+    ev_sync->SetFlagPacket();
+    ev_sync->SetTriggerN(built.trigger_n);
+    for(auto &subev: built.events)
+      ev_sync->AddSubEvent(subev);
+    if(!m_noprint)
+      ev_sync->Print(std::cout);
+    WriteEvent(std::move(ev_sync));
   }
-  if(!m_noprint)
-    ev_sync->Print(std::cout);
-  WriteEvent(std::move(ev_sync));
 }
@@ -1,4 +1,6 @@
 #include "eudaq/DataCollector.hh"
+#include "eudaq/TimestampEventBuilder.hh"
+#include "eudaq/TriggerEventBuilder.hh"
 #include "eudaq/Event.hh"
 #include <mutex>
 #include <deque>
@@ -16,6 +18,8 @@ class Ex0TgTsDataCollector:public eudaq::DataCollector{
   void DoConnect(eudaq::ConnectionSPC id) override;
   void DoDisconnect(eudaq::ConnectionSPC id) override;
   void DoReceive(eudaq::ConnectionSPC id, eudaq::EventSP ev) override;
+  void DoStatus() override;
+  void DoIdle() override;
 
   static const uint32_t m_id_factory = eudaq::cstr2hash("Ex0TgTsDataCollector");
 private:
@@ -37,17 +41,13 @@ class Ex0TgTsDataCollector:public eudaq::DataCollector{
   
   //ts
   std::deque<eudaq::EventUP> m_que_event_wrap_ts;
-  std::map<uint32_t, std::deque<eudaq::EventSPC>> m_que_event_ts;
-  std::set<uint32_t> m_event_ready_ts;
-  uint64_t m_ts_last_end;
-  uint64_t m_ts_curr_beg;
-  uint64_t m_ts_curr_end;
+  eudaq::TimestampEventBuilder m_builder_ts;
+  std::map<uint32_t, uint32_t> m_stream_ts; //producer with open ts stream
 
   //tg
   std::deque<eudaq::EventUP> m_que_event_wrap_tg;
-  std::map<uint32_t, std::deque<eudaq::EventSPC>> m_que_event_tg;
-  std::set<uint32_t> m_event_ready_tg;
-  uint32_t m_tg_curr_n;
+  eudaq::TriggerEventBuilder m_builder_tg;
+  std::map<uint32_t, uint32_t> m_stream_tg; //producer with open tg stream
 };
 //----------DOC-MARK-----END*DEC-----DOC-MARK----------
 
@@ -59,7 +59,7 @@ namespace{
 
 Ex0TgTsDataCollector::Ex0TgTsDataCollector(const std::string &name,
 				   const std::string &runcontrol):
-  DataCollector(name, runcontrol),m_ts_last_end(0), m_ts_curr_beg(-2), m_ts_curr_end(-1){
+  DataCollector(name, runcontrol), m_pri_ts(false), m_has_all_bore(false){
   
 }
 
@@ -72,17 +72,13 @@ void Ex0TgTsDataCollector::DoStartRun(){
   m_con_has_bore.clear();
 
   m_que_event_wrap_ts.clear();
-  m_que_event_ts.clear();
-  m_event_ready_ts.clear();
-  m_ts_last_end = 0;
-  m_ts_curr_beg = -2;
-  m_ts_curr_end = -1;
+  m_builder_ts.Reset();
+  m_stream_ts.clear();
 
   //tg
   m_que_event_wrap_tg.clear();
-  m_que_event_tg.clear();
-  m_event_ready_tg.clear();
-  m_tg_curr_n = 0;
+  m_builder_tg.Reset();
+  m_stream_tg.clear();
 }
 
 void Ex0TgTsDataCollector::DoConfigure(){
@@ -90,6 +86,11 @@ void Ex0TgTsDataCollector::DoConfigure(){
   if(conf){
     conf->Print();
     m_pri_ts = conf->Get("PRIOR_TIMESTAMP", m_pri_ts?1:0);
+    m_builder_ts.SetWindow(conf->Get("TS_WINDOW", uint64_t(0)));
+    m_builder_ts.SetShareSpanning(conf->Get("TS_SHARE_SPANNING", 1));
+    m_builder_ts.SetTimeout(std::chrono::milliseconds(conf->Get("TS_STREAM_TIMEOUT_MS", 0)));
+    m_builder_tg.SetReorderWindow(conf->Get("TG_REORDER_WINDOW", 0));
+    m_builder_tg.SetTimeout(std::chrono::milliseconds(conf->Get("TG_TIMEOUT_MS", 0)));
   }
 }
 
@@ -153,6 +154,27 @@ void Ex0TgTsDataCollector::DoReceive(eudaq::ConnectionSPC idx, eudaq::EventSP ev
 }
 
 
+void Ex0TgTsDataCollector::DoStatus(){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  if(!m_has_all_bore)
+    return;
+  // streams of stalled producers are not waited for any more
+  BuildEvent_TimeStamp();
+  BuildEvent_Trigger();
+  BuildEvent_Final();
+  SetStatusTag("StalledProducerN", std::to_string(m_builder_ts.GetNumStalled()));
+  SetStatusTag("DroppedLateEventN", std::to_string(m_builder_ts.GetNumDropped()));
+}
+
+void Ex0TgTsDataCollector::DoIdle(){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  if(!m_has_all_bore)
+    return;
+  BuildEvent_TimeStamp();
+  BuildEvent_Trigger();
+  BuildEvent_Final();
+}
+
 void Ex0TgTsDataCollector::BuildEvent_Final(){
 
   if(m_pri_ts)
@@ -182,7 +204,7 @@ void Ex0TgTsDataCollector::BuildEvent_Final(){
     }
     //
     std::cout<< "ly 2\n";
-    if(!m_que_event_tg.empty())
+    if(!m_stream_tg.empty())
       if(m_que_event_wrap_tg.empty() )
 	break; //waiting ev_tg 
 
@@ -220,7 +242,7 @@ void Ex0TgTsDataCollector::BuildEvent_Final(){
     uint32_t tg_n = ev_tg->GetTriggerN();
 
     //
-    if(!m_que_event_ts.empty()) //for eore
+    if(!m_stream_ts.empty()) //for eore
       if(m_que_event_wrap_ts.empty() ||
 	 m_que_event_wrap_ts.back()->GetTimestampEnd() < ts_end)
 	break; //waiting ev_ts
@@ -250,213 +272,65 @@ void Ex0TgTsDataCollector::BuildEvent_Final(){
 }
 
 void Ex0TgTsDataCollector::AddEvent_TimeStamp(uint32_t id, eudaq::EventSPC ev){
+  auto it = m_stream_ts.find(id);
   if(ev->IsBORE()){
-    m_que_event_ts[id].clear();
-    m_que_event_ts[id].push_back(ev);
+    if(it != m_stream_ts.end())
+      m_builder_ts.CloseStream(it->second);
+    m_stream_ts[id] = m_builder_ts.AddStream();
+    it = m_stream_ts.find(id);
   }
-  else{
-    auto it_que_p = m_que_event_ts.find(id);
-    if(it_que_p == m_que_event_ts.end())
-      return;
-    else
-      it_que_p->second.push_back(ev);
-  }
-  
-  uint64_t ts_ev_beg =  ev->GetTimestampBegin();
-  uint64_t ts_ev_end =  ev->GetTimestampEnd();
-  
-  if(ts_ev_beg < m_ts_last_end){
-    ev->Print(std::cout);
-    std::cout<< "m_ts_last_end "<< m_ts_last_end<<std::endl;
-    EUDAQ_THROW("ts_ev_beg < m_ts_last_end");
-  }
-  
-  m_event_ready_ts.insert(id);
-  bool curr_ts_updated = false;
-  if(ts_ev_beg < m_ts_curr_beg){
-    m_ts_curr_beg = ts_ev_beg;
-    curr_ts_updated = true;
-  }
-  if(ts_ev_end < m_ts_curr_end){
-    m_ts_curr_end = ts_ev_end;
-    curr_ts_updated = true;
-  }
-
-  if(curr_ts_updated){
-    for(auto &que_p :m_que_event_ts){
-      auto &que = que_p.second;
-      auto &que_id = que_p.first;
-      if(!que.empty() &&
-	 (m_ts_curr_end <= que.back()->GetTimestampEnd() || que.back()->IsEORE()))
-	m_event_ready_ts.insert(que_id);
-      else
-	m_event_ready_ts.erase(que_id);
-    }
+  else if(it == m_stream_ts.end())
+    return;
+  m_builder_ts.Push(it->second, ev);
+  if(ev->IsEORE()){
+    m_builder_ts.CloseStream(it->second);
+    m_stream_ts.erase(it);
   }
 }
 
 void Ex0TgTsDataCollector::BuildEvent_TimeStamp(){
-  std::cout<< "m_event_ready_ts.size() "<< m_event_ready_ts.size()<<std::endl;
-  std::cout<< "m_que_event_ts.size() "<< m_que_event_ts.size()<<std::endl;
-  while(!m_event_ready_ts.empty() && m_event_ready_ts.size() == m_que_event_ts.size()){
-    std::cout<<"ts building main, loop\n";
-    uint64_t ts_next_end = -1;
-    uint64_t ts_next_beg = ts_next_end - 1;
+  eudaq::TimestampEventBuilder::Built built;
+  while(m_builder_ts.Pop(built)){
     auto ev_wrap = eudaq::Event::MakeUnique(GetFullName());
-    ev_wrap->SetTimestamp(m_ts_curr_beg, m_ts_curr_end);
-    std::set<uint32_t> has_eore;
-    for(auto &que_p :m_que_event_ts){
-      std::cout<<"que_p, loop\n";
-      auto &que = que_p.second;
-      auto id = que_p.first;
-      eudaq::EventSPC subev;
-      while(!que.empty()){
-	std::cout<<"!que.empty(), loop\n";
-	uint64_t ts_sub_beg = que.front()->GetTimestampBegin();
-	uint64_t ts_sub_end = que.front()->GetTimestampEnd();
-	if(ts_sub_end <= m_ts_curr_beg){
-	  std::cout<<"if 1\n";
-	  if(que.front()->IsEORE())
-	    has_eore.insert(id);
-	  que.pop_front();
-	  // if(que.empty())
-	  //   EUDAQ_THROW("There should be more data!");
-	  //It is not empty after pop. except eore
-	  continue;
-	}
-	else if(ts_sub_beg >= m_ts_curr_end){
-	  std::cout<<"if 2\n";
-	  m_event_ready_ts.insert(id);
-	  if(ts_sub_beg < ts_next_beg)
-	    ts_next_beg = ts_sub_beg;
-	  if(ts_sub_end < ts_next_end)
-	    ts_next_end = ts_sub_end;
-	  break;
-	}
-
-	subev = que.front();
-	
-	if(ts_sub_end < m_ts_curr_end){
-	  std::cout<<"if 3\n";
-	  if(que.front()->IsEORE())
-	    has_eore.insert(id);
-	  que.pop_front();
-	  // if(que.empty())
-	  //   EUDAQ_THROW("There should be more data!");
-	  //It is not empty after pop. except eore
-	  continue;
-	}
-	else if(ts_sub_end == m_ts_curr_end){
-	  std::cout<<"if 4\n";
-	  if(que.front()->IsEORE())
-	    has_eore.insert(id);
-	  que.pop_front();
-	  if(que.empty())
-	    m_event_ready_ts.erase(id);
-	  //If it is not empty after pop,
-	  //next loop will come to the case ts_sub_beg >= m_ts_curr_end,
-	  //and update ts_next_beg/end and ready flag;
-	  continue;
-	}
-
-	//ts_sub_end > m_ts_curr_end, subev is not popped.
-	//There is at least 1 event inside que. If thre are more ...
-	else
-	if(que.size()>1){
-	  std::cout<<"if 5\n";
-	  m_event_ready_ts.insert(id);
-	  uint64_t ts_sub1_beg = que.at(1)->GetTimestampBegin();
-	  uint64_t ts_sub1_end = que.at(1)->GetTimestampEnd();
-	  if(ts_sub1_beg < ts_next_beg)
-	    ts_next_beg = ts_sub1_beg;
-	  if(ts_sub1_end < ts_next_end)
-	    ts_next_end = ts_sub1_end;
-	  break;
-	}
-	else{//(que.size()==1){
-	  //long ts event, maybe eore
-	  if(!que.front()->IsEORE())
-	    m_event_ready_ts.erase(id);
-	  break;
-	}
-      }
-      if(subev){
-	if(!ev_wrap->IsFlagTrigger() && subev->IsFlagTrigger()){
-	  ev_wrap->SetTriggerN(subev->GetTriggerN());
-	}
-	ev_wrap->AddSubEvent(subev);
+    ev_wrap->SetTimestamp(built.ts_begin, built.ts_end);
+    for(auto &subev: built.events){
+      if(!ev_wrap->IsFlagTrigger() && subev->IsFlagTrigger()){
+	ev_wrap->SetTriggerN(subev->GetTriggerN());
       }
+      ev_wrap->AddSubEvent(subev);
     }
-
-    for(auto e: has_eore){
-      m_event_ready_ts.erase(e);
-      m_que_event_ts.erase(e);
-    }
-    
-    m_ts_last_end = m_ts_curr_end;
-    m_ts_curr_beg = ts_next_beg;
-    m_ts_curr_end = ts_next_end;
     m_que_event_wrap_ts.push_back(std::move(ev_wrap));
   }
 }
 
 void Ex0TgTsDataCollector::AddEvent_TriggerN(uint32_t id, eudaq::EventSPC ev){
+  auto it = m_stream_tg.find(id);
   if(ev->IsBORE()){
-    m_que_event_tg[id].clear();
-    m_que_event_tg[id].push_back(ev);
+    if(it != m_stream_tg.end())
+      m_builder_tg.CloseStream(it->second);
+    m_stream_tg[id] = m_builder_tg.AddStream();
+    it = m_stream_tg.find(id);
   }
-  else{
-    auto it_que_p = m_que_event_tg.find(id);
-    if(it_que_p == m_que_event_tg.end())
-      return;
-    else
-      it_que_p->second.push_back(ev);
-  }
-
-  if(ev->GetTriggerN() > m_tg_curr_n){
-    m_event_ready_tg.insert(id);
+  else if(it == m_stream_tg.end())
+    return;
+  m_builder_tg.Push(it->second, ev);
+  if(ev->IsEORE()){
+    m_builder_tg.CloseStream(it->second);
+    m_stream_tg.erase(it);
   }
-  
-  std::cout<< "que_size "<< m_que_event_tg[id].size()<<std::endl;
-  std::cout<< "GetTriggerN() :: m_tg_curr_n   "<<  ev->GetTriggerN() << "   "<<m_tg_curr_n<<std::endl;
 }
 
-
 void Ex0TgTsDataCollector::BuildEvent_Trigger(){
-  while(!m_event_ready_tg.empty() && m_event_ready_tg.size() ==m_que_event_tg.size()){
-    std::set<uint32_t> has_eore;
+  eudaq::TriggerEventBuilder::Built built;
+  while(m_builder_tg.Pop(built)){
     auto ev_wrap = eudaq::Event::MakeUnique(GetFullName());
-    ev_wrap->SetTriggerN(m_tg_curr_n);
-    for(auto &que_p :m_que_event_tg){
-      auto &que = que_p.second;
-      auto id = que_p.first;
-      while(!que.empty() && que.front()->GetTriggerN() <= m_tg_curr_n){
-	if(que.front()->GetTriggerN() == m_tg_curr_n){
-	  if(!ev_wrap->IsFlagTimestamp() &&  que.front()->IsFlagTimestamp()){
-	    ev_wrap->SetTimestamp(que.front()->GetTimestampBegin(), que.front()->GetTimestampEnd());
-	  }
-	  ev_wrap->AddSubEvent(que.front());
-	}
-	if(que.front()->IsEORE()){
-	  has_eore.insert(id);
-	}
-	que.pop_front();
+    ev_wrap->SetTriggerN(built.trigger_n);
+    for(auto &subev: built.events){
+      if(!ev_wrap->IsFlagTimestamp() && subev->IsFlagTimestamp()){
+	ev_wrap->SetTimestamp(subev->GetTimestampBegin(), subev->GetTimestampEnd());
       }
-      if(!que.empty() && (que.back()->GetTriggerN() > m_tg_curr_n+1 || que.back()->IsEORE()))
-	m_event_ready_tg.insert(id);
-      else
-	m_event_ready_tg.erase(id);
-    }
-    m_tg_curr_n ++;
-
-    for(auto e: has_eore){
-      m_event_ready_tg.erase(e);
-      m_que_event_tg.erase(e);   
-    }
-    
-    if(ev_wrap->GetNumSubEvent()){
-      // ev_wrap->Print(std::cout);
-      m_que_event_wrap_tg.push_back(std::move(ev_wrap));
+      ev_wrap->AddSubEvent(subev);
     }
+    m_que_event_wrap_tg.push_back(std::move(ev_wrap));
   }
 }
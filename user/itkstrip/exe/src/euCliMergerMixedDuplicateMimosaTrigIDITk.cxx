@@ -2,6 +2,7 @@
 #include "eudaq/DataConverter.hh"
 #include "eudaq/FileWriter.hh"
 #include "eudaq/FileReader.hh"
+#include "eudaq/TriggerEventBuilder.hh"
 #include <iostream>
 
 #include "eudaq/DataCollector.hh"
@@ -56,109 +57,91 @@ int main(int /*argc*/, const char **argv) {
   if(!type_out.empty())
       writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash(type_out), outfile_path);
 
-  uint32_t event_count = 0;
-  uint32_t trigger_count = 0;
+  eudaq::TriggerEventBuilder builder;
+  const uint32_t id_fasts = builder.AddStream();
+  const uint32_t id_ni = builder.AddStream();
 
   auto ev_fasts = reader_fasts->GetNextEvent();
-
   auto ev_ni = reader_ni->GetNextEvent();
-  auto ev_ni_next = reader_ni->GetNextEvent();
-
-  std::cout << "Trigger IDs:" << ev_fasts->GetTriggerN() << " " 
-    << ev_ni->GetTriggerN() << std::endl;
-
-  //bool ni_event_missing = false;
-
-  //This loop is to deal with the issue where some trigger numbers start at 0 and others at 1.
-  while(ev_fasts->GetTriggerN() > ev_ni->GetTriggerN()){
-    ev_ni = ev_ni_next;
-    ev_ni_next = reader_ni->GetNextEvent();
-    //ev_ni = reader_ni->GetNextEvent();
-    std::cout << "Counting up NI events to correct starting trigger ID..." << std::endl;
-
-    //Probably redundant...
-    if(!ev_ni){
-      break;
-    }
-  }
-  //This loop assumes that the FASTS are always in sync. Might not be the case...
-  while(ev_fasts->GetTriggerN() < ev_ni->GetTriggerN()){
-    ev_fasts = reader_fasts->GetNextEvent();
-    std::cout << "Counting up FASTS events to correct starting trigger ID..." << std::endl;
-
-    if(!ev_fasts){
-      break;
-    }
-
+  if(!ev_fasts || !ev_ni){
+    std::cout << "No FASTS or NI events..." << std::endl;
+    return 1;
   }
 
   int sync_event_number = 0;
-
   const uint32_t run_number = ev_fasts->GetRunN();
 
-  while(1){
-
-      if(!ev_fasts)
-      {
+  // Both files are in trigger order. The stream which is behind is fed
+  // first, so the builder only holds the events of a few triggers; a
+  // trigger is built once both streams have gone past it, or once the
+  // other stream has ended.
+  eudaq::TriggerEventBuilder::Built built;
+  eudaq::EventSPC ev_ni_last;
+  uint32_t ev_ni_last_n = 0;
+  while(ev_fasts || ev_ni){
+    if(ev_fasts && (!ev_ni || ev_fasts->GetTriggerN() <= ev_ni->GetTriggerN())){
+      if(print_ev_in)
+        ev_fasts->Print(std::cout);
+      builder.Push(id_fasts, ev_fasts);
+      ev_fasts = reader_fasts->GetNextEvent();
+      if(!ev_fasts){
         std::cout << "No more FASTS events..." << std::endl;
-        break;
+        builder.CloseStream(id_fasts);
+      }
+    }
+    else{
+      if(print_ev_in)
+        ev_ni->Print(std::cout);
+      ev_ni_last_n = ev_ni->GetTriggerN();
+      builder.Push(id_ni, ev_ni);
+      ev_ni = reader_ni->GetNextEvent();
+      if(!ev_ni){
+        std::cout << "No more NI events..." << std::endl;
+        builder.CloseStream(id_ni);
+      }
+    }
+    while(builder.Pop(built)){
+      // the NI frame spans several triggers in mixed mode, every FASTS
+      // event goes with the last NI event up to its trigger number
+      eudaq::EventSPC ev_f;
+      for(size_t i = 0; i < built.events.size(); i++){
+        if(built.streams[i] == id_ni)
+          ev_ni_last = built.events[i];
+        else
+          ev_f = built.events[i];
+      }
+      if(!ev_f)
+        continue;
+      // no NI frame is known beyond the last NI event
+      if(!ev_ni && built.trigger_n > ev_ni_last_n)
+        continue;
+      if(!ev_ni_last){
+        std::cout << "No NI event up to trigger ID " << built.trigger_n
+            << ", FASTS event skipped..." << std::endl;
+        continue;
       }
-
-
-      // initialise new event
       auto ev_sync = eudaq::Event::MakeUnique("MimosaFasts");
-      //ev_sync = ev_fasts; // eudaq::Event::MakeUnique("MimosaFasts");
       ev_sync->SetFlagPacket(); // copy from Ex0Tg
-      ev_sync->SetTriggerN(ev_fasts->GetTriggerN());
+      ev_sync->SetTriggerN(built.trigger_n);
       ev_sync->SetEventN(sync_event_number);
       ev_sync->SetRunN(run_number);
-
-
-
+      ev_sync->AddSubEvent(ev_ni_last);
+      uint32_t n = ev_f->GetNumSubEvent();
+      for(uint32_t i = 0; i < n; i++)
+        ev_sync->AddSubEvent(ev_f->GetSubEvent(i));
       std::cout << "Sync Event " << sync_event_number
-          << " created, Trigger IDs:" << ev_fasts->GetTriggerN() << " " 
-          << ev_ni->GetTriggerN() << std::endl;
-
-      ev_sync->AddSubEvent(ev_ni);
-      uint32_t n = ev_fasts->GetNumSubEvent();
-      for(uint32_t i = 0; i < n; i++){
-        auto ev_fasts_sub = ev_fasts->GetSubEvent(i);
-        ev_sync->AddSubEvent(ev_fasts_sub);
-      }
-
-      if(writer) writer->WriteEvent(std::move(ev_sync));
-      std::cout << "Sync event written..." << std::endl;
-
-      // get next events
-      ev_fasts = reader_fasts->GetNextEvent();
-      if(ev_ni_next->GetTriggerN() == ev_fasts->GetTriggerN())
-      {
-        ev_ni = ev_ni_next;
-        ev_ni_next = reader_ni->GetNextEvent();
-      }
-
-
-      if(!ev_fasts){
-        std::cout << "No more FASTS events..." << std::endl;
-        break;
-      }
-      if(!ev_ni_next){
-        std::cout << "No more NI events..." << std::endl;
-        break;
-      }
-
+          << " created, Trigger IDs:" << built.trigger_n << " "
+          << ev_ni_last->GetTriggerN() << std::endl;
+      if(writer)
+        writer->WriteEvent(std::move(ev_sync));
       sync_event_number++;
-
-      // if(!ev_fasts){
-      //   std::cout << "No more FASTS events..." << std::endl;
-      //   break;
-      // }
-
-      std::cout << "Next event retrieved..." << std::endl;
-
-
     }
+  }
 
-
+  std::cout << sync_event_number << " sync events written, "
+      << "FASTS missing " << builder.GetNumMissing(id_fasts)
+      << " duplicated " << builder.GetNumDuplicated(id_fasts)
+      << ", NI missing " << builder.GetNumMissing(id_ni)
+      << " duplicated " << builder.GetNumDuplicated(id_ni) << std::endl;
   return 0;
 }
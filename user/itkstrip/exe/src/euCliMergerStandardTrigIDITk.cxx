@@ -2,6 +2,7 @@
 #include "eudaq/DataConverter.hh"
 #include "eudaq/FileWriter.hh"
 #include "eudaq/FileReader.hh"
+#include "eudaq/TriggerEventBuilder.hh"
 #include <iostream>
 
 #include "eudaq/DataCollector.hh"
@@ -56,112 +57,72 @@ int main(int /*argc*/, const char **argv) {
   if(!type_out.empty())
       writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash(type_out), outfile_path);
 
-  uint32_t event_count = 0;
-  uint32_t trigger_count = 0;
-
-  auto ev_fasts = reader_fasts->GetNextEvent(); // was ev_slow
-  auto ev_ni = reader_ni->GetNextEvent(); // was ev_fast
-
+  eudaq::TriggerEventBuilder builder;
+  const uint32_t id_fasts = builder.AddStream();
+  const uint32_t id_ni = builder.AddStream();
 
+  auto ev_fasts = reader_fasts->GetNextEvent();
+  auto ev_ni = reader_ni->GetNextEvent();
+  if(!ev_fasts || !ev_ni){
+    std::cout << "No FASTS or NI events..." << std::endl;
+    return 1;
+  }
 
   int sync_event_number = 0;
   const uint32_t run_number = ev_fasts->GetRunN();
 
-
-  while(1){
-
-      if(!ev_fasts)
-      {
+  // Both files are in trigger order. The stream which is behind is fed
+  // first, so the builder only holds the events of a few triggers; a
+  // trigger is built once both streams have gone past it, or once the
+  // other stream has ended.
+  eudaq::TriggerEventBuilder::Built built;
+  while(ev_fasts || ev_ni){
+    if(ev_fasts && (!ev_ni || ev_fasts->GetTriggerN() <= ev_ni->GetTriggerN())){
+      if(print_ev_in)
+        ev_fasts->Print(std::cout);
+      builder.Push(id_fasts, ev_fasts);
+      ev_fasts = reader_fasts->GetNextEvent();
+      if(!ev_fasts){
         std::cout << "No more FASTS events..." << std::endl;
-        break;
+        builder.CloseStream(id_fasts);
       }
-
-      // initialise new event
-      auto ev_sync =  eudaq::Event::MakeUnique("MimosaFasts");
-      ev_sync->SetFlagPacket(); // copy from Ex0Tg
-      ev_sync->SetTriggerN(ev_fasts->GetTriggerN());
-      ev_sync->SetEventN(sync_event_number);
-      ev_sync->SetRunN(run_number);
-
-
-      //std::cout << "Sync Event created..." << std::endl;
-
-      //Now get the NI events matching the FASTS event trigger ID
-
-      if(ev_ni){
-        while(ev_fasts->GetTriggerN() > ev_ni->GetTriggerN()){
-          ev_ni = reader_ni->GetNextEvent();
-
-          if(!ev_ni){
-            std::cout << "No more NI events..." << std::endl;
-            break;
-          }
-        }
-      }
-
+    }
+    else{
+      if(print_ev_in)
+        ev_ni->Print(std::cout);
+      builder.Push(id_ni, ev_ni);
+      ev_ni = reader_ni->GetNextEvent();
       if(!ev_ni){
         std::cout << "No more NI events..." << std::endl;
-        break;
-      }
-
-
-
-
-      std::cout << "NI matched with FASTS..." << std::endl;
-
-      //Now the FASTS and NI should be in ev_sync
-
-      if(ev_fasts){
-        while(ev_fasts->GetTriggerN() > ev_fasts->GetTriggerN()){
-          ev_fasts = reader_fasts->GetNextEvent();
-
-          if(!ev_fasts){
-            std::cout << "No more FAST events..." << std::endl;
-            break;
-          }
-        }
+        builder.CloseStream(id_ni);
       }
-
-      if(!ev_fasts){
-        std::cout << "No more FASTS events..." << std::endl;
-        break;
-      }
-
-
+    }
+    while(builder.Pop(built)){
+      // only the triggers both streams delivered are written
+      if(built.events.size() != 2)
+        continue;
+      auto ev_sync = eudaq::Event::MakeUnique("MimosaFasts");
+      ev_sync->SetFlagPacket(); // copy from Ex0Tg
+      ev_sync->SetTriggerN(built.trigger_n);
+      ev_sync->SetEventN(sync_event_number);
+      ev_sync->SetRunN(run_number);
+      auto &ev_f = built.events[0];
+      uint32_t n = ev_f->GetNumSubEvent();
+      for(uint32_t i = 0; i < n; i++)
+        ev_sync->AddSubEvent(ev_f->GetSubEvent(i));
+      ev_sync->AddSubEvent(built.events[1]);
       std::cout << "Sync Event " << sync_event_number
-          << " created, Trigger IDs:" << ev_fasts->GetTriggerN() << " " 
-          << ev_ni->GetTriggerN() << std::endl;
-
-      //ev_sync->AddSubEvent(ev_fasts);
-      uint32_t n = ev_fasts->GetNumSubEvent();
-      for(uint32_t i = 0; i < n; i++){
-        auto ev_fasts_sub = ev_fasts->GetSubEvent(i);
-        ev_sync->AddSubEvent(ev_fasts_sub);
-      }
-
-      if(ev_fasts->GetTriggerN() == ev_ni->GetTriggerN()) ev_sync->AddSubEvent(ev_ni);
-
-      //std::cout << "Sub events added..." << std::endl;
-
-      if(writer && ev_fasts->GetTriggerN() == ev_ni->GetTriggerN()){
-          writer->WriteEvent(std::move(ev_sync));
-          std::cout << "Synch event written..." << std::endl;
-          sync_event_number++;
-      }
-
-      ev_fasts = reader_fasts->GetNextEvent();
-
-
-      if(!ev_fasts){
-        std::cout << "No more FASTS events..." << std::endl;
-        break;
-      }
-
-      std::cout << "Next FASTS event retrieved..." << std::endl;
-
-
+          << " created, Trigger ID:" << built.trigger_n << std::endl;
+      if(writer)
+        writer->WriteEvent(std::move(ev_sync));
+      sync_event_number++;
     }
+  }
 
-
+  std::cout << sync_event_number << " sync events written, "
+      << "FASTS missing " << builder.GetNumMissing(id_fasts)
+      << " duplicated " << builder.GetNumDuplicated(id_fasts)
+      << ", NI missing " << builder.GetNumMissing(id_ni)
+      << " duplicated " << builder.GetNumDuplicated(id_ni) << std::endl;
   return 0;
 }
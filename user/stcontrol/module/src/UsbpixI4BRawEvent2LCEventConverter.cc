@@ -21,12 +21,12 @@ class UsbpixI4BRawEvent2LCEventConverter: public eudaq::LCEventConverter{
   static const uint32_t m_id_factory = eudaq::cstr2hash("USBPIXI4B");
 private:
 
-  uint32_t getWord(const std::vector<uint8_t>& data, size_t index) const;
-  eudaq::StandardPlane ConvertPlane(const std::vector<uint8_t> & data, uint32_t id) const;
-  bool isEventValid(const std::vector<uint8_t> & data) const;
+  uint32_t getWord(const eudaq::EventBlock &data, size_t index) const;
+  eudaq::StandardPlane ConvertPlane(const eudaq::EventBlock &data, uint32_t id) const;
+  bool isEventValid(const eudaq::EventBlock &data) const;
   bool getHitData(uint32_t &Word, bool second_hit,
 		  uint32_t &Col, uint32_t &Row, uint32_t &ToT) const;
-  uint32_t getTrigger(const std::vector<uint8_t> & data) const;
+  uint32_t getTrigger(const eudaq::EventBlock &data) const;
 
   static const uint32_t CHIP_MIN_COL = 1;
   static const uint32_t CHIP_MAX_COL = 80;
@@ -75,7 +75,7 @@ Converting(eudaq::EventSPC d1, eudaq::LCEventSP d2, eudaq::ConfigurationSPC conf
 
   auto block_n_list = ev_raw->GetBlockNumList();
   for(auto &chip: block_n_list){
-    auto buffer = ev_raw->GetBlock(chip);
+    const auto &buffer = ev_raw->GetBlockView(chip);
     int sensorID  = chip + chip_id_offset + first_sensor_id;
 
     lcio::TrackerDataImpl *zsFrame = new lcio::TrackerDataImpl;
@@ -119,7 +119,7 @@ Converting(eudaq::EventSPC d1, eudaq::LCEventSP d2, eudaq::ConfigurationSPC conf
 }
 
 bool UsbpixI4BRawEvent2LCEventConverter::
-isEventValid(const std::vector<uint8_t> & data) const{
+isEventValid(const eudaq::EventBlock &data) const{
   //ceck data consistency
   uint32_t dh_found = 0;
   for (size_t i=0; i < data.size()-8; i += 4){
@@ -182,7 +182,7 @@ getHitData(uint32_t &Word, bool second_hit,
 }
 
 uint32_t UsbpixI4BRawEvent2LCEventConverter::
-getTrigger(const std::vector<uint8_t> & data) const{
+getTrigger(const eudaq::EventBlock &data) const{
   //Get Trigger Number and check for errors
   uint32_t i = data.size() - 8; //splitted in 2x 32bit words
   uint32_t Trigger_word1 = getWord(data, i);
@@ -196,7 +196,7 @@ getTrigger(const std::vector<uint8_t> & data) const{
 }
 
 uint32_t UsbpixI4BRawEvent2LCEventConverter::
-getWord(const std::vector<uint8_t>& data, size_t index) const{
+getWord(const eudaq::EventBlock &data, size_t index) const{
   return (((uint32_t)data[index + 3]) << 24) | (((uint32_t)data[index + 2]) << 16)
     | (((uint32_t)data[index + 1]) << 8) | (uint32_t)data[index];
 }
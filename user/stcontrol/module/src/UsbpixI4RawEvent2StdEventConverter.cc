@@ -26,12 +26,12 @@ class UsbpixrefRawEvent2StdEventConverter: public eudaq::StdEventConverter{
     static const uint32_t m_id_factory = eudaq::cstr2hash("USBPIXI4");
     private:
 
-    uint32_t getWord(const std::vector<uint8_t>& data, size_t index) const;
-  eudaq::StandardPlane ConvertPlane(const std::vector<uint8_t> & data, uint32_t id, bool swap_xy) const;
-    bool isEventValid(const std::vector<uint8_t> & data) const;
+    uint32_t getWord(const eudaq::EventBlock &data, size_t index) const;
+  eudaq::StandardPlane ConvertPlane(const eudaq::EventBlock &data, uint32_t id, bool swap_xy) const;
+    bool isEventValid(const eudaq::EventBlock &data) const;
     bool getHitData(uint32_t &Word, bool second_hit,
             uint32_t &Col, uint32_t &Row, uint32_t &ToT) const;
-    uint32_t getTrigger(const std::vector<uint8_t> & data) const;
+    uint32_t getTrigger(const eudaq::EventBlock &data) const;
 
     static const uint32_t CHIP_MIN_COL = 1;
     static const uint32_t CHIP_MAX_COL = 80;
@@ -58,13 +58,13 @@ Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSP
     bool swap_xy = ev_raw->GetTag("SWAP_XY", 0);
     auto block_n_list = ev_raw->GetBlockNumList();
     for(auto &bn: block_n_list){
-      d2->AddPlane(ConvertPlane(ev_raw->GetBlock(bn), bn+10, swap_xy));//offset 10
+      d2->AddPlane(ConvertPlane(ev_raw->GetBlockView(bn), bn+10, swap_xy));//offset 10
     }
     return true;
 }
 
 eudaq::StandardPlane UsbpixrefRawEvent2StdEventConverter::
-ConvertPlane(const std::vector<uint8_t> & data, uint32_t id, bool swap_xy) const{
+ConvertPlane(const eudaq::EventBlock &data, uint32_t id, bool swap_xy) const{
     eudaq::StandardPlane plane(id, "USBPIXI4", "USBPIXI4");
     bool valid = isEventValid(data);
     uint32_t ToT = 0;
@@ -124,7 +124,7 @@ ConvertPlane(const std::vector<uint8_t> & data, uint32_t id, bool swap_xy) const
 
 
 bool UsbpixrefRawEvent2StdEventConverter::
-isEventValid(const std::vector<uint8_t> & data) const{
+isEventValid(const eudaq::EventBlock &data) const{
     //ceck data consistency
     uint32_t dh_found = 0;
     for (size_t i=0; i < data.size()-8; i += 4){
@@ -187,7 +187,7 @@ getHitData(uint32_t &Word, bool second_hit,
 }
 
 uint32_t UsbpixrefRawEvent2StdEventConverter::
-getTrigger(const std::vector<uint8_t> & data) const{
+getTrigger(const eudaq::EventBlock &data) const{
     //Get Trigger Number and check for errors
     uint32_t i = data.size() - 8; //splitted in 2x 32bit words
     uint32_t Trigger_word1 = getWord(data, i);
@@ -201,7 +201,7 @@ getTrigger(const std::vector<uint8_t> & data) const{
 }
 
 uint32_t UsbpixrefRawEvent2StdEventConverter::
-getWord(const std::vector<uint8_t>& data, size_t index) const{
+getWord(const eudaq::EventBlock &data, size_t index) const{
     return (((uint32_t)data[index + 3]) << 24) | (((uint32_t)data[index + 2]) << 16)
         | (((uint32_t)data[index + 1]) << 8) | (uint32_t)data[index];
 }
@@ -10,15 +10,17 @@ namespace eudaq {
   class Timepix3RawEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
+    void Reset() override;
     static const uint32_t m_id_factory = eudaq::cstr2hash("Timepix3RawEvent");
   private:
-    static uint64_t m_syncTime;
-    static uint64_t m_syncTime_prev;
-    static uint64_t m_delta_t0;
-    static bool m_clearedHeader;
-    static bool m_first_time;
-    static std::vector<std::vector<float>> vtot;
-    static std::vector<std::vector<float>> vtoa;
+    // per-instance run state, instances are cached per thread by StdEventConverter
+    mutable uint64_t m_syncTime = 0;
+    mutable uint64_t m_syncTime_prev = 0;
+    mutable uint64_t m_delta_t0 = 1e6;
+    mutable bool m_clearedHeader = false;
+    mutable bool m_first_time = true;
+    mutable std::vector<std::vector<float>> vtot;
+    mutable std::vector<std::vector<float>> vtoa;
 
     void loadCalibration(std::string path, char delim, std::vector<std::vector<float>>& dat) const;
   };
@@ -26,9 +28,11 @@ namespace eudaq {
   class Timepix3TrigEvent2StdEventConverter: public eudaq::StdEventConverter{
   public:
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
+    void Reset() override;
     static const uint32_t m_id_factory = eudaq::cstr2hash("Timepix3TrigEvent");
-    static long long int m_syncTimeTDC;
-    static int m_TDCoverflowCounter;
+  private:
+    mutable long long int m_syncTimeTDC = 0;
+    mutable int m_TDCoverflowCounter = 0;
   };
 
 } // namespace eudaq
@@ -10,8 +10,11 @@ namespace {
   Register<Timepix3TrigEvent2StdEventConverter>(Timepix3TrigEvent2StdEventConverter::m_id_factory);
 }
 
-long long int Timepix3TrigEvent2StdEventConverter::m_syncTimeTDC(0);
-int Timepix3TrigEvent2StdEventConverter::m_TDCoverflowCounter(0);
+void Timepix3TrigEvent2StdEventConverter::Reset(){
+  m_syncTimeTDC = 0;
+  m_TDCoverflowCounter = 0;
+}
+
 bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
 
   // Bad event
@@ -79,13 +82,15 @@ bool Timepix3TrigEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::
   return true;
 }
 
-uint64_t Timepix3RawEvent2StdEventConverter::m_syncTime(0);
-uint64_t Timepix3RawEvent2StdEventConverter::m_syncTime_prev(0);
-uint64_t Timepix3RawEvent2StdEventConverter::m_delta_t0(1e6);
-bool Timepix3RawEvent2StdEventConverter::m_clearedHeader(false);
-bool Timepix3RawEvent2StdEventConverter::m_first_time(true);
-std::vector<std::vector<float>> Timepix3RawEvent2StdEventConverter::vtot;
-std::vector<std::vector<float>> Timepix3RawEvent2StdEventConverter::vtoa;
+void Timepix3RawEvent2StdEventConverter::Reset(){
+  m_syncTime = 0;
+  m_syncTime_prev = 0;
+  m_delta_t0 = 1e6;
+  m_clearedHeader = false;
+  m_first_time = true;
+  vtot.clear();
+  vtoa.clear();
+}
 
 bool Timepix3RawEvent2StdEventConverter::Converting(eudaq::EventSPC ev, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
 
@@ -2,7 +2,68 @@
 #include "eudaq/FileReader.hh"
 #include "eudaq/StdEventConverter.hh"
 
+#include "TluRawEventRecord.hh"
+
+#include <algorithm>
 #include <iostream>
+#include <string>
+
+// One CSV line per trigger. The record in block 1 is decoded, older data
+// have the compact block 0 or the tags. Scalers and particles come with
+// the last trigger of a readout pass only, the others print NAN.
+void PrintTluEvent(const eudaq::Event &ev){
+  std::string particles = "NAN";
+  std::string triggersFired = "NAN";
+  std::string scaler[6], finets[6];
+  for(int i = 0; i < 6; i++)
+    scaler[i] = finets[i] = "NAN";
+  auto block_ids = ev.GetBlockNumList();
+  if(std::find(block_ids.begin(), block_ids.end(), TluRawEventRecord::BLOCK_ID) != block_ids.end()){
+    auto &block = ev.GetBlockView(TluRawEventRecord::BLOCK_ID);
+    TluRawEventRecord record;
+    if(record.Decode(block.data(), block.size())){
+      // as the TRIGGER tag, input 5 first
+      triggersFired.clear();
+      for(int i = 5; i >= 0; i--)
+        triggersFired += (record.inputs >> i & 0x1) ? '1' : '0';
+      for(int i = 0; i < 6; i++)
+        finets[i] = std::to_string(record.finets[i]);
+      if(record.flags & TluRawEventRecord::FLAG_SCALER){
+        particles = std::to_string(record.particles);
+        for(int i = 0; i < 6; i++)
+          scaler[i] = std::to_string(record.scaler[i]);
+      }
+    }
+  }
+  else if(ev.NumBlocks() == 1 && ev.GetBlockView(0).size() >= 7){
+    auto &data = ev.GetBlockView(0);
+    triggersFired.clear();
+    for(int i = 5; i >= 0; i--)
+      triggersFired += (data[6] >> i & 0x1) ? '1' : '0';
+    for(int i = 0; i < 6; i++)
+      finets[i] = std::to_string(data[i]);
+  }
+  else{
+    particles = ev.GetTag("PARTICLES", "NAN");
+    triggersFired = ev.GetTag("TRIGGER", "NAN");
+    for(int i = 0; i < 6; i++){
+      scaler[i] = ev.GetTag("SCALER" + std::to_string(i), "NAN");
+      finets[i] = ev.GetTag("FINE_TS" + std::to_string(i), "NAN");
+    }
+  }
+  std::cout << ev.GetRunNumber() << "," <<
+    ev.GetEventNumber() << "," <<
+    ev.GetTriggerN() << "," <<
+    ev.GetTimestampBegin() << "," <<
+    ev.GetTimestampEnd() << "," <<
+    particles << "," <<
+    triggersFired;
+  for(int i = 0; i < 6; i++)
+    std::cout << "," << scaler[i];
+  for(int i = 0; i < 6; i++)
+    std::cout << "," << finets[i];
+  std::cout << std::endl;
+}
 
 int main(int /*argc*/, const char **argv) {
   eudaq::OptionParser op("EUDAQ Command Line FileReader modified for TLU data", "2.1", "EUDAQ FileReader (TLU)");
@@ -73,75 +134,13 @@ int main(int /*argc*/, const char **argv) {
     else
       in_range_tsn = true;
 
-    if (ev->GetDescription()=="TluRawDataEvent" && in_range_evn) {
-      auto runNumber = ev->GetRunNumber();
-      auto eventNumber = ev->GetEventNumber();
-      auto triggerNumber = ev->GetTriggerN();
-      auto timeStampBegin = ev->GetTimestampBegin();
-      auto timeStampEnd = ev->GetTimestampEnd();
-      auto particles = ev->GetTag("PARTICLES", "NAN");
-      auto triggersFired = ev->GetTag("TRIGGER", "NAN");
-      auto scaler0 = ev->GetTag("SCALER0", "NAN");
-      auto scaler1 = ev->GetTag("SCALER1", "NAN");
-      auto scaler2 = ev->GetTag("SCALER2", "NAN");
-      auto scaler3 = ev->GetTag("SCALER3", "NAN");
-      auto scaler4 = ev->GetTag("SCALER4", "NAN");
-      auto scaler5 = ev->GetTag("SCALER5", "NAN");
-      auto finets0 = ev->GetTag("FINE_TS0", "NAN");
-      auto finets1 = ev->GetTag("FINE_TS1", "NAN");
-      auto finets2 = ev->GetTag("FINE_TS2", "NAN");
-      auto finets3 = ev->GetTag("FINE_TS3", "NAN");
-      auto finets4 = ev->GetTag("FINE_TS4", "NAN");
-      auto finets5 = ev->GetTag("FINE_TS5", "NAN");
-      std::cout << runNumber << "," <<
-      		   eventNumber << "," <<
-		   triggerNumber << "," <<
-		   timeStampBegin << "," <<
-		   timeStampEnd << "," <<
-		   particles << "," <<
-		   triggersFired << "," <<
-		   scaler0 << "," << scaler1 << "," << scaler2 << "," << scaler3 << "," << scaler4 << "," << scaler5 << "," <<
-		   finets0 << "," << finets1 << "," << finets2 << "," << finets3 << "," << finets4 << "," << finets5 <<
-		   std::endl;
-      // ev->Print(std::cout);
-    }
+    if (ev->GetDescription()=="TluRawDataEvent" && in_range_evn)
+      PrintTluEvent(*ev);
 
     auto subevents = ev->GetSubEvents();
       for (auto &subev: subevents) {
-        auto subeventDescription = subev->GetDescription();
-        // std::cout<< subeventDescription << std::endl;
-        if (subeventDescription=="TluRawDataEvent" && in_range_evn) {
-	  auto runNumber = subev->GetRunNumber();
-	  auto eventNumber = subev->GetEventNumber();
-	  auto triggerNumber = subev->GetTriggerN();
-	  auto timeStampBegin = subev->GetTimestampBegin();
-	  auto timeStampEnd = subev->GetTimestampEnd();
-          auto particles = subev->GetTag("PARTICLES", "NAN");
-	  auto triggersFired = subev->GetTag("TRIGGER" , "NAN");
-          auto scaler0 = subev->GetTag("SCALER0", "NAN"); 
-          auto scaler1 = subev->GetTag("SCALER1", "NAN"); 
-          auto scaler2 = subev->GetTag("SCALER2", "NAN");
-          auto scaler3 = subev->GetTag("SCALER3", "NAN");
-          auto scaler4 = subev->GetTag("SCALER4", "NAN");
-          auto scaler5 = subev->GetTag("SCALER5", "NAN");
-          auto finets0 = subev->GetTag("FINE_TS0", "NAN");
-          auto finets1 = subev->GetTag("FINE_TS1", "NAN");
-          auto finets2 = subev->GetTag("FINE_TS2", "NAN");
-          auto finets3 = subev->GetTag("FINE_TS3", "NAN");
-          auto finets4 = subev->GetTag("FINE_TS4", "NAN");
-          auto finets5 = subev->GetTag("FINE_TS5", "NAN");
-          std::cout << runNumber << "," <<
-      		   eventNumber << "," <<
-		   triggerNumber << "," <<
-		   timeStampBegin << "," <<
-		   timeStampEnd << "," <<
-		   particles << "," <<
-		   triggersFired << "," <<
-		   scaler0 << "," << scaler1 << "," << scaler2 << "," << scaler3 << "," << scaler4 << "," << scaler5 << "," <<
-		   finets0 << "," << finets1 << "," << finets2 << "," << finets3 << "," << finets4 << "," << finets5 <<
-		   std::endl;
-          //subev->Print(std::cout);
-          }
+        if (subev->GetDescription()=="TluRawDataEvent" && in_range_evn)
+          PrintTluEvent(*subev);
         }
       event_count++;
     }
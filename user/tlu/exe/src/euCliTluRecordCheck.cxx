@@ -0,0 +1,140 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/StdEventConverter.hh"
+
+#include "TluRawEventRecord.hh"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Checks the binary TLU record of block 1: it is decoded as it was encoded,
+// with and without scalers, short or unknown records are rejected, and the
+// converter makes the same StandardEvent from the record, from the compact
+// block 0 and from the tags of older data.
+
+bool Same(const TluRawEventRecord &a, const TluRawEventRecord &b){
+  bool same = a.version == b.version && a.type == b.type && a.inputs == b.inputs
+    && a.flags == b.flags;
+  for(int i = 0; i < 6; i++)
+    same = same && a.finets[i] == b.finets[i];
+  if(a.flags & TluRawEventRecord::FLAG_SCALER){
+    same = same && a.particles == b.particles;
+    for(int i = 0; i < 6; i++)
+      same = same && a.scaler[i] == b.scaler[i];
+  }
+  return same;
+}
+
+bool Fail(const std::string &what){
+  std::cout<<what<<std::endl;
+  return false;
+}
+
+bool CheckRecord(){
+  TluRawEventRecord rec;
+  rec.type = 3;
+  rec.inputs = 0x25;
+  for(int i = 0; i < 6; i++)
+    rec.finets[i] = uint8_t(40 * i + 7);
+  rec.particles = 0x89abcdef;
+  for(int i = 0; i < 6; i++)
+    rec.scaler[i] = 1000u * i + 0x01020304;
+  uint8_t buf[TluRawEventRecord::SIZE_SCALER];
+
+  // without FLAG_SCALER the scalers are neither written nor read
+  if(rec.Encode(buf) != TluRawEventRecord::SIZE)
+    return Fail("record without scalers: wrong size");
+  TluRawEventRecord dec;
+  if(!dec.Decode(buf, TluRawEventRecord::SIZE) || !Same(rec, dec) || dec.particles != 0)
+    return Fail("record without scalers: decoded differently");
+
+  rec.flags |= TluRawEventRecord::FLAG_SCALER;
+  if(rec.Encode(buf) != TluRawEventRecord::SIZE_SCALER)
+    return Fail("record with scalers: wrong size");
+  dec = TluRawEventRecord();
+  if(!dec.Decode(buf, TluRawEventRecord::SIZE_SCALER) || !Same(rec, dec))
+    return Fail("record with scalers: decoded differently");
+
+  if(dec.Decode(buf, TluRawEventRecord::SIZE - 1))
+    return Fail("short record accepted");
+  if(dec.Decode(buf, TluRawEventRecord::SIZE_SCALER - 1))
+    return Fail("record with truncated scalers accepted");
+  buf[0] = TluRawEventRecord::VERSION + 1;
+  if(dec.Decode(buf, TluRawEventRecord::SIZE_SCALER))
+    return Fail("record of unknown version accepted");
+  return true;
+}
+
+eudaq::EventSP MakeTluEvent(){
+  auto ev = eudaq::Event::MakeShared("TluRawDataEvent");
+  ev->SetRunN(5);
+  ev->SetEventN(17);
+  ev->SetTriggerN(17);
+  ev->SetTimestamp(1234567850, 1234567875);
+  return ev;
+}
+
+std::string Convert(eudaq::EventSPC ev){
+  auto stdev = eudaq::StandardEvent::MakeShared();
+  if(!eudaq::StdEventConverter::Convert(ev, stdev, nullptr))
+    return "";
+  return *stdev->GetSerialized();
+}
+
+bool CheckConverter(){
+  const uint8_t inputs = 0x0b;
+  const uint8_t finets[6] = {200, 210, 3, 190, 0, 77};
+
+  auto ev_record = MakeTluEvent();
+  TluRawEventRecord rec;
+  rec.inputs = inputs;
+  for(int i = 0; i < 6; i++)
+    rec.finets[i] = finets[i];
+  uint8_t buf[TluRawEventRecord::SIZE_SCALER];
+  ev_record->AddBlock(TluRawEventRecord::BLOCK_ID, buf, rec.Encode(buf));
+
+  auto ev_compact = MakeTluEvent();
+  std::vector<uint8_t> compact(finets, finets + 6);
+  compact.push_back(inputs);
+  ev_compact->AddBlock(0, compact);
+
+  auto ev_tags = MakeTluEvent();
+  std::string trigger;
+  for(int i = 5; i >= 0; i--)
+    trigger += (inputs >> i & 0x1) ? '1' : '0';
+  ev_tags->SetTag("TRIGGER", trigger);
+  for(int i = 0; i < 6; i++)
+    ev_tags->SetTag("FINE_TS" + std::to_string(i), std::to_string(finets[i]));
+
+  std::string std_record = Convert(ev_record);
+  if(std_record.empty())
+    return Fail("the record event is not converted");
+  if(Convert(ev_compact) != std_record)
+    return Fail("the compact block 0 event is converted differently");
+  if(Convert(ev_tags) != std_record)
+    return Fail("the tag event is converted differently");
+
+  auto ev_bad = MakeTluEvent();
+  buf[0] = TluRawEventRecord::VERSION + 1;
+  ev_bad->AddBlock(TluRawEventRecord::BLOCK_ID, buf, TluRawEventRecord::SIZE);
+  if(!Convert(ev_bad).empty())
+    return Fail("a record of unknown version is converted");
+  return true;
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line TLU Record Check", "2.0",
+			 "Checks the encoding of the binary TLU record and its conversion"
+			 " against the compact block and the tags of older data");
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    std::ostringstream err;
+    return op.HandleMainException(err);
+  }
+  bool ok = CheckRecord();
+  ok = CheckConverter() && ok;
+  std::cout<<(ok ? "TLU record checked" : "TLU record check FAILED")<<std::endl;
+  return ok ? 0 : -1;
+}
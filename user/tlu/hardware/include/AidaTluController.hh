@@ -143,7 +143,7 @@ namespace tlu {
       SetSerdesRst(0x0);
     };
 
-    fmctludata* PopFrontEvent();
+    fmctludata PopFrontEvent();
     bool IsBufferEmpty(){return m_data.empty();};
     void ReceiveEvents(uint8_t verbose);
     void ResetEventsBuffer();
@@ -227,7 +227,7 @@ namespace tlu {
     // Used for log purposes
     std::string m_myStates[2] = {"disabled", "enabled"};
 
-    std::deque<fmctludata*> m_data;
+    std::deque<fmctludata> m_data;
 
 
   };
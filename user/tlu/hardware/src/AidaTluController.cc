@@ -620,8 +620,8 @@ namespace tlu {
     EUDAQ_INFO("TLU SET TO " + runState);
   }
 
-  fmctludata* AidaTluController::PopFrontEvent(){
-    fmctludata *e = m_data.front();
+  fmctludata AidaTluController::PopFrontEvent(){
+    fmctludata e = m_data.front();
     m_data.pop_front();
     return e;
   }
@@ -661,9 +661,9 @@ namespace tlu {
           std::cout<<"receive error"<<std::endl;
         }
         for ( std::vector<uint32_t>::const_iterator i ( fifoContent.begin() ); i!=fifoContent.end(); i+=6 ) { //0123
-          m_data.push_back(new fmctludata(*i, *(i+1), *(i+2), *(i+3), *(i+4), *(i+5)));
+          m_data.emplace_back(*i, *(i+1), *(i+2), *(i+3), *(i+4), *(i+5));
           if (verbose > 1){
-            std::cout<< *(m_data.back());
+            std::cout<< m_data.back();
           }
         }
       }
@@ -671,9 +671,6 @@ namespace tlu {
   }
 
   void AidaTluController::ResetEventsBuffer(){
-    for(auto &&i: m_data){
-      delete i;
-    }
     m_data.clear();
   }
 
@@ -132,12 +132,12 @@ int main(int /*argc*/, char ** argv) {
       int nev = 0;
       while (!TLU.IsBufferEmpty()){
 	nev++;
-	fmctludata * data = TLU.PopFrontEvent();
-	uint32_t evn = data->eventnumber;
-	uint64_t t = data->timestamp;
+	fmctludata data = TLU.PopFrontEvent();
+	uint32_t evn = data.eventnumber;
+	uint64_t t = data.timestamp;
 
 	if (sfile.get()) {
-	  *sfile << *data;
+	  *sfile << data;
 	}
       }
       total += nev;
@@ -0,0 +1,80 @@
+#ifndef H_TLURAWEVENTRECORD_HH
+#define H_TLURAWEVENTRECORD_HH
+
+#include <cstdint>
+#include <cstddef>
+
+/** Fixed-layout binary record of one AIDA TLU trigger, stored in data block
+ * BLOCK_ID of a TluRawDataEvent. The trigger number and the coarse
+ * timestamp are in the event header. Little-endian layout:
+ *   0      format version
+ *   1      event type
+ *   2      fired inputs, bit i for input i
+ *   3      flags, FLAG_SCALER if the scalers follow
+ *   4..9   fine timestamps of inputs 0..5
+ *   10..11 reserved
+ *   12..39 particles and scalers 0..5 (uint32 each), with FLAG_SCALER only
+ */
+struct TluRawEventRecord {
+  static const uint32_t BLOCK_ID = 1;
+  static const uint8_t VERSION = 1;
+  static const uint8_t FLAG_SCALER = 0x1;
+  static const size_t SIZE = 12;
+  static const size_t SIZE_SCALER = SIZE + 28;
+
+  uint8_t version = VERSION;
+  uint8_t type = 0;
+  uint8_t inputs = 0;
+  uint8_t flags = 0;
+  uint8_t finets[6] = {0, 0, 0, 0, 0, 0};
+  uint32_t particles = 0;
+  uint32_t scaler[6] = {0, 0, 0, 0, 0, 0};
+
+  /// Writes the record to out, which holds SIZE_SCALER bytes. Returns the size.
+  size_t Encode(uint8_t *out) const {
+    out[0] = version;
+    out[1] = type;
+    out[2] = inputs;
+    out[3] = flags;
+    for(size_t i = 0; i < 6; i++)
+      out[4 + i] = finets[i];
+    out[10] = out[11] = 0;
+    if(!(flags & FLAG_SCALER))
+      return SIZE;
+    EncodeInt(out + 12, particles);
+    for(size_t i = 0; i < 6; i++)
+      EncodeInt(out + 16 + 4 * i, scaler[i]);
+    return SIZE_SCALER;
+  }
+
+  /// False if the data are too short or of an unknown version
+  bool Decode(const uint8_t *in, size_t size){
+    if(size < SIZE || in[0] != VERSION)
+      return false;
+    version = in[0];
+    type = in[1];
+    inputs = in[2];
+    flags = in[3];
+    for(size_t i = 0; i < 6; i++)
+      finets[i] = in[4 + i];
+    if(!(flags & FLAG_SCALER))
+      return true;
+    if(size < SIZE_SCALER)
+      return false;
+    particles = DecodeInt(in + 12);
+    for(size_t i = 0; i < 6; i++)
+      scaler[i] = DecodeInt(in + 16 + 4 * i);
+    return true;
+  }
+
+private:
+  static void EncodeInt(uint8_t *out, uint32_t v){
+    for(size_t i = 0; i < 4; i++, v >>= 8)
+      out[i] = uint8_t(v & 0xff);
+  }
+  static uint32_t DecodeInt(const uint8_t *in){
+    return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+  }
+};
+
+#endif // H_TLURAWEVENTRECORD_HH
@@ -3,11 +3,13 @@
 #include "AidaTluController.hh"
 #include "AidaTluHardware.hh"
 #include "AidaTluPowerModule.hh"
+#include "TluRawEventRecord.hh"
 
 #include <iostream>
 #include <ostream>
 #include <vector>
 #include <chrono>
+#include <algorithm>
 #include <thread>
 
 
@@ -26,7 +28,7 @@ class AidaTluProducer: public eudaq::Producer {
   static const uint32_t m_id_factory = eudaq::cstr2hash("AidaTluProducer");
 private:
   bool m_exit_of_run;
-  bool compact_data_ = false; // select if you will write the data in a more compact binary format
+  uint32_t m_batch_triggers; // triggers sent in one packet at most
   std::mutex m_mtx_tlu; //prevent to reset tlu during the RunLoop thread
 
   std::unique_ptr<tlu::AidaTluController> m_tlu;
@@ -49,6 +51,7 @@ AidaTluProducer::AidaTluProducer(const std::string name, const std::string &runc
   m_duration = 0;
   m_starttime = 0;
   m_lasttime = 0;
+  m_batch_triggers = 100;
 }
 
 void AidaTluProducer::RunLoop(){
@@ -68,71 +71,53 @@ void AidaTluProducer::RunLoop(){
   // Enable triggers
   m_tlu->SetTriggerVeto(0, m_verbose);
 
+  std::vector<eudaq::EventSP> batch;
+  batch.reserve(m_batch_triggers);
+  uint8_t record_buf[TluRawEventRecord::SIZE_SCALER];
   while(!m_exit_of_run) {
     m_lasttime=m_tlu->GetCurrentTimestamp()*25;
     if(isbegin) m_starttime = m_lasttime;
     m_tlu->ReceiveEvents(m_verbose);
     while (!m_tlu->IsBufferEmpty()){
-      tlu::fmctludata *data = m_tlu->PopFrontEvent();
-      uint32_t trigger_n = data->eventnumber;
-      uint64_t ts_raw = data->timestamp;
-      uint64_t ts_ns = ts_raw*25;
-      auto ev = eudaq::Event::MakeUnique("TluRawDataEvent");
-      std::vector<uint8_t> datablock(7);//6 (fineTS) + 1 (6x triggers, but that is only a single bit each,so one uint8 should be fine) + 4 (32bit eventtype) + 7*4 scalers (dropped for now ???)
+      tlu::fmctludata data = m_tlu->PopFrontEvent();
+      uint64_t ts_ns = data.timestamp*25;
+      auto ev = eudaq::Event::MakeShared("TluRawDataEvent");
       ev->SetTimestamp(ts_ns, ts_ns+25, false);
-      ev->SetTriggerN(trigger_n);
-
-      std::stringstream triggerss;
-      //triggerss<< data->input5 << data->input4 << data->input3 << data->input2 << data->input1 << data->input0;
-      triggerss<< std::to_string(data->input5) << std::to_string(data->input4) << std::to_string(data->input3) << std::to_string(data->input2) << std::to_string(data->input1) << std::to_string(data->input0);
-      ev->SetTag("TRIGGER", triggerss.str());
-      if(!compact_data_){
-      ev->SetTag("FINE_TS0", std::to_string(data->sc0));
-      ev->SetTag("FINE_TS1", std::to_string(data->sc1));
-      ev->SetTag("FINE_TS2", std::to_string(data->sc2));
-      ev->SetTag("FINE_TS3", std::to_string(data->sc3));
-      ev->SetTag("FINE_TS4", std::to_string(data->sc4));
-      ev->SetTag("FINE_TS5", std::to_string(data->sc5));
-      ev->SetTag("TYPE", std::to_string(data->eventtype));
-      } else {
-      // write compact event data
-      datablock[0] = uint8_t(data->sc0);
-      datablock[1] = uint8_t(data->sc1);
-      datablock[2] = uint8_t(data->sc2);
-      datablock[3] = uint8_t(data->sc3);
-      datablock[4] = uint8_t(data->sc4);
-      datablock[5] = uint8_t(data->sc5);
-      datablock[6] =( (data->input5 &0x1)<<5) +((data->input4 &0x1) <<4) + ((data->input3 &0x1) << 3) + ((data->input2 &0x1) << 2) + ((data->input1 &0x1) << 1) + (data->input0 &0x1);
-      ev->AddBlock(0,datablock);
-      }
+      ev->SetTriggerN(data.eventnumber);
+
+      TluRawEventRecord record;
+      record.type = data.eventtype;
+      record.inputs = (data.input5 &0x1)<<5 | (data.input4 &0x1)<<4 | (data.input3 &0x1)<<3
+	| (data.input2 &0x1)<<2 | (data.input1 &0x1)<<1 | (data.input0 &0x1);
+      record.finets[0] = data.sc0;
+      record.finets[1] = data.sc1;
+      record.finets[2] = data.sc2;
+      record.finets[3] = data.sc3;
+      record.finets[4] = data.sc4;
+      record.finets[5] = data.sc5;
       if(m_tlu->IsBufferEmpty()){
-      	uint32_t sl0,sl1,sl2,sl3, sl4, sl5, pt;
-      	m_tlu->GetScaler(sl0,sl1,sl2,sl3,sl4,sl5);
-      	pt=m_tlu->GetPreVetoTriggers();
-        if(!compact_data_){
-        ev->SetTag("PARTICLES", std::to_string(pt));
-      	ev->SetTag("SCALER0", std::to_string(sl0));
-      	ev->SetTag("SCALER1", std::to_string(sl1));
-      	ev->SetTag("SCALER2", std::to_string(sl2));
-      	ev->SetTag("SCALER3", std::to_string(sl3));
-        ev->SetTag("SCALER4", std::to_string(sl4));
-        ev->SetTag("SCALER5", std::to_string(sl5));
-        } else {
-          // does anyone need it? I do not think so, so we  simply drop it for now?
-        }
+	m_tlu->GetScaler(record.scaler[0], record.scaler[1], record.scaler[2],
+			 record.scaler[3], record.scaler[4], record.scaler[5]);
+	record.particles = m_tlu->GetPreVetoTriggers();
+	record.flags |= TluRawEventRecord::FLAG_SCALER;
         if(m_exit_of_run){
           ev->SetEORE();
         }
       }
+      ev->AddBlock(TluRawEventRecord::BLOCK_ID, record_buf, record.Encode(record_buf));
 
       if(isbegin){
         isbegin = false;
-	      ev->SetBORE();
+	ev->SetBORE();
         ev->SetTag("FirmwareID", std::to_string(m_tlu->GetFirmwareVersion()));
         ev->SetTag("BoardID", std::to_string(m_tlu->GetBoardID()));
       }
-      SendEvent(std::move(ev));
-      delete data;
+      batch.push_back(std::move(ev));
+      // a readout pass is sent at its end, split into batches of m_batch_triggers
+      if(batch.size() >= m_batch_triggers || m_tlu->IsBufferEmpty()){
+	SendEvents(batch);
+	batch.clear();
+      }
     }
   }
   m_tlu->SetTriggerVeto(1, m_verbose);
@@ -224,6 +209,7 @@ void AidaTluProducer::DoConfigure() {
   EUDAQ_INFO("TLU VERBOSITY SET TO: " + std::to_string(m_verbose));
   m_delayStart = conf->Get("delayStart", 0);
   EUDAQ_INFO("TLU DELAY START SET TO: " + std::to_string(m_delayStart) + " ms");
+  m_batch_triggers = std::max(conf->Get("batchTriggers", 100), 1);
 
   m_tlu->SetTriggerVeto(1, m_verbose);
   if( conf->Get("skipconf", false) ){
@@ -274,7 +260,6 @@ void AidaTluProducer::DoConfigure() {
     if(m_verbose > 0) EUDAQ_INFO(" -ADJUST STRETCH AND DELAY");
     m_tlu->SetPulseStretchPack(stretcVec, m_verbose);
     m_tlu->SetPulseDelayPack(delayVec, m_verbose);
-    compact_data_ = (bool)(conf->Get("compact_data",false));
     // Set triggerMask
     // The conf function does not seem happy with a 32-bit default. Need to check.
     if(m_verbose > 0) EUDAQ_INFO(" -DEFINE TRIGGER MASK");
@@ -1,5 +1,7 @@
 #include "eudaq/StdEventConverter.hh"
 #include "eudaq/RawEvent.hh"
+#include "TluRawEventRecord.hh"
+#include <algorithm>
 
 class TluRawEvent2StdEventConverter: public eudaq::StdEventConverter{
 public:
@@ -50,9 +52,24 @@ bool TluRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Standa
   }
 
   uint8_t fts_0, fts_1, fts_2, fts_3, fts_4, fts_5;
-  // Allowing compact data requires us to also take care of reading data
-  // Compact data contains a data block, whcih is used as check
-  if (d1->NumBlocks()==1){
+  // The binary record is decoded by its version. Older data have the
+  // compact 7 byte block 0 or the FINE_TS<0-5> and TRIGGER tags.
+  auto block_ids = d1->GetBlockNumList();
+  if(std::find(block_ids.begin(), block_ids.end(), TluRawEventRecord::BLOCK_ID) != block_ids.end()){
+      auto &block = d1->GetBlockView(TluRawEventRecord::BLOCK_ID);
+      TluRawEventRecord record;
+      if(!record.Decode(block.data(), block.size())){
+        EUDAQ_WARN("TLU record of unknown version " + std::to_string(block.empty() ? 0 : block[0]) + " or size " + std::to_string(block.size()) + ". Cannot calculate precise TLU TS. Return false.");
+        return false;
+      }
+      fts_0 = record.finets[0];
+      fts_1 = record.finets[1];
+      fts_2 = record.finets[2];
+      fts_3 = record.finets[3];
+      fts_4 = record.finets[4];
+      fts_5 = record.finets[5];
+      triggersFired = triggerMask & record.inputs;
+  }else if (d1->NumBlocks()==1){
       auto data = d1->GetBlock(0);
       fts_0 = data[0];
       fts_1 = data[1];